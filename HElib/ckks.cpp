@@ -0,0 +1,40 @@
+#include "../bench/ckks_sweep.h"
+#include "../bench/helib_backend.h"
+#include "../bench/options.h"
+#include "../bench/timer.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace bench;
+
+int main(int argc, char **argv) {
+    Options options(argc, argv);
+    if (options.has("ab-hexl")) return run_hexl_ab(argc, argv, options, helib_build_info());
+    tag_results(helib_build_info());
+
+    cout << "=== CKKS OPERATIONS AND DEPTH ===" << endl;
+
+    CkksSweepConfig config;
+    // m = 2N, so m / 4 slots
+    config.poly_modulus_degrees = {4096, 8192, 16384, 32768};
+    config.vector_sizes = {1024, 2048, 4096, 8192};
+    config.candidates = [](size_t m) { return helib_ckks_params(m); };
+    apply_options(config, options);
+
+    HelibCkksBackend backend;
+
+    Timer total_timer;
+    total_timer.tic();
+    {
+        CsvLog log("ckks_results.csv", ckks_sweep_columns());
+        run_ckks_sweep(backend, config, log);
+    }
+    {
+        CsvLog log("ckks_depth_results.csv", ckks_depth_columns());
+        run_ckks_depth_sweep(backend, config, log);
+    }
+
+    cout << "\nCKKS experiment completed in " << total_timer.toc() / 1000.0 << " seconds!" << endl;
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include "../bench/helib_backend.h"
+#include "../bench/param_search.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace bench;
+
+// Finds the fastest BGV parameters for a required depth, plaintext size and
+// security level, e.g. --depth=3 --plain-bits=17 --security=128. Extra
+// options: --bits=150,200,... (modulus sizes tried).
+int main(int argc, char **argv) {
+    Options options(argc, argv);
+    if (options.has("ab-hexl")) return run_hexl_ab(argc, argv, options, helib_build_info());
+    tag_results(helib_build_info());
+
+    cout << "=== PARAMETER SEARCH ===" << endl;
+
+    SearchConfig config;
+    config.poly_modulus_degrees = {4096, 8192, 16384, 32768};
+    config.target.plain_bits = 17;
+    apply_options(config, options);
+
+    vector<long> bits = {150, 200, 300, 400, 500, 600, 800};
+    auto bits_option = options.get_list("bits");
+    if (!bits_option.empty()) {
+        bits = bits_option;
+    }
+    config.candidates = [&](size_t m, const SearchTarget &target) {
+        return helib_search_params(m, target.plain_bits, target.security_bits, bits);
+    };
+
+    HelibBgvBackend backend;
+    backend.set_key_cache_dir(options.get("key-cache"));
+
+    CsvLog log("param_search_results.csv", param_search_columns());
+    run_param_search(backend, config, log);
+    cout << "\nResults saved to: param_search_results.csv" << endl;
+    return 0;
+}
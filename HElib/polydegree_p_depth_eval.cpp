@@ -0,0 +1,45 @@
+#include "../bench/depth_sweep.h"
+#include "../bench/helib_backend.h"
+#include "../bench/options.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace bench;
+
+int main(int argc, char **argv) {
+    Options options(argc, argv);
+    if (options.has("ab-hexl")) return run_hexl_ab(argc, argv, options, helib_build_info());
+    tag_results(helib_build_info());
+
+    cout << "=== FOCUSED PARAMETER SPACE EXPLORATION ===" << endl;
+
+    DepthSweepConfig config;
+    config.poly_modulus_degrees = {1024, 2048, 4096, 8192, 16384, 32768};
+
+    // Representative primes, smallest to the common 65537
+    config.candidates = [](size_t m) {
+        vector<ParamSet> candidates;
+        for (long p : {2L, 17L, 257L, 8191L, 65537L}) {
+            ParamSet params;
+            params.poly_modulus_degree = m;
+            params.plain_modulus = static_cast<uint64_t>(p);
+            params.helib_bits = 500;
+            params.helib_c = 2;
+            params.helib_r = 1;
+            candidates.push_back(params);
+        }
+        return candidates;
+    };
+    config.op = OpType::CipherMulCipher;
+    config.value = 1;
+    config.max_ops = static_cast<int>(options.get_long("max-ops", 30));
+
+    HelibBgvBackend backend;
+    backend.set_key_cache_dir(options.get("key-cache"));
+    CsvLog log("focused_parameter_analysis.csv", depth_sweep_columns());
+    run_depth_sweep(backend, config, log);
+
+    cout << "\nFocused analysis completed!" << endl;
+    return 0;
+}
@@ -0,0 +1,34 @@
+#include "../bench/helib_backend.h"
+#include "../bench/modes.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace bench;
+
+int main(int argc, char **argv) {
+    Options options(argc, argv);
+    if (options.has("ab-hexl")) return run_hexl_ab(argc, argv, options, helib_build_info());
+    tag_results(helib_build_info());
+
+    cout << "=== ROTATION OPERATION EXPERIMENT ===" << endl;
+
+    SweepConfig config;
+    config.poly_modulus_degrees = {4096, 8192, 16384, 32768};
+
+    // Vector sizes from 2^4 to 2^10
+    for (int i = 4; i <= 10; i++) {
+        config.vector_sizes.push_back(1 << i);
+    }
+    config.candidates = [](size_t m) { return helib_default_params(m, true); };
+    apply_options(config, options);
+
+    HelibBgvBackend backend;
+    backend.set_key_cache_dir(options.get("key-cache"));
+
+    run_rotation_modes(backend, config, options, "rotation_results");
+
+    cout << "\nRotation experiment completed!" << endl;
+    cout << "Results saved to rotation_results.csv" << endl;
+    return 0;
+}
@@ -0,0 +1,38 @@
+#include "../bench/helib_backend.h"
+#include "../bench/modes.h"
+#include "../bench/timer.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace bench;
+
+int main(int argc, char **argv) {
+    Options options(argc, argv);
+    if (options.has("ab-hexl")) return run_hexl_ab(argc, argv, options, helib_build_info());
+    tag_results(helib_build_info());
+
+    cout << "=== SAME NUMBER EXPERIMENT ===" << endl;
+
+    SweepConfig config;
+    config.poly_modulus_degrees = {4096, 8192, 16384, 32768};
+    config.vector_sizes = {1024, 2048, 4096, 8192, 16384, 32768, 65536};
+
+    // Same number in all slots: 123 op 456
+    config.pattern = DataPattern::Same;
+    config.same_a = 123;
+    config.same_b = 456;
+    config.candidates = [](size_t m) { return helib_default_params(m); };
+    config.min_slots = 100;
+    apply_options(config, options);
+
+    HelibBgvBackend backend;
+    backend.set_key_cache_dir(options.get("key-cache"));
+
+    Timer total_timer;
+    total_timer.tic();
+    run_op_modes(backend, config, options, "same_number_results");
+
+    cout << "\nSame number experiment completed in " << total_timer.toc() / 1000.0 << " seconds!" << endl;
+    return 0;
+}
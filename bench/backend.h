@@ -0,0 +1,545 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace bench {
+
+// Element-wise operations every backend has to provide. The names are the
+// ones already used in the SEAL CSVs, so old and new results line up.
+enum class OpType {
+    CipherAddCipher,
+    CipherAddPlain,
+    CipherMulPlain,
+    CipherMulCipher
+};
+
+class Plain;
+class Cipher;
+
+// Compile-time description of each op: its CSV name, its operand kinds and
+// how it calls a backend, out of place and in place. B is Backend or one of
+// the final backend classes, for which the calls compile to direct calls.
+// Timed loops instantiated per op (see for_each_op) therefore contain
+// neither a dispatch on the op nor, for a final backend, a virtual call.
+template <OpType Op>
+struct OpTraits;
+
+template <>
+struct OpTraits<OpType::CipherAddCipher> {
+    static constexpr const char *name = "CIPHER_ADD_CIPHER";
+    static constexpr bool plain = false;
+    static constexpr bool add = true;
+    template <typename B>
+    static void apply(B &b, const Cipher &x, const Cipher &y, const Plain &, Cipher &out) { b.add(x, y, out); }
+    template <typename B>
+    static void apply_inplace(B &b, Cipher &x, const Cipher &y, const Plain &) { b.add_inplace(x, y); }
+};
+
+template <>
+struct OpTraits<OpType::CipherAddPlain> {
+    static constexpr const char *name = "CIPHER_ADD_PLAIN";
+    static constexpr bool plain = true;
+    static constexpr bool add = true;
+    template <typename B>
+    static void apply(B &b, const Cipher &x, const Cipher &, const Plain &p, Cipher &out) { b.add_plain(x, p, out); }
+    template <typename B>
+    static void apply_inplace(B &b, Cipher &x, const Cipher &, const Plain &p) { b.add_plain_inplace(x, p); }
+};
+
+template <>
+struct OpTraits<OpType::CipherMulPlain> {
+    static constexpr const char *name = "CIPHER_MUL_PLAIN";
+    static constexpr bool plain = true;
+    static constexpr bool add = false;
+    template <typename B>
+    static void apply(B &b, const Cipher &x, const Cipher &, const Plain &p, Cipher &out) {
+        b.multiply_plain(x, p, out);
+    }
+    template <typename B>
+    static void apply_inplace(B &b, Cipher &x, const Cipher &, const Plain &p) { b.multiply_plain_inplace(x, p); }
+};
+
+template <>
+struct OpTraits<OpType::CipherMulCipher> {
+    static constexpr const char *name = "CIPHER_MUL_CIPHER";
+    static constexpr bool plain = false;
+    static constexpr bool add = false;
+    template <typename B>
+    static void apply(B &b, const Cipher &x, const Cipher &y, const Plain &, Cipher &out) { b.multiply(x, y, out); }
+    template <typename B>
+    static void apply_inplace(B &b, Cipher &x, const Cipher &y, const Plain &) { b.multiply_inplace(x, y); }
+};
+
+template <OpType... Ops>
+struct OpList {};
+
+// The registered ops, in sweep order. Every sweep, runtime or
+// compile-time, iterates this list: registering an op is its OpTraits
+// plus one entry here.
+using AllOps = OpList<OpType::CipherAddCipher, OpType::CipherAddPlain, OpType::CipherMulPlain,
+                      OpType::CipherMulCipher>;
+
+// Calls fn(std::integral_constant<OpType, Op>{}) for every registered op.
+template <typename Fn, OpType... Ops>
+void for_each_op(OpList<Ops...>, Fn &&fn) {
+    (fn(std::integral_constant<OpType, Ops>{}), ...);
+}
+
+template <typename Fn>
+void for_each_op(Fn &&fn) {
+    for_each_op(AllOps{}, fn);
+}
+
+inline const char *op_name(OpType op) {
+    const char *name = "UNKNOWN";
+    for_each_op([&](auto tag) {
+        if (tag.value == op) name = OpTraits<decltype(tag)::value>::name;
+    });
+    return name;
+}
+
+inline const std::vector<OpType> &all_ops() {
+    static const std::vector<OpType> ops = [] {
+        std::vector<OpType> list;
+        for_each_op([&](auto tag) { list.push_back(tag.value); });
+        return list;
+    }();
+    return ops;
+}
+
+inline bool is_plain_op(OpType op) {
+    bool plain = false;
+    for_each_op([&](auto tag) {
+        if (tag.value == op) plain = OpTraits<decltype(tag)::value>::plain;
+    });
+    return plain;
+}
+
+inline bool is_add_op(OpType op) {
+    bool add = false;
+    for_each_op([&](auto tag) {
+        if (tag.value == op) add = OpTraits<decltype(tag)::value>::add;
+    });
+    return add;
+}
+
+// One point in parameter space. Each backend reads the fields it understands
+// and ignores the rest.
+struct ParamSet {
+    // SEAL: poly_modulus_degree N. HElib: cyclotomic index m.
+    size_t poly_modulus_degree = 8192;
+
+    // SEAL coefficient modulus bit sizes; empty selects CoeffModulus::BFVDefault.
+    std::vector<int> coeff_modulus_bits;
+
+    // Plaintext modulus; 0 lets the backend pick a batching prime of
+    // plain_modulus_bits bits (SEAL) or 65537 (HElib).
+    uint64_t plain_modulus = 0;
+    int plain_modulus_bits = 20;
+
+    // HElib ContextBuilder knobs.
+    long helib_bits = 300;
+    long helib_c = 2;
+    long helib_r = 1;
+
+    // CKKS encoding scale 2^ckks_scale_bits (SEAL) or precision in bits
+    // (HElib ContextBuilder<CKKS>::precision). BFV and BGV ignore it.
+    int ckks_scale_bits = 40;
+
+    // Minimum security in bits. 0 keeps the library default: SEAL enforces
+    // 128-bit HE-standard bounds, HElib does not check.
+    int security_bits = 0;
+
+    // Key material beyond the public key.
+    bool relin_keys = true;
+    bool galois_keys = false;
+
+    // Rotation steps to generate dedicated Galois keys for (0 stands for
+    // SEAL's column rotation). Empty keeps the library's default key set.
+    std::vector<int> galois_steps;
+
+    std::string describe() const {
+        std::ostringstream ss;
+        ss << "degree=" << poly_modulus_degree << " coeff=[";
+        for (size_t i = 0; i < coeff_modulus_bits.size(); i++) {
+            ss << coeff_modulus_bits[i];
+            if (i < coeff_modulus_bits.size() - 1) ss << ",";
+        }
+        ss << "] plain=";
+        if (plain_modulus) ss << plain_modulus;
+        else ss << "batching" << plain_modulus_bits;
+        return ss.str();
+    }
+
+    // Identifies everything a backend derives from these parameters (context
+    // and key material). Safe to use as a file name.
+    std::string cache_key() const {
+        std::ostringstream ss;
+        ss << "n" << poly_modulus_degree << "_q";
+        for (size_t i = 0; i < coeff_modulus_bits.size(); i++) {
+            ss << coeff_modulus_bits[i];
+            if (i < coeff_modulus_bits.size() - 1) ss << "-";
+        }
+        if (coeff_modulus_bits.empty()) ss << "default";
+        ss << "_t" << plain_modulus << "-" << plain_modulus_bits
+           << "_h" << helib_bits << "-" << helib_c << "-" << helib_r
+           << "_s" << security_bits
+           << "_rk" << relin_keys << "_gk" << galois_keys;
+        if (!galois_steps.empty()) {
+            // FNV-1a keeps long step lists out of the file name.
+            uint64_t hash = 14695981039346656037ull;
+            for (int step : galois_steps) {
+                hash = (hash ^ static_cast<uint32_t>(step)) * 1099511628211ull;
+            }
+            ss << "-" << std::hex << hash << std::dec;
+        }
+        return ss.str();
+    }
+};
+
+// Coefficient modulus bit sizes as a CSV-safe field, e.g. "40-40-40".
+inline std::string coeff_modulus_string(const ParamSet &params) {
+    if (params.coeff_modulus_bits.empty()) return "default";
+    std::ostringstream ss;
+    for (size_t i = 0; i < params.coeff_modulus_bits.size(); i++) {
+        ss << params.coeff_modulus_bits[i];
+        if (i < params.coeff_modulus_bits.size() - 1) ss << "-";
+    }
+    return ss.str();
+}
+
+// Serialized (uncompressed) size of the key material of the current setup.
+struct KeySizes {
+    size_t public_key = 0;
+    size_t relin_keys = 0;
+    size_t galois_keys = 0;
+    size_t galois_key_count = 0;  // SEAL: Galois elements, HElib: automorphism matrices
+};
+
+// Wall-clock time spent generating each kind of key material.
+struct KeyGenTimes {
+    double public_key_ms = 0;  // includes the secret key
+    double relin_keys_ms = 0;
+    double galois_keys_ms = 0;
+};
+
+// Backend-owned plaintext and ciphertext. Workloads only move them between
+// calls on the backend that created them; the backend downcasts internally.
+class Plain {
+public:
+    virtual ~Plain() = default;
+};
+
+class Cipher {
+public:
+    virtual ~Cipher() = default;
+};
+
+// Common surface of a homomorphic library as seen by the benchmark workloads.
+// Implementations live in seal_backend.h and helib_backend.h; workloads in
+// workloads.h are written once against this interface.
+class Backend {
+public:
+    virtual ~Backend() = default;
+
+    // "SEAL" / "HElib" and "BFV" / "BGV", used to tag result rows.
+    virtual std::string library() const = 0;
+    virtual std::string scheme() const = 0;
+
+    // Builds the context and generates keys. Returns false if the library
+    // rejects the parameters; the backend is then left without a context.
+    // Setting up the same ParamSet again reuses the cached context and keys.
+    virtual bool setup(const ParamSet &params) = 0;
+
+    // Directory where generated contexts and keys are persisted and looked up
+    // before generating; empty (the default) keeps the cache in memory only.
+    void set_key_cache_dir(const std::string &dir) { key_cache_dir = dir; }
+    const std::string &get_key_cache_dir() const { return key_cache_dir; }
+
+    // Drops every cached parameter set, e.g. between sweeps that should not
+    // share keys. The backend is left without a setup.
+    virtual void clear_cache() = 0;
+
+    // A backend bound to the same context and keys, with its own per-thread
+    // evaluation objects and memory. Call it from the thread that will use
+    // the result; the worker must not outlive this backend's current setup.
+    virtual std::unique_ptr<Backend> make_worker() const = 0;
+
+    // A backend with its own copy of the context and key material, built on
+    // the calling thread so that under first-touch placement its pages land
+    // on that thread's NUMA node (see numa.h). Its workers share that copy.
+    // Make replicas one at a time, while no worker runs. Backends that
+    // cannot copy their keys return nullptr.
+    virtual std::unique_ptr<Backend> make_replica() const { return nullptr; }
+
+    // Evaluation key bundle: the current parameters with the public,
+    // relinearization and Galois keys but not the secret key, for handing
+    // evaluation to another process (see distributed.h). A backend set up
+    // from one by setup_eval_keys() encrypts and evaluates, but decrypt()
+    // throws. setup_eval_keys() returns false if the bundle is unreadable;
+    // the result is not cached.
+    virtual void save_eval_keys(std::ostream &out) const = 0;
+    virtual bool setup_eval_keys(std::istream &in) = 0;
+
+    virtual size_t slot_count() const = 0;
+
+    // Length of the cycle rotate() shifts within: a batch row (half the
+    // slots) in SEAL, all slots in HElib.
+    virtual size_t row_size() const { return slot_count(); }
+    virtual uint64_t plain_modulus() const = 0;
+
+    // Bit size of the ciphertext modulus a fresh encryption starts at.
+    virtual int modulus_bits() const = 0;
+
+    // Estimated security of the current setup in bits.
+    virtual double security_level() const = 0;
+
+    virtual std::unique_ptr<Plain> make_plain() const = 0;
+    virtual std::unique_ptr<Cipher> make_cipher() const = 0;
+
+    // Forms a plaintext operand can be prepared in by encode() ahead of plain
+    // ops, cheapest-to-prepare first; plain ops use whichever form their
+    // operand holds. The first is selected initially.
+    virtual std::vector<std::string> plain_encodings() const { return {"default"}; }
+    const std::string &plain_encoding() const { return plain_encoding_name; }
+
+    void set_plain_encoding(const std::string &name) {
+        auto names = plain_encodings();
+        if (std::find(names.begin(), names.end(), name) == names.end()) {
+            throw std::invalid_argument(library() + " has no plaintext encoding " + name);
+        }
+        plain_encoding_name = name;
+    }
+
+    // values.size() must equal slot_count().
+    virtual void encode(const std::vector<uint64_t> &values, Plain &out) = 0;
+    virtual void decode(const Plain &plain, std::vector<uint64_t> &out) = 0;
+
+    virtual void encrypt(const Plain &plain, Cipher &out) = 0;
+    virtual void decrypt(const Cipher &cipher, Plain &out) = 0;
+
+    // Bits of noise budget left (SEAL: invariant noise budget, HElib:
+    // capacity). At or below 0 decryption is no longer guaranteed.
+    virtual double noise_budget(const Cipher &cipher) = 0;
+
+    // The same budget estimated from the ciphertext alone, with no secret
+    // key and no decryption (see the backends for the model behind it).
+    // NaN where the backend knows nothing about the ciphertext.
+    virtual double estimated_noise_budget(const Cipher &cipher) const = 0;
+
+    // Bit size of the modulus the ciphertext is currently at.
+    virtual double cipher_modulus_bits(const Cipher &cipher) const = 0;
+
+    virtual void add(const Cipher &a, const Cipher &b, Cipher &out) = 0;
+    virtual void add_plain(const Cipher &a, const Plain &b, Cipher &out) = 0;
+    virtual void multiply_plain(const Cipher &a, const Plain &b, Cipher &out) = 0;
+
+    // Ciphertext product followed by relinearization, which is what HElib's
+    // multiplyBy does implicitly.
+    virtual void multiply(const Cipher &a, const Cipher &b, Cipher &out) = 0;
+
+    // In-place forms of the ops above: a = a op b. Same results, but no
+    // separate output and no copy of a.
+    virtual void add_inplace(Cipher &a, const Cipher &b) = 0;
+    virtual void add_plain_inplace(Cipher &a, const Plain &b) = 0;
+    virtual void multiply_plain_inplace(Cipher &a, const Plain &b) = 0;
+    virtual void multiply_inplace(Cipher &a, const Cipher &b) = 0;
+
+    // Evaluation (NTT) representation of a ciphertext, for keeping it there
+    // across cipher x plain ops and additions; decryption and the other ops
+    // need it back in coefficient form. Backends whose ciphertexts always
+    // are in evaluation form (HElib's DoubleCRT) return false and leave c
+    // alone.
+    virtual bool to_ntt(Cipher &c) {
+        (void)c;
+        return false;
+    }
+    virtual bool from_ntt(Cipher &c) {
+        (void)c;
+        return false;
+    }
+
+    // Deep copy, and transfer of from's buffers into `to` (from is left
+    // unspecified). Backends whose ciphertexts cannot be moved copy.
+    virtual void copy_cipher(const Cipher &from, Cipher &to) = 0;
+    virtual void move_cipher(Cipher &from, Cipher &to) = 0;
+
+    // The phases of multiply(), timed apart by the mul-phases workload:
+    // the tensor product alone (a three-component result), relinearization
+    // of such a result back to two components, and switching a ciphertext
+    // to the next, smaller modulus of the chain. mod_switch() returns false
+    // when there is none.
+    virtual void multiply_no_relin(const Cipher &a, const Cipher &b, Cipher &out) = 0;
+    virtual void relinearize(Cipher &c) = 0;
+    virtual bool mod_switch(Cipher &c) = 0;
+
+    // Cyclic slot rotation; positive steps rotate left. Requires galois_keys.
+    virtual void rotate(const Cipher &a, int steps, Cipher &out) = 0;
+
+    // Rotations of one ciphertext by each of `steps`, each as rotate() by
+    // that step. out holds one cipher per step. With `hoist`, backends that
+    // can share the key-switching decomposition between rotations do so;
+    // returns whether that happened.
+    virtual bool rotate_many(const Cipher &a, const std::vector<int> &steps,
+                             std::vector<std::unique_ptr<Cipher>> &out, bool hoist) {
+        (void)hoist;
+        for (size_t i = 0; i < steps.size(); i++) {
+            rotate(a, steps[i], *out[i]);
+        }
+        return false;
+    }
+
+    // Rotation along the backend's second slot axis (SEAL: swap the two batch
+    // rows; HElib: one step along hypercube dimension 0).
+    virtual void rotate_columns(const Cipher &a, Cipher &out) = 0;
+
+    // Where rotate_columns() moves each slot: the decoded slots of its result
+    // for a ciphertext holding `slots`. By default the two batch rows swap.
+    virtual std::vector<uint64_t> rotate_columns_slots(const std::vector<uint64_t> &slots) const {
+        size_t half = slots.size() / 2;
+        std::vector<uint64_t> out(slots.size());
+        for (size_t i = 0; i < half; i++) {
+            out[i] = slots[half + i];
+            out[half + i] = slots[i];
+        }
+        return out;
+    }
+
+    // In-memory payload of a ciphertext (all polynomials, all RNS limbs).
+    virtual size_t cipher_bytes(const Cipher &cipher) const = 0;
+
+    // Ciphertext wire formats, uncompressed first. save_cipher() writes a
+    // ciphertext in one of them and returns the bytes written; load_cipher()
+    // reads any of them back.
+    virtual std::vector<std::string> wire_formats() const = 0;
+    virtual size_t save_cipher(const Cipher &cipher, const std::string &format, std::ostream &out) const = 0;
+    virtual void load_cipher(std::istream &in, Cipher &out) = 0;
+
+    // Encrypts with the secret key straight to the wire in seeded form, where
+    // one polynomial is replaced by the seed that generates it. Returns the
+    // bytes written, or 0 for backends without a seeded form.
+    virtual size_t save_seeded(const Plain &plain, const std::string &format, std::ostream &out) {
+        (void)plain;
+        (void)format;
+        (void)out;
+        return 0;
+    }
+    virtual KeySizes key_sizes() const = 0;
+
+    // Generation cost of the current key material; all zero if it was
+    // loaded from disk.
+    virtual KeyGenTimes keygen_times() const = 0;
+
+    // Memory probes (see memory.h): between begin and end the backend
+    // allocates from a fresh pool, and end returns its allocated bytes.
+    // Backends without a pool of their own return 0.
+    virtual void begin_memory_probe() {}
+    virtual size_t end_memory_probe() { return 0; }
+
+    // Arena allocation (see ArenaScope in memory.h): until end_arena() the
+    // backend draws ciphertexts and evaluation scratch from a dedicated
+    // pool, and make_cipher() reserves room for `polys` polynomials at the
+    // top modulus so outputs written into it never reallocate. Backends
+    // without a pool of their own ignore it.
+    virtual void begin_arena(size_t polys) { (void)polys; }
+    virtual void end_arena() {}
+
+    // Wall-clock time of the last setup() and where its keys came from:
+    // "generated", "disk" or "memory".
+    double last_setup_ms() const { return setup_ms; }
+    const std::string &last_setup_source() const { return setup_source; }
+
+    // Runtime dispatch for workloads that pick the op per call; the op
+    // sweep instantiates OpTraits<Op>::apply instead.
+    void apply(OpType op, const Cipher &a, const Cipher &b, const Plain &p, Cipher &out) {
+        for_each_op([&](auto tag) {
+            if (tag.value == op) OpTraits<decltype(tag)::value>::apply(*this, a, b, p, out);
+        });
+    }
+
+    void apply_inplace(OpType op, Cipher &a, const Cipher &b, const Plain &p) {
+        for_each_op([&](auto tag) {
+            if (tag.value == op) OpTraits<decltype(tag)::value>::apply_inplace(*this, a, b, p);
+        });
+    }
+
+protected:
+    std::string key_cache_dir;
+    std::string plain_encoding_name = "default";
+    double setup_ms = 0;
+    std::string setup_source;
+};
+
+// Approximate-arithmetic (CKKS) surface: real-valued slots and a chain of
+// levels that rescale() consumes after each product. Kept apart from
+// Backend, whose workloads are written around exact slots mod t; results
+// are checked against a tolerance instead (see ckks_sweep.h). Key material
+// is cached in memory only.
+class CkksBackend {
+public:
+    virtual ~CkksBackend() = default;
+
+    virtual std::string library() const = 0;
+    std::string scheme() const { return "CKKS"; }
+
+    // As Backend::setup().
+    virtual bool setup(const ParamSet &params) = 0;
+    virtual void clear_cache() = 0;
+
+    virtual size_t slot_count() const = 0;
+    virtual int modulus_bits() const = 0;
+    virtual double security_level() const = 0;
+    virtual int scale_bits() const = 0;
+
+    virtual std::unique_ptr<Plain> make_plain() const = 0;
+    virtual std::unique_ptr<Cipher> make_cipher() const = 0;
+
+    // values.size() must equal slot_count(). Plaintexts are encoded at the
+    // top level and the backend's scale.
+    virtual void encode(const std::vector<double> &values, Plain &out) = 0;
+    virtual void decode(const Plain &plain, std::vector<double> &out) = 0;
+
+    virtual void encrypt(const Plain &plain, Cipher &out) = 0;
+    virtual void decrypt(const Cipher &cipher, Plain &out) = 0;
+
+    // Bits of modulus left above the ciphertext's scale (SEAL) or HElib's
+    // capacity; products and rescales use it up.
+    virtual double capacity_bits(const Cipher &cipher) const = 0;
+
+    // Operands may sit at different levels; backends bring them to a common
+    // level (and, for additions, scale) first. multiply() relinearizes but
+    // does not rescale.
+    virtual void add(const Cipher &a, const Cipher &b, Cipher &out) = 0;
+    virtual void add_plain(const Cipher &a, const Plain &b, Cipher &out) = 0;
+    virtual void multiply_plain(const Cipher &a, const Plain &b, Cipher &out) = 0;
+    virtual void multiply(const Cipher &a, const Cipher &b, Cipher &out) = 0;
+
+    // Divides the scale of a product back down, dropping one level. Returns
+    // false for backends that rescale implicitly inside multiply() (HElib)
+    // and leave c alone.
+    virtual bool rescale(Cipher &c) = 0;
+
+    virtual void copy_cipher(const Cipher &from, Cipher &to) = 0;
+    virtual size_t cipher_bytes(const Cipher &cipher) const = 0;
+
+    double last_setup_ms() const { return setup_ms; }
+
+    void apply(OpType op, const Cipher &a, const Cipher &b, const Plain &p, Cipher &out) {
+        for_each_op([&](auto tag) {
+            if (tag.value == op) OpTraits<decltype(tag)::value>::apply(*this, a, b, p, out);
+        });
+    }
+
+protected:
+    double setup_ms = 0;
+};
+
+} // namespace bench
@@ -0,0 +1,322 @@
+#pragma once
+
+#include "backend.h"
+#include "options.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+struct CkksSweepConfig {
+    std::vector<size_t> poly_modulus_degrees;
+    std::vector<size_t> vector_sizes;
+
+    // As SweepConfig::candidates: the first accepted set is used.
+    std::function<std::vector<ParamSet>(size_t)> candidates;
+
+    // Slot values are uniform in [-1, 1]; the operand of a depth chain is
+    // uniform in [0.5, 1.5] so products neither vanish nor explode.
+    uint32_t seed = 42;
+
+    // A depth chain ends at the first result with less precision than this,
+    // at the first step the library refuses (no level left) or at max_ops.
+    double min_precision_bits = 10;
+    int max_ops = 16384;
+
+    TimingConfig timing;
+};
+
+// CKKS options on top of the timing ones:
+//   --min-precision=B  precision a depth chain must keep (default 10 bits)
+//   --max-ops=N        depth chain cap (default 16384)
+inline void apply_options(CkksSweepConfig &config, const Options &options) {
+    apply_timing_options(config.timing, options);
+    config.min_precision_bits = options.get_double("min-precision", config.min_precision_bits);
+    config.max_ops = std::max(1, static_cast<int>(options.get_long("max-ops", config.max_ops)));
+}
+
+// Worst-slot error of a decrypted result, relative where the expected value
+// exceeds 1 in magnitude, and the bits of precision that leaves.
+struct Precision {
+    double max_error = 0;
+    double bits = 0;
+};
+
+inline Precision measure_precision(const std::vector<double> &decoded, const std::vector<double> &expected,
+                                   size_t count) {
+    Precision p;
+    for (size_t i = 0; i < count; i++) {
+        double error = std::abs(decoded[i] - expected[i]) / std::max(1.0, std::abs(expected[i]));
+        p.max_error = std::max(p.max_error, error);
+    }
+    p.bits = p.max_error > 0 ? std::min(64.0, -std::log2(p.max_error)) : 64.0;
+    return p;
+}
+
+inline double expected_real(OpType op, double a, double b) { return is_add_op(op) ? a + b : a * b; }
+
+// Slots [0, count) uniform in [lo, hi], the rest zero.
+inline std::vector<double> random_reals(std::mt19937 &rng, size_t count, size_t slot_count, double lo, double hi) {
+    std::uniform_real_distribution<double> dist(lo, hi);
+    std::vector<double> values(slot_count, 0.0);
+    for (size_t i = 0; i < count; i++) values[i] = dist(rng);
+    return values;
+}
+
+inline ColumnSet ckks_sweep_columns() {
+    return keyed_columns(
+        result_columns(concat_columns({
+            {"scale_bits", "modulus_bits", "vector_size", "operation_type", "capacity_in_bits", "capacity_out_bits",
+             "ciphertext_bytes"},
+            stats_columns("encoding"),
+            stats_columns("encryption"),
+            stats_columns("operation"),
+            stats_columns("rescale"),
+            stats_columns("decryption"),
+            {"rescaled", "max_error", "precision_bits"}})),
+        {"scale_bits", "modulus_bits", "vector_size", "operation_type"});
+}
+
+// The BFV/BGV op matrix on real-valued data: every op at every degree and
+// vector size, with the cost of the rescale that follows a product timed on
+// its own (backends that rescale implicitly log it as 0 with rescaled = 0),
+// and the precision of the decrypted result after it.
+inline void run_ckks_sweep(CkksBackend &backend, const CkksSweepConfig &config, CsvLog &log) {
+    std::mt19937 rng(config.seed);
+    const TimingConfig &timing = config.timing;
+
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " CKKS PolyModulus=" << degree << " ===" << std::endl;
+        bool ready = false;
+        for (const auto &params : config.candidates(degree)) {
+            if ((ready = backend.setup(params))) break;
+        }
+        if (!ready) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        size_t slot_count = backend.slot_count();
+        std::cout << "  scale 2^" << backend.scale_bits() << ", q=" << backend.modulus_bits() << " bits, "
+                  << slot_count << " slots" << std::endl;
+
+        for (auto vector_size : config.vector_sizes) {
+            if (vector_size > slot_count) {
+                std::cout << "  VectorSize " << vector_size << " - SKIPPING (exceeds " << slot_count << " slots)"
+                          << std::endl;
+                continue;
+            }
+            for (auto op : all_ops()) {
+                try {
+                    std::vector<double> a = random_reals(rng, vector_size, slot_count, -1.0, 1.0);
+                    std::vector<double> b = random_reals(rng, vector_size, slot_count, -1.0, 1.0);
+                    auto plain_a = backend.make_plain();
+                    auto plain_b = backend.make_plain();
+                    auto cipher_a = backend.make_cipher();
+                    auto cipher_b = backend.make_cipher();
+                    auto result = backend.make_cipher();
+                    auto rescaled = backend.make_cipher();
+
+                    Stats encoding = measure(timing, [&] { backend.encode(a, *plain_a); });
+                    backend.encode(b, *plain_b);
+                    Stats encryption = measure(timing, [&] { backend.encrypt(*plain_a, *cipher_a); });
+                    if (!is_plain_op(op)) backend.encrypt(*plain_b, *cipher_b);
+
+                    Stats operation = measure(timing, [&] {
+                        backend.apply(op, *cipher_a, *cipher_b, *plain_b, *result);
+                    });
+                    double capacity_in = backend.capacity_bits(*cipher_a);
+
+                    Stats rescale;
+                    bool did_rescale = false;
+                    backend.copy_cipher(*result, *rescaled);
+                    if (!is_add_op(op) && backend.rescale(*rescaled)) {
+                        did_rescale = true;
+                        rescale = measure_prepared(timing, [&] { backend.copy_cipher(*result, *rescaled); },
+                                                   [&] { backend.rescale(*rescaled); });
+                    }
+
+                    std::vector<double> decoded, expected(slot_count);
+                    Stats decryption = measure(timing, [&] { backend.decrypt(*rescaled, *plain_a); });
+                    backend.decode(*plain_a, decoded);
+                    for (size_t i = 0; i < slot_count; i++) expected[i] = expected_real(op, a[i], b[i]);
+                    Precision precision = measure_precision(decoded, expected, vector_size);
+
+                    log.row(backend.library(), backend.scheme(), degree, slot_count, backend.scale_bits(),
+                            backend.modulus_bits(), vector_size, op_name(op), capacity_in,
+                            backend.capacity_bits(*rescaled), backend.cipher_bytes(*rescaled), encoding, encryption,
+                            operation, rescale, decryption, did_rescale ? 1 : 0, precision.max_error,
+                            precision.bits);
+                    std::cout << "  VectorSize: " << vector_size << ", Operation: " << op_name(op) << ", "
+                              << operation.median_ms << " ms";
+                    if (did_rescale) std::cout << " + rescale " << rescale.median_ms << " ms";
+                    std::cout << ", precision " << precision.bits << " bits" << std::endl;
+                } catch (const std::exception &e) {
+                    std::cout << "Error with PolyModulus: " << degree << ", VectorSize: " << vector_size << ", "
+                              << op_name(op) << " - " << e.what() << std::endl;
+                }
+            }
+        }
+    }
+}
+
+// Outcome of one CKKS depth probe.
+struct CkksDepthResult {
+    int operations = 0;             // longest chain that keeps min_precision_bits
+    std::string limit = "cap";      // what ended it: "precision", "levels" or "cap"
+    double initial_precision = 0;   // bits of the fresh encryption
+    double final_precision = 0;     // bits after `operations` steps
+    double final_capacity = 0;
+    int decryptions = 0;
+};
+
+// Longest chain c_k = c_{k-1} op x (rescaled after products) that still
+// decrypts to within min_precision_bits of initial op x^k, k <= max_ops.
+// Precision only degrades along a chain, so as in depth.h the boundary is
+// found by galloping and binary search, replaying from the last good step.
+inline CkksDepthResult probe_ckks_depth(CkksBackend &backend, OpType op, const std::vector<double> &initial,
+                                        const std::vector<double> &operand, double min_precision_bits,
+                                        int max_ops) {
+    CkksDepthResult result;
+    size_t slot_count = backend.slot_count();
+    auto plain = backend.make_plain();
+    auto plain_x = backend.make_plain();
+    auto cipher_x = backend.make_cipher();
+    backend.encode(operand, *plain_x);
+    if (!is_plain_op(op)) backend.encrypt(*plain_x, *cipher_x);
+
+    auto base = backend.make_cipher();
+    auto cur = backend.make_cipher();
+    auto next = backend.make_cipher();
+    backend.encode(initial, *plain);
+    backend.encrypt(*plain, *base);
+    int base_k = 0;
+
+    std::vector<double> decoded, expected(slot_count);
+    auto precision_of = [&](const Cipher &c, int k) {
+        result.decryptions++;
+        for (size_t i = 0; i < slot_count; i++) {
+            expected[i] = is_add_op(op) ? initial[i] + k * operand[i] : initial[i] * std::pow(operand[i], k);
+        }
+        backend.decrypt(c, *plain);
+        backend.decode(*plain, decoded);
+        return measure_precision(decoded, expected, slot_count).bits;
+    };
+    result.initial_precision = result.final_precision = precision_of(*base, 0);
+
+    // Leaves c_k in cur, or returns false with the reason in `failure`.
+    std::string failure;
+    double precision = 0;
+    auto ok = [&](int k) {
+        try {
+            backend.copy_cipher(*base, *cur);
+            for (int i = base_k; i < k; i++) {
+                backend.apply(op, *cur, *cipher_x, *plain_x, *next);
+                if (!is_add_op(op)) backend.rescale(*next);
+                std::swap(cur, next);
+            }
+        } catch (const std::exception &) {
+            failure = "levels";
+            return false;
+        }
+        precision = precision_of(*cur, k);
+        if (precision < min_precision_bits) {
+            failure = "precision";
+            return false;
+        }
+        return true;
+    };
+    auto accept = [&](int k) {
+        std::swap(base, cur);
+        base_k = k;
+        result.final_precision = precision;
+    };
+
+    int hi = max_ops + 1;
+    std::string hi_failure;
+    while (base_k < max_ops) {
+        int k = std::min(base_k ? 2 * base_k : 1, max_ops);
+        if (!ok(k)) {
+            hi = k;
+            hi_failure = failure;
+            break;
+        }
+        accept(k);
+    }
+    while (hi - base_k > 1) {
+        int mid = base_k + (hi - base_k) / 2;
+        if (ok(mid)) {
+            accept(mid);
+        } else {
+            hi = mid;
+            hi_failure = failure;
+        }
+    }
+
+    result.operations = base_k;
+    if (base_k < max_ops) result.limit = hi_failure;
+    result.final_capacity = backend.capacity_bits(*base);
+    return result;
+}
+
+inline ColumnSet ckks_depth_columns() {
+    return keyed_columns(
+        result_columns({"scale_bits", "modulus_bits", "security_level", "operation_type", "max_operations",
+                        "limit", "min_precision_bits", "initial_precision_bits", "final_precision_bits",
+                        "final_capacity_bits", "decryptions", "probe_ms"}),
+        {"scale_bits", "modulus_bits", "security_level", "operation_type", "min_precision_bits"});
+}
+
+// Depth of every op at every degree, as the depth_*.cpp drivers measure it
+// for BFV, over all slots.
+inline void run_ckks_depth_sweep(CkksBackend &backend, const CkksSweepConfig &config, CsvLog &log) {
+    std::mt19937 rng(config.seed);
+
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " CKKS depth PolyModulus=" << degree << " ===" << std::endl;
+        bool ready = false;
+        for (const auto &params : config.candidates(degree)) {
+            if ((ready = backend.setup(params))) break;
+        }
+        if (!ready) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        size_t slot_count = backend.slot_count();
+        std::vector<double> initial = random_reals(rng, slot_count, slot_count, -1.0, 1.0);
+        std::vector<double> operand = random_reals(rng, slot_count, slot_count, 0.5, 1.5);
+
+        for (auto op : all_ops()) {
+            Timer timer;
+            timer.tic();
+            CkksDepthResult depth;
+            try {
+                depth = probe_ckks_depth(backend, op, initial, operand, config.min_precision_bits, config.max_ops);
+            } catch (const std::exception &e) {
+                std::cout << "  " << op_name(op) << " ERROR: " << e.what() << std::endl;
+                continue;
+            }
+            double probe_ms = timer.toc();
+
+            log.row(backend.library(), backend.scheme(), degree, slot_count, backend.scale_bits(),
+                    backend.modulus_bits(), backend.security_level(), op_name(op), depth.operations, depth.limit,
+                    config.min_precision_bits, depth.initial_precision, depth.final_precision,
+                    depth.final_capacity, depth.decryptions, probe_ms);
+            std::cout << "  Maximum " << op_name(op) << " operations: " << depth.operations << " (" << depth.limit
+                      << "), precision " << depth.initial_precision << " -> " << depth.final_precision
+                      << " bits, " << depth.decryptions << " decryptions, " << probe_ms << " ms" << std::endl;
+        }
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "backend.h"
+#include "results.h"
+#include "store.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Pre-encrypted datasets: ciphertexts stored as entries "ct/<i>" of a store
+// file, in the backend's uncompressed wire format.
+inline void save_dataset(const Backend &backend, const std::vector<std::unique_ptr<Cipher>> &ciphers,
+                         const std::string &path) {
+    StoreWriter store;
+    for (size_t i = 0; i < ciphers.size(); i++) {
+        store.add("ct/" + std::to_string(i), [&](std::ostream &out) {
+            backend.save_cipher(*ciphers[i], backend.wire_formats().front(), out);
+        });
+    }
+    store.write(path);
+}
+
+// Loads every "ct/<i>" of `store` into out, which is resized to `count`.
+inline void load_dataset(Backend &backend, const MappedStore &store, size_t count,
+                         std::vector<std::unique_ptr<Cipher>> &out) {
+    out.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        if (!out[i]) out[i] = backend.make_cipher();
+        auto in = store.stream("ct/" + std::to_string(i));
+        backend.load_cipher(in, *out[i]);
+    }
+}
+
+inline ColumnSet cold_start_columns() {
+    return keyed_columns(
+        result_columns({"coeff_modulus_bits", "galois_keys", "generate_ms", "key_load_ms", "key_speedup",
+                        "dataset_ciphertexts", "encrypt_ms", "dataset_bytes", "dataset_load_ms", "page_cache",
+                        "valid"}),
+        {"coeff_modulus_bits", "galois_keys", "dataset_ciphertexts"});
+}
+
+// Evicts every store file in dir from the page cache; false if any refused.
+inline bool evict_store_dir(const std::string &dir) {
+    bool ok = true;
+    for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.is_regular_file()) ok = evict_from_page_cache(entry.path().string()) && ok;
+    }
+    return ok;
+}
+
+// Cold start from the on-disk store versus from scratch, for the first
+// working candidate of every degree: generating keys against loading them
+// from the key store, and encrypting dataset_ciphertexts random full
+// ciphertexts against mapping and loading them from a dataset store. Uses
+// the backend's key cache directory, or a scratch directory under the
+// system temp directory if none is set. Both stores are evicted from the page
+// cache before their timed load; page_cache is "dropped" when the kernel
+// accepted that for every file and "warm" otherwise, in which case the load
+// times are cache hits.
+inline void run_cold_start(Backend &backend, const SweepConfig &config, size_t dataset_ciphertexts, CsvLog &log) {
+    std::string cache_dir = backend.get_key_cache_dir();
+    std::string store_dir = cache_dir;
+    if (store_dir.empty()) store_dir = (std::filesystem::temp_directory_path() / "he_bench_store").string();
+    std::filesystem::create_directories(store_dir);
+    OperandSource source(config);
+
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " cold start, PolyModulus=" << degree << " ===" << std::endl;
+        backend.set_key_cache_dir("");
+        backend.clear_cache();
+        std::vector<ParamSet> candidates = sweep_candidates(config, degree);
+        const ParamSet *params = nullptr;
+        for (const auto &candidate : candidates) {
+            if (backend.setup(candidate)) {
+                params = &candidate;
+                break;
+            }
+        }
+        if (!params) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        double generate_ms = backend.last_setup_ms();
+
+        // Persist (unless a store already exists), then time a cold load.
+        backend.set_key_cache_dir(store_dir);
+        backend.clear_cache();
+        backend.setup(*params);
+        backend.clear_cache();
+        bool keys_evicted = evict_store_dir(store_dir);
+        if (!backend.setup(*params) || backend.last_setup_source() != "disk") {
+            std::cout << "SKIPPING - keys could not be stored in " << store_dir << std::endl;
+            continue;
+        }
+        double key_load_ms = backend.last_setup_ms();
+
+        try {
+            size_t slot_count = backend.slot_count();
+            std::vector<std::vector<uint64_t>> data(dataset_ciphertexts);
+            std::vector<std::unique_ptr<Cipher>> ciphers, loaded;
+            auto plain = backend.make_plain();
+            for (size_t i = 0; i < dataset_ciphertexts; i++) {
+                source.fill_a(data[i], slot_count, slot_count);
+                ciphers.push_back(backend.make_cipher());
+            }
+            Timer timer;
+            timer.tic();
+            for (size_t i = 0; i < dataset_ciphertexts; i++) {
+                backend.encode(data[i], *plain);
+                backend.encrypt(*plain, *ciphers[i]);
+            }
+            double encrypt_ms = timer.toc();
+
+            std::string path = store_dir + "/dataset_" + backend.library() + "_" + params->cache_key() + ".store";
+            save_dataset(backend, ciphers, path);
+            bool dropped = keys_evicted && evict_from_page_cache(path);
+            timer.tic();
+            size_t dataset_bytes;
+            {
+                MappedStore store(path);
+                dataset_bytes = store.file_bytes();
+                load_dataset(backend, store, dataset_ciphertexts, loaded);
+            }
+            double load_ms = timer.toc();
+
+            bool valid = true;
+            std::vector<uint64_t> decoded;
+            for (size_t i = 0; i < dataset_ciphertexts && valid; i++) {
+                backend.decrypt(*loaded[i], *plain);
+                backend.decode(*plain, decoded);
+                valid = decoded == data[i];
+            }
+
+            double speedup = key_load_ms > 0 ? generate_ms / key_load_ms : 0;
+            log.row(backend.library(), backend.scheme(), degree, slot_count, coeff_modulus_string(*params),
+                    params->galois_keys ? 1 : 0, generate_ms, key_load_ms, speedup, dataset_ciphertexts,
+                    encrypt_ms, dataset_bytes, load_ms, dropped ? "dropped" : "warm", valid ? 1 : 0);
+            std::cout << "  Keys: generate " << generate_ms << " ms, load " << key_load_ms << " ms (" << speedup
+                      << "x); dataset of " << dataset_ciphertexts << ": encrypt " << encrypt_ms << " ms, load "
+                      << load_ms << " ms, " << dataset_bytes / (1024 * 1024) << " MB"
+                      << (dropped ? "" : ", warm page cache") << (valid ? "" : ", INVALID") << std::endl;
+        } catch (const std::exception &e) {
+            std::cout << "Error with PolyModulus: " << degree << " - " << e.what() << std::endl;
+        }
+    }
+    backend.set_key_cache_dir(cache_dir);
+}
+
+} // namespace bench
@@ -0,0 +1,221 @@
+#pragma once
+
+#include "backend.h"
+#include "parallel.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+enum class DataPattern {
+    Same,   // one constant per operand in every used slot
+    Random  // uniform integers in [1, random_max]
+};
+
+// Everything the operand values depend on.
+struct DataSpec {
+    DataPattern pattern = DataPattern::Same;
+    uint64_t same_a = 42;
+    uint64_t same_b = 42;
+    uint64_t random_max = 100;
+    uint32_t seed = 42;
+
+    std::string cache_key() const {
+        char buf[96];
+        if (pattern == DataPattern::Same) {
+            std::snprintf(buf, sizeof(buf), "same_%llu_%llu",
+                          static_cast<unsigned long long>(same_a), static_cast<unsigned long long>(same_b));
+        } else {
+            std::snprintf(buf, sizeof(buf), "random_%llu_s%u",
+                          static_cast<unsigned long long>(random_max), static_cast<unsigned>(seed));
+        }
+        return buf;
+    }
+};
+
+inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Element `index` of operand `which` (0 = left, 1 = right): a hash of the
+// seed, operand and index rather than a position in a generator's stream,
+// so any element can be produced on its own. The values therefore depend
+// neither on how many threads generate them nor on the order cells draw
+// them, and every library sees the same vector. The modulo bias is below
+// 2^-56 for the small bounds the drivers use.
+inline uint64_t operand_value(const DataSpec &spec, int which, uint64_t index) {
+    if (spec.pattern == DataPattern::Same) return which == 0 ? spec.same_a : spec.same_b;
+    uint64_t stream = splitmix64((static_cast<uint64_t>(spec.seed) << 1) | static_cast<uint64_t>(which));
+    return 1 + splitmix64(stream ^ index) % spec.random_max;
+}
+
+// Both operands of one vector size, generated up front. Chunks are views of
+// the flat vectors, so one dataset serves every degree.
+class Dataset {
+private:
+    std::vector<uint64_t> a, b;
+
+    static void copy_chunk(const std::vector<uint64_t> &from, size_t chunk, size_t slot_count,
+                           std::vector<uint64_t> &out) {
+        size_t begin = std::min(from.size(), chunk * slot_count);
+        size_t end = std::min(from.size(), begin + slot_count);
+        out.assign(slot_count, 0);
+        std::copy(from.begin() + begin, from.begin() + end, out.begin());
+    }
+
+public:
+    Dataset() = default;
+
+    // Splits the vector across `threads` threads, each hashing its own range.
+    Dataset(const DataSpec &spec, size_t vector_size, size_t threads) : a(vector_size), b(vector_size) {
+        threads = std::max<size_t>(1, std::min(threads, vector_size / 4096 + 1));
+        size_t block = (vector_size + threads - 1) / threads;
+        run_on_threads(threads, [&](size_t t) {
+            size_t end = std::min(vector_size, (t + 1) * block);
+            for (size_t i = t * block; i < end; i++) {
+                a[i] = operand_value(spec, 0, i);
+                b[i] = operand_value(spec, 1, i);
+            }
+        });
+    }
+
+    size_t size() const { return a.size(); }
+    size_t chunks(size_t slot_count) const { return (a.size() + slot_count - 1) / slot_count; }
+    size_t chunk_size(size_t chunk, size_t slot_count) const {
+        return std::min(slot_count, a.size() - chunk * slot_count);
+    }
+
+    // Chunk `chunk` of the left / right operand, zero-padded to slot_count.
+    void chunk_a(size_t chunk, size_t slot_count, std::vector<uint64_t> &out) const {
+        copy_chunk(a, chunk, slot_count, out);
+    }
+    void chunk_b(size_t chunk, size_t slot_count, std::vector<uint64_t> &out) const {
+        copy_chunk(b, chunk, slot_count, out);
+    }
+
+    // Raw file: 8-byte magic "HEBDATA1", uint64 element count, then both
+    // operands. Written through a temporary file and a rename.
+    void save(const std::string &path) const {
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            uint64_t count = a.size();
+            out.write("HEBDATA1", 8);
+            out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+            out.write(reinterpret_cast<const char *>(a.data()), static_cast<std::streamsize>(count * sizeof(uint64_t)));
+            out.write(reinterpret_cast<const char *>(b.data()), static_cast<std::streamsize>(count * sizeof(uint64_t)));
+            if (!out) throw std::runtime_error("cannot write " + tmp);
+        }
+        std::filesystem::rename(tmp, path);
+    }
+
+    static Dataset load(const std::string &path, size_t vector_size) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("cannot open " + path);
+        char magic[8];
+        uint64_t count = 0;
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char *>(&count), sizeof(count));
+        if (!in || std::memcmp(magic, "HEBDATA1", 8) != 0) throw std::runtime_error("not a dataset file");
+        if (count != vector_size) throw std::runtime_error("dataset holds " + std::to_string(count) + " elements");
+        Dataset d;
+        d.a.resize(count);
+        d.b.resize(count);
+        in.read(reinterpret_cast<char *>(d.a.data()), static_cast<std::streamsize>(count * sizeof(uint64_t)));
+        in.read(reinterpret_cast<char *>(d.b.data()), static_cast<std::streamsize>(count * sizeof(uint64_t)));
+        if (!in) throw std::runtime_error("truncated dataset file");
+        return d;
+    }
+};
+
+// Datasets of every vector size of a sweep, prepared once before the first
+// cell. With a cache directory, each is read from
+// <dir>/dataset_<spec>_<size>.bin when present and written there otherwise.
+class DatasetStore {
+private:
+    DataSpec spec;
+    std::map<size_t, Dataset> datasets;
+
+public:
+    size_t threads = 1;
+    std::string cache_dir;
+
+    explicit DatasetStore(const DataSpec &spec) : spec(spec) {}
+
+    std::string cache_path(size_t vector_size) const {
+        return cache_dir + "/dataset_" + spec.cache_key() + "_" + std::to_string(vector_size) + ".bin";
+    }
+
+    const Dataset &get(size_t vector_size) {
+        auto it = datasets.find(vector_size);
+        if (it != datasets.end()) return it->second;
+        if (!cache_dir.empty()) {
+            try {
+                return datasets[vector_size] = Dataset::load(cache_path(vector_size), vector_size);
+            } catch (const std::exception &) {
+                // Missing or stale; regenerate below.
+            }
+        }
+        Dataset &d = datasets[vector_size] = Dataset(spec, vector_size, threads);
+        if (!cache_dir.empty()) {
+            try {
+                std::filesystem::create_directories(cache_dir);
+                d.save(cache_path(vector_size));
+            } catch (const std::exception &e) {
+                std::cout << "  Could not persist dataset to " << cache_path(vector_size) << ": " << e.what()
+                          << std::endl;
+            }
+        }
+        return d;
+    }
+
+    // Generates (or loads) every size up front and reports how long it took.
+    void prepare(const std::vector<size_t> &vector_sizes) {
+        Timer timer;
+        timer.tic();
+        size_t elements = 0;
+        for (auto vector_size : vector_sizes) elements += get(vector_size).size();
+        std::cout << "Prepared " << vector_sizes.size() << " datasets (" << elements << " elements per operand) in "
+                  << timer.toc() << " ms on " << threads << " threads"
+                  << (cache_dir.empty() ? "" : ", cache " + cache_dir) << std::endl;
+    }
+};
+
+// Both operands of a dataset encoded chunk by chunk at one degree, in the
+// backend's current plain_encoding(), for cells that only need them as
+// encryption inputs. Built once per degree and vector size and shared by
+// every op, encoding and allocation mode.
+struct EncodedDataset {
+    std::vector<std::unique_ptr<Plain>> a, b;
+
+    EncodedDataset(Backend &backend, const Dataset &dataset) {
+        size_t slot_count = backend.slot_count();
+        std::vector<uint64_t> values;
+        for (size_t i = 0; i < dataset.chunks(slot_count); i++) {
+            a.push_back(backend.make_plain());
+            b.push_back(backend.make_plain());
+            dataset.chunk_a(i, slot_count, values);
+            backend.encode(values, *a.back());
+            dataset.chunk_b(i, slot_count, values);
+            backend.encode(values, *b.back());
+        }
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "backend.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// a * b mod m without overflow for moduli up to 64 bits.
+inline uint64_t mul_mod(uint64_t a, uint64_t b, uint64_t m) {
+    return static_cast<uint64_t>(static_cast<unsigned __int128>(a) * b % m);
+}
+
+// base^exp mod m by square-and-multiply.
+inline uint64_t pow_mod(uint64_t base, uint64_t exp, uint64_t m) {
+    uint64_t result = 1 % m;
+    base %= m;
+    while (exp) {
+        if (exp & 1) result = mul_mod(result, base, m);
+        base = mul_mod(base, base, m);
+        exp >>= 1;
+    }
+    return result;
+}
+
+// Outcome of one depth probe.
+struct DepthResult {
+    int operations = 0;         // longest chain that still decrypts correctly
+    int budget_operations = 0;  // longest chain with a positive noise budget
+    double initial_budget = 0;  // bits left in the fresh ciphertext
+    double final_budget = 0;    // bits left after `operations` steps
+    int budget_checks = 0;
+    int decryptions = 0;
+    bool capped = false;        // max_ops reached without running out of noise
+};
+
+// Longest chain c_k = step(c_{k-1}), k <= max_ops, starting from an
+// encryption of `initial` that still decrypts to expected(slot, k).
+//
+// The noise budget is monotone along a chain, so the boundary is found by
+// galloping (k = 1, 2, 4, ...) and binary search on noise_budget() > 0,
+// replaying steps from the last good checkpoint instead of decrypting. Only
+// the boundary is decrypted: if it is correct the chain is extended while
+// decryptions stay correct (the budget is a bound, not exact); if not, the
+// boundary is binary-searched again on decryption.
+template <typename Step, typename Expected>
+DepthResult probe_chain(Backend &backend, const std::vector<uint64_t> &initial, int max_ops,
+                        Step &&step, Expected &&expected) {
+    DepthResult result;
+    auto plain = backend.make_plain();
+    auto fresh = backend.make_cipher();
+    backend.encode(initial, *plain);
+    backend.encrypt(*plain, *fresh);
+    result.initial_budget = backend.noise_budget(*fresh);
+
+    // c_k for the newest good k is kept in `checkpoint` (fresh for k = 0).
+    std::unique_ptr<Cipher> checkpoint;
+    auto cur = backend.make_cipher();
+    auto next = backend.make_cipher();
+    const Cipher *base = fresh.get();
+    int base_k = 0;
+
+    // Leaves c_k in cur; false if the library gave up on the way.
+    auto advance = [&](int k) {
+        const Cipher *in = base;
+        try {
+            for (int i = base_k; i < k; i++) {
+                step(*in, *next);
+                std::swap(cur, next);
+                in = cur.get();
+            }
+        } catch (const std::exception &) {
+            return false;
+        }
+        return true;
+    };
+    auto accept = [&](int k) {
+        checkpoint = std::move(cur);
+        cur = backend.make_cipher();
+        base = checkpoint.get();
+        base_k = k;
+    };
+    auto budget_ok = [&](int k) {
+        if (!advance(k)) return false;
+        result.budget_checks++;
+        return backend.noise_budget(*cur) > 0;
+    };
+    std::vector<uint64_t> decoded;
+    auto decrypts_ok = [&](const Cipher &c, int k) {
+        result.decryptions++;
+        backend.decrypt(c, *plain);
+        backend.decode(*plain, decoded);
+        for (size_t i = 0; i < initial.size(); i++) {
+            if (decoded[i] != expected(i, k)) return false;
+        }
+        return true;
+    };
+
+    int hi = max_ops + 1;
+    while (base_k < max_ops) {
+        int k = std::min(base_k ? 2 * base_k : 1, max_ops);
+        if (!budget_ok(k)) {
+            hi = k;
+            break;
+        }
+        accept(k);
+    }
+    while (hi - base_k > 1) {
+        int mid = base_k + (hi - base_k) / 2;
+        if (budget_ok(mid)) {
+            accept(mid);
+        } else {
+            hi = mid;
+        }
+    }
+    result.budget_operations = base_k;
+
+    if (decrypts_ok(*base, base_k)) {
+        while (base_k < max_ops && advance(base_k + 1) && decrypts_ok(*cur, base_k + 1)) {
+            accept(base_k + 1);
+        }
+    } else {
+        hi = base_k;
+        base = fresh.get();
+        base_k = 0;
+        while (hi - base_k > 1) {
+            int mid = base_k + (hi - base_k) / 2;
+            if (advance(mid) && decrypts_ok(*cur, mid)) {
+                accept(mid);
+            } else {
+                hi = mid;
+            }
+        }
+    }
+
+    result.operations = base_k;
+    result.capped = base_k == max_ops;
+    result.final_budget = backend.noise_budget(*base);
+    return result;
+}
+
+// Chain c_k = c_{k-1} op x, as in the depth_*.cpp drivers: x is an
+// encryption (cipher ops) or encoding (plain ops) of `operand`.
+inline DepthResult probe_op_depth(Backend &backend, OpType op, const std::vector<uint64_t> &initial,
+                                  const std::vector<uint64_t> &operand, int max_ops) {
+    uint64_t t = backend.plain_modulus();
+    auto plain_x = backend.make_plain();
+    auto cipher_x = backend.make_cipher();
+    backend.encode(operand, *plain_x);
+    if (!is_plain_op(op)) {
+        backend.encrypt(*plain_x, *cipher_x);
+    }
+    auto step = [&](const Cipher &in, Cipher &out) { backend.apply(op, in, *cipher_x, *plain_x, out); };
+    auto expected = [&](size_t i, int k) {
+        uint64_t v = initial[i] % t;
+        if (is_add_op(op)) return (v + mul_mod(static_cast<uint64_t>(k) % t, operand[i], t)) % t;
+        return mul_mod(v, pow_mod(operand[i], static_cast<uint64_t>(k), t), t);
+    };
+    return probe_chain(backend, initial, max_ops, step, expected);
+}
+
+// Multiplicative depth: repeated squaring (multiply + relinearize) of a
+// fresh encryption, up to max_depth squarings. Slots hold small distinct
+// values so a wrong slot cannot hide behind a result of 0 or 1. The
+// expected v^(2^k) uses Fermat's little theorem on the prime plain modulus.
+inline DepthResult probe_mul_depth(Backend &backend, int max_depth) {
+    size_t slot_count = backend.slot_count();
+    uint64_t t = backend.plain_modulus();
+    std::vector<uint64_t> initial(slot_count);
+    for (size_t i = 0; i < slot_count; i++) {
+        initial[i] = (i % 7 + 2) % t;
+    }
+    auto step = [&](const Cipher &in, Cipher &out) { backend.multiply(in, in, out); };
+    auto expected = [&](size_t i, int k) -> uint64_t {
+        if (initial[i] == 0) return 0;
+        return pow_mod(initial[i], pow_mod(2, static_cast<uint64_t>(k), t - 1), t);
+    };
+    return probe_chain(backend, initial, max_depth, step, expected);
+}
+
+} // namespace bench
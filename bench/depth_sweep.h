@@ -0,0 +1,89 @@
+#pragma once
+
+#include "backend.h"
+#include "depth.h"
+#include "results.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace bench {
+
+// How many times an operation can be chained before decryption fails, at
+// every degree and parameter set.
+struct DepthSweepConfig {
+    std::vector<size_t> poly_modulus_degrees;
+
+    // Every candidate of a degree is probed (not just the first that works),
+    // so one degree can be swept over several plain moduli.
+    std::function<std::vector<ParamSet>(size_t)> candidates;
+
+    OpType op = OpType::CipherMulCipher;
+
+    // The first vector_size slots hold `value` in both the starting
+    // ciphertext and the operand; the rest are zero.
+    size_t vector_size = 16;
+    uint64_t value = 2;
+
+    // Chains stop here and are reported as capped.
+    int max_ops = 16384;
+};
+
+inline ColumnSet depth_sweep_columns() {
+    return keyed_columns(
+        result_columns({"plain_modulus", "modulus_bits", "security_level", "operation_type",
+                        "max_operations", "budget_operations", "capped",
+                        "initial_noise_budget", "final_noise_budget",
+                        "budget_checks", "decryptions", "probe_ms"}),
+        {"plain_modulus", "modulus_bits", "security_level", "operation_type"});
+}
+
+inline void run_depth_sweep(Backend &backend, const DepthSweepConfig &config, CsvLog &log) {
+    for (auto degree : config.poly_modulus_degrees) {
+        for (const auto &params : config.candidates(degree)) {
+            std::cout << "\nTesting " << params.describe() << std::endl;
+            if (!backend.setup(params)) {
+                std::cout << "  ERROR: parameters rejected" << std::endl;
+                continue;
+            }
+            size_t slot_count = backend.slot_count();
+            if (config.vector_size > slot_count) {
+                std::cout << "  Skipping - not enough slots (" << slot_count << ")" << std::endl;
+                continue;
+            }
+
+            std::vector<uint64_t> values(slot_count, 0);
+            std::fill(values.begin(), values.begin() + config.vector_size, config.value);
+
+            Timer timer;
+            timer.tic();
+            DepthResult depth;
+            try {
+                depth = probe_op_depth(backend, config.op, values, values, config.max_ops);
+            } catch (const std::exception &e) {
+                std::cout << "  ERROR: " << e.what() << std::endl;
+                continue;
+            }
+            double probe_ms = timer.toc();
+
+            log.row(backend.library(), backend.scheme(), degree, slot_count,
+                    backend.plain_modulus(), backend.modulus_bits(), backend.security_level(),
+                    op_name(config.op), depth.operations, depth.budget_operations, depth.capped ? 1 : 0,
+                    depth.initial_budget, depth.final_budget, depth.budget_checks, depth.decryptions,
+                    probe_ms);
+
+            std::cout << "  q=" << backend.modulus_bits() << " bits, t=" << backend.plain_modulus()
+                      << ", noise budget " << depth.initial_budget << " bits" << std::endl;
+            std::cout << "  Maximum " << op_name(config.op) << " operations: " << depth.operations
+                      << (depth.capped ? " (cap)" : "") << " - " << depth.budget_checks << " budget checks, "
+                      << depth.decryptions << " decryptions, " << probe_ms << " ms" << std::endl;
+        }
+    }
+}
+
+} // namespace bench
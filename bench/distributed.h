@@ -0,0 +1,414 @@
+#pragma once
+
+#include "backend.h"
+#include "depth.h"
+#include "kernels.h"
+#include "net.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+// Frames of the coordinator / worker protocol (see net.h):
+//   EvalKeys  coordinator -> worker: result wire format, evaluation key
+//             bundle (Backend::save_eval_keys). Answered with an empty
+//             Result once the worker is set up.
+//   Task      coordinator -> worker: task kind, chunk index, the serialized
+//             left operand, then the serialized right operand (cipher
+//             tasks) or its raw slot values (plain ops, encoded by the
+//             worker).
+//   Result    worker -> coordinator: chunk index, serialized result.
+enum class Message : uint32_t { EvalKeys = 1, Task = 2, Result = 3 };
+
+// Task kinds: the OpType values, plus x . y of one chunk pair summed
+// within each batch row by rotate-and-sum.
+constexpr uint32_t DotProductTask = 4;
+
+inline std::string task_name(uint32_t kind) {
+    if (kind == DotProductTask) return "DOT_PRODUCT";
+    return op_name(static_cast<OpType>(kind));
+}
+
+inline std::vector<uint32_t> distributed_tasks() {
+    std::vector<uint32_t> tasks;
+    for (auto op : all_ops()) tasks.push_back(static_cast<uint32_t>(op));
+    tasks.push_back(DotProductTask);
+    return tasks;
+}
+
+inline bool is_plain_task(uint32_t kind) {
+    return kind != DotProductTask && is_plain_op(static_cast<OpType>(kind));
+}
+
+struct WorkerAddress {
+    std::string host;
+    std::string port;
+
+    std::string name() const { return host + ":" + port; }
+};
+
+// "host:port", or a bare port on localhost.
+inline WorkerAddress parse_worker_address(const std::string &spec) {
+    size_t colon = spec.rfind(':');
+    if (colon == std::string::npos) return {"localhost", spec};
+    return {spec.substr(0, colon), spec.substr(colon + 1)};
+}
+
+// Worker side of one coordinator connection: tasks are evaluated one at a
+// time, in arrival order, until the coordinator hangs up.
+inline void serve_coordinator(Backend &backend, Socket &socket) {
+    uint32_t type = 0;
+    std::string payload;
+    std::string format;
+    std::unique_ptr<Plain> plain;
+    std::unique_ptr<Cipher> a, b, result, tmp;
+    std::vector<uint64_t> values;
+
+    while (read_frame(socket, type, payload)) {
+        FrameReader in(payload);
+        if (type == static_cast<uint32_t>(Message::EvalKeys)) {
+            format = in.get_bytes();
+            std::istringstream bundle(in.get_bytes());
+            if (!backend.setup_eval_keys(bundle)) throw std::runtime_error("evaluation keys rejected");
+            plain = backend.make_plain();
+            a = backend.make_cipher();
+            b = backend.make_cipher();
+            result = backend.make_cipher();
+            tmp = backend.make_cipher();
+            std::cout << "  Evaluation keys loaded (" << payload.size() / 1024 << " KB, "
+                      << backend.last_setup_ms() << " ms)" << std::endl;
+            write_frame(socket, static_cast<uint32_t>(Message::Result), "");
+            continue;
+        }
+        if (type != static_cast<uint32_t>(Message::Task) || !a) throw std::runtime_error("unexpected frame");
+
+        uint32_t kind = in.get_u32();
+        uint64_t chunk = in.get_u64();
+        std::istringstream wire_a(in.get_bytes());
+        backend.load_cipher(wire_a, *a);
+        std::string operand = in.get_bytes();
+        if (is_plain_task(kind)) {
+            values.resize(operand.size() / sizeof(uint64_t));
+            std::memcpy(values.data(), operand.data(), values.size() * sizeof(uint64_t));
+            backend.encode(values, *plain);
+        } else {
+            std::istringstream wire_b(operand);
+            backend.load_cipher(wire_b, *b);
+        }
+
+        if (kind == DotProductTask) {
+            dot_product(backend, *a, *b, backend.row_size(), *result, *tmp);
+        } else {
+            backend.apply(static_cast<OpType>(kind), *a, *b, *plain, *result);
+        }
+
+        std::ostringstream out;
+        backend.save_cipher(*result, format, out);
+        FrameWriter reply;
+        reply.put_u64(chunk);
+        reply.put_bytes(out.str());
+        write_frame(socket, static_cast<uint32_t>(Message::Result), reply.data());
+    }
+}
+
+// --worker=PORT: serves coordinators one connection at a time, forever.
+// The worker never holds a secret key; each connection brings its own
+// evaluation keys.
+inline void run_distributed_worker(Backend &backend, const std::string &port) {
+    Listener listener(port);
+    std::cout << backend.library() << " " << backend.scheme() << " worker listening on port " << port << std::endl;
+    while (true) {
+        Socket socket = listener.accept_one();
+        std::cout << "Coordinator connected" << std::endl;
+        try {
+            serve_coordinator(backend, socket);
+            std::cout << "Coordinator disconnected" << std::endl;
+        } catch (const std::exception &e) {
+            std::cout << "Connection dropped - " << e.what() << std::endl;
+        }
+    }
+}
+
+// Coordinator's connection to one worker, kept for a whole degree.
+struct WorkerLink {
+    WorkerAddress address;
+    Socket socket;
+    size_t key_bytes = 0;
+    double key_ms = 0;  // until the worker acknowledged its setup
+};
+
+// Connects to every worker and hands each the evaluation keys of the
+// backend's current setup, one after another.
+inline std::vector<WorkerLink> connect_workers(const Backend &backend, const std::vector<WorkerAddress> &workers,
+                                               const std::string &format) {
+    std::ostringstream bundle;
+    backend.save_eval_keys(bundle);
+    FrameWriter frame;
+    frame.put_bytes(format);
+    frame.put_bytes(bundle.str());
+
+    std::vector<WorkerLink> links;
+    for (const auto &address : workers) {
+        WorkerLink link;
+        link.address = address;
+        Timer timer;
+        timer.tic();
+        link.socket = Socket::connect_to(address.host, address.port);
+        write_frame(link.socket, static_cast<uint32_t>(Message::EvalKeys), frame.data());
+        uint32_t type = 0;
+        std::string ack;
+        if (!read_frame(link.socket, type, ack) || type != static_cast<uint32_t>(Message::Result)) {
+            throw std::runtime_error("worker " + address.name() + " rejected the evaluation keys");
+        }
+        link.key_ms = timer.toc();
+        link.key_bytes = link.socket.bytes_sent();
+        links.push_back(std::move(link));
+    }
+    return links;
+}
+
+inline ColumnSet distributed_columns() {
+    return keyed_columns(
+        result_columns({"vector_size", "num_ciphertexts", "task", "wire_format", "nodes", "node",
+                        "node_chunks", "key_bytes", "key_ms", "bytes_sent", "bytes_received",
+                        "encrypt_ms", "node_ms", "end_to_end_ms", "ciphertexts_per_s", "speedup", "valid"}),
+        {"vector_size", "num_ciphertexts", "task", "wire_format", "nodes", "node"});
+}
+
+// One (degree, vector_size, task, nodes) cell on the first `nodes` links.
+// The data owner encrypts and serializes every chunk before the clock
+// starts; chunk i then goes to node i % nodes. Per node, one thread streams
+// tasks while another collects results as they arrive, so transfer and
+// evaluation overlap. The clock stops once every result is back and
+// deserialized and, for DOT_PRODUCT, the per-chunk partial sums have been
+// added into one ciphertext by the coordinator. Validation decrypts
+// afterwards. Logs one row per node and an "all" row, with the speedup of
+// end-to-end latency over baseline_ms. Returns the end-to-end latency.
+inline double run_distributed_cell(Backend &backend, std::vector<WorkerLink> &links, size_t nodes, size_t degree,
+                                   size_t vector_size, uint32_t task, const std::string &format,
+                                   double baseline_ms, const Dataset &dataset, CsvLog &log) {
+    size_t slot_count = backend.slot_count();
+    size_t row_size = backend.row_size();
+    size_t num_ciphertexts = (vector_size + slot_count - 1) / slot_count;
+    uint64_t t = backend.plain_modulus();
+    bool plain_task = is_plain_task(task);
+
+    ChunkedOperands inputs(dataset, slot_count);
+    std::vector<std::string> wire_a(num_ciphertexts), wire_b(num_ciphertexts);
+    auto plain = backend.make_plain();
+    auto cipher = backend.make_cipher();
+    Timer timer;
+    timer.tic();
+    for (size_t i = 0; i < num_ciphertexts; i++) {
+        std::ostringstream out_a;
+        backend.encode(inputs.a[i], *plain);
+        backend.encrypt(*plain, *cipher);
+        backend.save_cipher(*cipher, format, out_a);
+        wire_a[i] = out_a.str();
+        if (plain_task) {
+            wire_b[i].assign(reinterpret_cast<const char *>(inputs.b[i].data()), slot_count * sizeof(uint64_t));
+        } else {
+            std::ostringstream out_b;
+            backend.encode(inputs.b[i], *plain);
+            backend.encrypt(*plain, *cipher);
+            backend.save_cipher(*cipher, format, out_b);
+            wire_b[i] = out_b.str();
+        }
+    }
+    double encrypt_ms = timer.toc();
+
+    std::vector<size_t> sent_before(nodes), received_before(nodes), node_chunks(nodes, 0);
+    for (size_t n = 0; n < nodes; n++) {
+        sent_before[n] = links[n].socket.bytes_sent();
+        received_before[n] = links[n].socket.bytes_received();
+        for (size_t i = n; i < num_ciphertexts; i += nodes) node_chunks[n]++;
+    }
+    std::vector<std::string> wire_results(num_ciphertexts);
+    std::vector<double> node_ms(nodes, 0);
+    std::vector<std::string> errors(nodes);
+
+    Timer wall;
+    wall.tic();
+    std::vector<std::thread> receivers;
+    for (size_t n = 0; n < nodes; n++) {
+        receivers.emplace_back([&, n] {
+            Socket &socket = links[n].socket;
+            std::string send_error;
+            std::thread sender([&] {
+                try {
+                    for (size_t i = n; i < num_ciphertexts; i += nodes) {
+                        FrameWriter frame;
+                        frame.put_u32(task);
+                        frame.put_u64(i);
+                        frame.put_bytes(wire_a[i]);
+                        frame.put_bytes(wire_b[i]);
+                        write_frame(socket, static_cast<uint32_t>(Message::Task), frame.data());
+                    }
+                } catch (const std::exception &e) {
+                    send_error = e.what();
+                }
+            });
+            try {
+                uint32_t type = 0;
+                std::string payload;
+                for (size_t k = 0; k < node_chunks[n]; k++) {
+                    if (!read_frame(socket, type, payload)) throw std::runtime_error("worker hung up");
+                    FrameReader in(payload);
+                    size_t chunk = static_cast<size_t>(in.get_u64());
+                    if (chunk >= num_ciphertexts) throw std::runtime_error("result for unknown chunk");
+                    wire_results[chunk] = in.get_bytes();
+                }
+                node_ms[n] = wall.toc();
+            } catch (const std::exception &e) {
+                errors[n] = e.what();
+            }
+            sender.join();
+            if (errors[n].empty()) errors[n] = send_error;
+        });
+    }
+    for (auto &receiver : receivers) receiver.join();
+    for (size_t n = 0; n < nodes; n++) {
+        if (!errors[n].empty()) throw std::runtime_error(links[n].address.name() + ": " + errors[n]);
+    }
+
+    std::vector<std::unique_ptr<Cipher>> results(num_ciphertexts);
+    for (size_t i = 0; i < num_ciphertexts; i++) {
+        results[i] = backend.make_cipher();
+        std::istringstream in(wire_results[i]);
+        backend.load_cipher(in, *results[i]);
+        if (task == DotProductTask && i > 0) backend.add_inplace(*results[0], *results[i]);
+    }
+    double end_to_end_ms = wall.toc();
+
+    bool valid = true;
+    std::vector<uint64_t> decoded;
+    if (task == DotProductTask) {
+        uint64_t expected = 0;
+        for (size_t i = 0; i < num_ciphertexts; i++) {
+            for (size_t j = 0; j < inputs.used[i]; j++) expected = (expected + mul_mod(inputs.a[i][j], inputs.b[i][j], t)) % t;
+        }
+        backend.decrypt(*results[0], *plain);
+        backend.decode(*plain, decoded);
+        uint64_t total = 0;
+        for (size_t r = 0; r < slot_count; r += row_size) total = (total + decoded[r]) % t;
+        valid = total == expected;
+    } else {
+        OpType op = static_cast<OpType>(task);
+        for (size_t i = 0; i < num_ciphertexts && valid; i++) {
+            backend.decrypt(*results[i], *plain);
+            backend.decode(*plain, decoded);
+            for (size_t j = 0; j < inputs.used[i]; j++) {
+                if (decoded[j] != expected_value(op, inputs.a[i][j], inputs.b[i][j], t)) {
+                    valid = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    double speedup = baseline_ms > 0 ? baseline_ms / end_to_end_ms : 1.0;
+    size_t key_bytes = 0, sent = 0, received = 0;
+    double key_ms = 0, slowest_ms = 0;
+    for (size_t n = 0; n < nodes; n++) {
+        const WorkerLink &link = links[n];
+        size_t node_sent = link.socket.bytes_sent() - sent_before[n];
+        size_t node_received = link.socket.bytes_received() - received_before[n];
+        double per_s = node_ms[n] > 0 ? node_chunks[n] / (node_ms[n] / 1000.0) : 0;
+        log.row(backend.library(), backend.scheme(), degree, slot_count, vector_size, num_ciphertexts,
+                task_name(task), format, nodes, link.address.name(), node_chunks[n], link.key_bytes, link.key_ms,
+                node_sent, node_received, encrypt_ms, node_ms[n], end_to_end_ms, per_s, speedup, valid ? 1 : 0);
+        std::cout << "    " << link.address.name() << ": " << node_chunks[n] << " chunks, "
+                  << (node_sent + node_received) / 1024 << " KB, " << node_ms[n] << " ms" << std::endl;
+        key_bytes += link.key_bytes;
+        key_ms += link.key_ms;
+        sent += node_sent;
+        received += node_received;
+        slowest_ms = std::max(slowest_ms, node_ms[n]);
+    }
+    double per_s = num_ciphertexts / (end_to_end_ms / 1000.0);
+    log.row(backend.library(), backend.scheme(), degree, slot_count, vector_size, num_ciphertexts,
+            task_name(task), format, nodes, "all", num_ciphertexts, key_bytes, key_ms, sent, received,
+            encrypt_ms, slowest_ms, end_to_end_ms, per_s, speedup, valid ? 1 : 0);
+
+    std::cout << "  " << backend.library() << " PolyModulus: " << degree << ", VectorSize: " << vector_size
+              << ", Task: " << task_name(task) << ", Nodes: " << nodes << ", End-to-end: " << end_to_end_ms
+              << " ms, Network: " << (sent + received) / 1024 << " KB, Throughput: " << per_s << " ct/s"
+              << ", Speedup: " << speedup << ", Valid: " << (valid ? "YES" : "NO") << std::endl;
+    return end_to_end_ms;
+}
+
+// Every degree x vector size x task (the element-wise ops and, when a batch
+// row is a power of two, DOT_PRODUCT) over 1, 2, ... of `workers` nodes.
+// The coordinator keeps the secret key to itself: workers get the
+// evaluation keys once per degree over the connection they keep for it.
+// Candidates get Galois keys (the library's default set unless the
+// workload declared its rotations) for the dot product. Results travel in
+// `format`, or the backend's first wire format if empty.
+inline void run_distributed_sweep(Backend &backend, const SweepConfig &config,
+                                  const std::vector<WorkerAddress> &workers, const std::string &format,
+                                  CsvLog &log) {
+    DatasetStore datasets = sweep_datasets(config);
+    datasets.prepare(config.vector_sizes);
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " distributed PolyModulus=" << degree << ", "
+                  << workers.size() << " workers ===" << std::endl;
+        std::vector<ParamSet> candidates = sweep_candidates(config, degree);
+        for (auto &params : candidates) params.galois_keys = true;
+        if (!setup_first_working(backend, candidates)) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        if (backend.slot_count() < config.min_slots) {
+            std::cout << "SKIPPING - too few slots" << std::endl;
+            continue;
+        }
+        std::string wire_format = format.empty() ? backend.wire_formats().front() : format;
+        size_t row_size = backend.row_size();
+        bool dot_fits = row_size >= 2 && (row_size & (row_size - 1)) == 0;
+
+        std::vector<WorkerLink> links;
+        try {
+            links = connect_workers(backend, workers, wire_format);
+        } catch (const std::exception &e) {
+            std::cout << "Error with PolyModulus: " << degree << " - " << e.what() << std::endl;
+            continue;
+        }
+        for (const auto &link : links) {
+            std::cout << "  " << link.address.name() << ": evaluation keys " << link.key_bytes / 1024 << " KB in "
+                      << link.key_ms << " ms" << std::endl;
+        }
+
+        for (auto vector_size : config.vector_sizes) {
+            for (auto task : distributed_tasks()) {
+                if (task == DotProductTask && !dot_fits) continue;
+                double baseline_ms = 0;
+                for (size_t nodes = 1; nodes <= links.size(); nodes++) {
+                    try {
+                        double ms = run_distributed_cell(backend, links, nodes, degree, vector_size, task,
+                                                         wire_format, baseline_ms, datasets.get(vector_size), log);
+                        if (baseline_ms == 0) baseline_ms = ms;
+                    } catch (const std::exception &e) {
+                        std::cout << "Error with PolyModulus: " << degree << ", VectorSize: " << vector_size
+                                  << ", Task: " << task_name(task) << ", Nodes: " << nodes << " - " << e.what()
+                                  << std::endl;
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace bench
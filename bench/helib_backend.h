@@ -0,0 +1,714 @@
+#pragma once
+
+#include "backend.h"
+#include "memory.h"
+#include "perf.h"
+#include "platform.h"
+#include "store.h"
+#include "timer.h"
+
+#include <helib/helib.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// The HElib these benchmarks are compiled against, for tag_results();
+// USE_INTEL_HEXL is HElib's HEXL build option.
+inline BuildInfo helib_build_info() {
+    BuildInfo build{"HElib", helib::version::asString, false};
+#ifdef USE_INTEL_HEXL
+    build.hexl = true;
+#endif
+    return build;
+}
+
+// Slot values plus the form prepared by encode() for plain ops (at most
+// one is set):
+//   array    PtxtArray, encoded again by every addConstant/multByConstant
+//   encoded  EncodedPtxt, converted to DoubleCRT by every op
+//   dcrt     DoubleCRT over the ciphertext primes, used as is
+struct HelibPlain : Plain {
+    std::vector<long> values;
+    std::unique_ptr<helib::PtxtArray> array;
+    std::unique_ptr<helib::EncodedPtxt> encoded;
+    std::unique_ptr<helib::DoubleCRT> dcrt;
+
+    void clear_forms() {
+        array.reset();
+        encoded.reset();
+        dcrt.reset();
+    }
+};
+
+struct HelibCipher : Cipher {
+    helib::Ctxt ct;
+    explicit HelibCipher(const helib::PubKey &pk) : ct(pk) {}
+};
+
+inline const std::vector<long> &helib_pt(const Plain &p) { return static_cast<const HelibPlain &>(p).values; }
+inline std::vector<long> &helib_pt(Plain &p) { return static_cast<HelibPlain &>(p).values; }
+inline const HelibPlain &helib_plain(const Plain &p) { return static_cast<const HelibPlain &>(p); }
+inline HelibPlain &helib_plain(Plain &p) { return static_cast<HelibPlain &>(p); }
+inline const helib::Ctxt &helib_ct(const Cipher &c) { return static_cast<const HelibCipher &>(c).ct; }
+inline helib::Ctxt &helib_ct(Cipher &c) { return static_cast<HelibCipher &>(c).ct; }
+
+// Context and secret/public key material (including key-switching matrices)
+// for one ParamSet. An evaluation-only key set, loaded from an evaluation
+// key bundle, has public_only instead of secret_key.
+struct HelibKeySet {
+    std::unique_ptr<helib::Context> context;
+    std::unique_ptr<helib::SecKey> secret_key;
+    std::unique_ptr<helib::PubKey> public_only;
+
+    // Serializing the key-switching matrices is slow, so sizes are taken
+    // once per key set.
+    bool sized = false;
+    KeySizes sizes;
+
+    KeyGenTimes keygen_times;
+};
+
+// HElib, BGV scheme. ParamSet::poly_modulus_degree is the cyclotomic index m.
+class HelibBgvBackend final : public Backend {
+    std::map<std::string, std::shared_ptr<HelibKeySet>> cache;
+    std::shared_ptr<HelibKeySet> keys;
+    const helib::EncryptedArray *ea = nullptr;
+
+    const helib::PubKey &public_key() const {
+        if (keys->secret_key) return *keys->secret_key;
+        return *keys->public_only;
+    }
+
+    // Plain operands prepared by encode() in none of the forms (e.g. the
+    // output of decrypt) are encoded on the fly, like "ptxt_array".
+    template <typename Fn>
+    void with_constant(const Plain &plain, Fn &&fn) const {
+        const HelibPlain &p = helib_plain(plain);
+        if (p.dcrt) {
+            fn(*p.dcrt);
+        } else if (p.encoded) {
+            fn(*p.encoded);
+        } else if (p.array) {
+            fn(*p.array);
+        } else {
+            fn(helib::PtxtArray(*keys->context, p.values));
+        }
+    }
+
+    std::string cache_path(const ParamSet &params) const {
+        return key_cache_dir + "/helib_bgv_" + params.cache_key() + ".store";
+    }
+
+    static std::shared_ptr<HelibKeySet> generate(const ParamSet &params) {
+        auto ks = std::make_shared<HelibKeySet>();
+        long p = params.plain_modulus ? static_cast<long>(params.plain_modulus) : 65537;
+        ks->context.reset(helib::ContextBuilder<helib::BGV>()
+                              .m(static_cast<long>(params.poly_modulus_degree))
+                              .p(p)
+                              .r(params.helib_r)
+                              .bits(params.helib_bits)
+                              .c(params.helib_c)
+                              .buildPtr());
+        if (params.security_bits && ks->context->securityLevel() < params.security_bits) {
+            throw std::invalid_argument("context below " + std::to_string(params.security_bits) + "-bit security");
+        }
+
+        // Relinearization matrices come with GenSecKey, so their cost is part
+        // of public_key_ms; rotations need key-switching matrices, either
+        // HElib's default set for the hypercube generators or exactly those
+        // the declared steps use.
+        Timer timer;
+        timer.tic();
+        ks->secret_key = std::make_unique<helib::SecKey>(*ks->context);
+        ks->secret_key->GenSecKey();
+        ks->keygen_times.public_key_ms = timer.toc();
+        if (params.galois_keys) {
+            timer.tic();
+            if (params.galois_steps.empty()) {
+                helib::addSome1DMatrices(*ks->secret_key);
+            } else {
+                add_step_matrices(*ks, params.galois_steps);
+            }
+            ks->keygen_times.galois_keys_ms = timer.toc();
+        }
+        return ks;
+    }
+
+    // EncryptedArray::rotate by an amount k splits it into the coordinates
+    // of slot k, one digit per dimension: the last dimension rotates by its
+    // digit v, every earlier one by v and, for the slots that carry out of
+    // the dimension after it, by v + 1. Each of those 1D rotations needs the
+    // matrix for g^v, plus g^(v - order) in non-native dimensions. HElib
+    // rotates right for positive amounts, so a left step s is the amount -s.
+    static void add_step_matrices(HelibKeySet &ks, const std::vector<int> &steps) {
+        const helib::PAlgebra &zmstar = ks.context->getZMStar();
+        helib::SecKey &sk = *ks.secret_key;
+        long slots = zmstar.getNSlots();
+        long dims = zmstar.numOfGens();
+        auto add_1d = [&](long dim, long amount) {
+            long order = zmstar.OrderOf(dim);
+            amount %= order;
+            if (amount == 0) return;
+            long val = zmstar.genToPow(dim, amount);
+            if (!sk.haveKeySWmatrix(1, val, 0, 0)) sk.GenKeySWmatrix(1, val, 0, 0);
+            if (!zmstar.SameOrd(dim)) {
+                long wrap = zmstar.genToPow(dim, amount - order);
+                if (!sk.haveKeySWmatrix(1, wrap, 0, 0)) sk.GenKeySWmatrix(1, wrap, 0, 0);
+            }
+        };
+        for (int step : steps) {
+            long amount = ((-step % slots) + slots) % slots;
+            if (amount == 0) continue;
+            for (long dim = 0; dim < dims; dim++) {
+                long digit = zmstar.coordinate(dim, amount);
+                add_1d(dim, digit);
+                if (dim + 1 < dims) add_1d(dim, digit + 1);
+            }
+        }
+        sk.setKeySwitchMap();
+    }
+
+    // Key stores (see store.h) hold the context and the secret key with all
+    // key-switching matrices; HElib reads them through streams over the
+    // mapped file.
+    static void save(const HelibKeySet &ks, const std::string &path) {
+        StoreWriter store;
+        store.add("context", [&](std::ostream &out) { ks.context->writeTo(out); });
+        store.add("secret_key", [&](std::ostream &out) { ks.secret_key->writeTo(out); });
+        store.write(path);
+    }
+
+    static std::shared_ptr<HelibKeySet> load(const std::string &path) {
+        if (!std::filesystem::exists(path)) {
+            return nullptr;
+        }
+        MappedStore store(path);
+        auto ks = std::make_shared<HelibKeySet>();
+        auto context_in = store.stream("context");
+        ks->context.reset(helib::Context::readPtrFrom(context_in));
+        auto key_in = store.stream("secret_key");
+        ks->secret_key = std::make_unique<helib::SecKey>(helib::SecKey::readFrom(key_in, *ks->context));
+        return ks;
+    }
+
+public:
+    HelibBgvBackend() { plain_encoding_name = "ptxt_array"; }
+
+    std::string library() const override { return "HElib"; }
+    std::string scheme() const override { return "BGV"; }
+
+    bool setup(const ParamSet &params) override {
+        keys.reset();
+        ea = nullptr;
+        Timer timer;
+        timer.tic();
+
+        std::string key = params.cache_key();
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            keys = it->second;
+            ea = &keys->context->getEA();
+            setup_source = "memory";
+            setup_ms = timer.toc();
+            return true;
+        }
+
+        try {
+            if (!key_cache_dir.empty()) {
+                try {
+                    keys = load(cache_path(params));
+                    setup_source = "disk";
+                } catch (const std::exception &e) {
+                    std::cout << "  Ignoring unreadable key file " << cache_path(params)
+                              << ": " << e.what() << std::endl;
+                    keys.reset();
+                }
+            }
+            if (!keys) {
+                keys = generate(params);
+                setup_source = "generated";
+                if (!key_cache_dir.empty()) {
+                    try {
+                        std::filesystem::create_directories(key_cache_dir);
+                        save(*keys, cache_path(params));
+                    } catch (const std::exception &e) {
+                        std::cout << "  Could not persist keys to " << cache_path(params)
+                                  << ": " << e.what() << std::endl;
+                    }
+                }
+            }
+        } catch (const std::exception &) {
+            keys.reset();
+            return false;
+        }
+
+        cache[key] = keys;
+        ea = &keys->context->getEA();
+        setup_ms = timer.toc();
+        return true;
+    }
+
+    void clear_cache() override {
+        keys.reset();
+        ea = nullptr;
+        cache.clear();
+    }
+
+    // Key material and the EncryptedArray are only read during evaluation,
+    // so workers share them; each worker allocates its own Ctxts.
+    std::unique_ptr<Backend> make_worker() const override {
+        auto worker = std::make_unique<HelibBgvBackend>();
+        worker->keys = keys;
+        worker->ea = ea;
+        worker->plain_encoding_name = plain_encoding_name;
+        return worker;
+    }
+
+    // HElib contexts cannot be copied, so the replica reads back a
+    // serialized copy of the context and keys.
+    std::unique_ptr<Backend> make_replica() const override {
+        std::stringstream context_data, key_data;
+        keys->context->writeTo(context_data);
+        if (keys->secret_key) keys->secret_key->writeTo(key_data);
+        else keys->public_only->writeTo(key_data);
+        auto ks = std::make_shared<HelibKeySet>();
+        ks->sized = keys->sized;
+        ks->sizes = keys->sizes;
+        ks->keygen_times = keys->keygen_times;
+        ks->context.reset(helib::Context::readPtrFrom(context_data));
+        if (keys->secret_key) {
+            ks->secret_key = std::make_unique<helib::SecKey>(helib::SecKey::readFrom(key_data, *ks->context));
+        } else {
+            ks->public_only = std::make_unique<helib::PubKey>(helib::PubKey::readFrom(key_data, *ks->context));
+        }
+        auto replica = std::make_unique<HelibBgvBackend>();
+        replica->keys = ks;
+        replica->ea = &ks->context->getEA();
+        replica->plain_encoding_name = plain_encoding_name;
+        return replica;
+    }
+
+    // The public key carries the key-switching matrices (relinearization
+    // and automorphisms), so the bundle is the context plus the public key.
+    void save_eval_keys(std::ostream &out) const override {
+        keys->context->writeTo(out);
+        public_key().writeTo(out);
+    }
+
+    bool setup_eval_keys(std::istream &in) override {
+        keys.reset();
+        ea = nullptr;
+        Timer timer;
+        timer.tic();
+        try {
+            auto ks = std::make_shared<HelibKeySet>();
+            ks->context.reset(helib::Context::readPtrFrom(in));
+            ks->public_only = std::make_unique<helib::PubKey>(helib::PubKey::readFrom(in, *ks->context));
+            keys = ks;
+        } catch (const std::exception &) {
+            keys.reset();
+            return false;
+        }
+        ea = &keys->context->getEA();
+        setup_source = "eval_keys";
+        setup_ms = timer.toc();
+        return true;
+    }
+
+    size_t slot_count() const override { return static_cast<size_t>(ea->size()); }
+    uint64_t plain_modulus() const override { return static_cast<uint64_t>(keys->context->getP()); }
+    int modulus_bits() const override { return static_cast<int>(keys->context->bitSizeOfQ()); }
+    double security_level() const override { return keys->context->securityLevel(); }
+
+    std::unique_ptr<Plain> make_plain() const override { return std::make_unique<HelibPlain>(); }
+    std::unique_ptr<Cipher> make_cipher() const override { return std::make_unique<HelibCipher>(public_key()); }
+
+    std::vector<std::string> plain_encodings() const override { return {"ptxt_array", "encoded", "dcrt"}; }
+
+    void encode(const std::vector<uint64_t> &values, Plain &out) override {
+        HelibPlain &p = helib_plain(out);
+        p.values.assign(values.begin(), values.end());
+        p.clear_forms();
+        if (plain_encoding_name == "ptxt_array") {
+            p.array = std::make_unique<helib::PtxtArray>(*keys->context, p.values);
+            return;
+        }
+        helib::PtxtArray array(*keys->context, p.values);
+        p.encoded = std::make_unique<helib::EncodedPtxt>();
+        array.encode(*p.encoded);
+        if (plain_encoding_name == "dcrt") {
+            p.dcrt = std::make_unique<helib::DoubleCRT>(*p.encoded, *keys->context, keys->context->fullPrimes());
+            p.encoded.reset();
+        }
+    }
+
+    void decode(const Plain &plain, std::vector<uint64_t> &out) override {
+        const auto &values = helib_pt(plain);
+        out.assign(values.begin(), values.end());
+    }
+
+    void encrypt(const Plain &plain, Cipher &out) override {
+        ea->encrypt(helib_ct(out), public_key(), helib_pt(plain));
+    }
+
+    void decrypt(const Cipher &cipher, Plain &out) override {
+        if (!keys->secret_key) throw std::logic_error("evaluation-only key set cannot decrypt");
+        helib_plain(out).clear_forms();
+        ea->decrypt(helib_ct(cipher), *keys->secret_key, helib_pt(out));
+    }
+
+    double noise_budget(const Cipher &cipher) override { return helib_ct(cipher).capacity(); }
+
+    // capacity() is HElib's own noise bound, carried in every Ctxt, so the
+    // estimate needs no decryption and equals noise_budget().
+    double estimated_noise_budget(const Cipher &cipher) const override { return helib_ct(cipher).capacity(); }
+
+    // logOfPrimeSet() is a natural logarithm.
+    double cipher_modulus_bits(const Cipher &cipher) const override {
+        return helib_ct(cipher).logOfPrimeSet() / std::log(2.0);
+    }
+
+    void add(const Cipher &a, const Cipher &b, Cipher &out) override {
+        helib_ct(out) = helib_ct(a);
+        helib_ct(out) += helib_ct(b);
+    }
+
+    void add_plain(const Cipher &a, const Plain &b, Cipher &out) override {
+        helib_ct(out) = helib_ct(a);
+        with_constant(b, [&](const auto &constant) { helib_ct(out).addConstant(constant); });
+    }
+
+    void multiply_plain(const Cipher &a, const Plain &b, Cipher &out) override {
+        helib_ct(out) = helib_ct(a);
+        with_constant(b, [&](const auto &constant) { helib_ct(out).multByConstant(constant); });
+    }
+
+    // multiplyBy() is multLowLvl() followed by reLinearize(); calling the
+    // two directly lets the profiler tell the tensor from the key switch.
+    void multiply(const Cipher &a, const Cipher &b, Cipher &out) override {
+        helib_ct(out) = helib_ct(a);
+        multiply_inplace(out, b);
+    }
+
+    void add_inplace(Cipher &a, const Cipher &b) override { helib_ct(a) += helib_ct(b); }
+
+    void add_plain_inplace(Cipher &a, const Plain &b) override {
+        with_constant(b, [&](const auto &constant) { helib_ct(a).addConstant(constant); });
+    }
+
+    void multiply_plain_inplace(Cipher &a, const Plain &b) override {
+        with_constant(b, [&](const auto &constant) { helib_ct(a).multByConstant(constant); });
+    }
+
+    void multiply_inplace(Cipher &a, const Cipher &b) override {
+        {
+            ProfileScope scope("tensor");
+            helib_ct(a).multLowLvl(helib_ct(b));
+        }
+        relinearize(a);
+    }
+
+    // Ctxt has a copy assignment but no move assignment, so a move is a copy.
+    void copy_cipher(const Cipher &from, Cipher &to) override { helib_ct(to) = helib_ct(from); }
+    void move_cipher(Cipher &from, Cipher &to) override { helib_ct(to) = std::move(helib_ct(from)); }
+
+    void multiply_no_relin(const Cipher &a, const Cipher &b, Cipher &out) override {
+        helib_ct(out) = helib_ct(a);
+        ProfileScope scope("tensor");
+        helib_ct(out).multLowLvl(helib_ct(b));
+    }
+
+    void relinearize(Cipher &c) override {
+        ProfileScope scope("key_switch");
+        helib_ct(c).reLinearize();
+    }
+
+    // BGV modulus switching: drop the largest prime of the ciphertext.
+    bool mod_switch(Cipher &c) override {
+        helib::IndexSet primes = helib_ct(c).getPrimeSet();
+        if (primes.card() <= 1) return false;
+        primes.remove(primes.last());
+        ProfileScope scope("mod_switch");
+        helib_ct(c).modDownToSet(primes);
+        return true;
+    }
+
+    // HElib rotates right for positive amounts; the interface rotates left.
+    void rotate(const Cipher &a, int steps, Cipher &out) override {
+        helib_ct(out) = helib_ct(a);
+        ProfileScope scope("key_switch");
+        ea->rotate(helib_ct(out), -steps);
+    }
+
+    void rotate_columns(const Cipher &a, Cipher &out) override {
+        helib_ct(out) = helib_ct(a);
+        ProfileScope scope("key_switch");
+        ea->rotate1D(helib_ct(out), 0, 1);
+    }
+
+    // rotate1D by one moves the slot at dimension-0 coordinate e to e + 1.
+    std::vector<uint64_t> rotate_columns_slots(const std::vector<uint64_t> &slots) const override {
+        const helib::PAlgebra &zmstar = ea->getPAlgebra();
+        std::vector<uint64_t> out(slots.size());
+        for (size_t i = 0; i < slots.size(); i++) {
+            out[static_cast<size_t>(zmstar.addCoord(0, static_cast<long>(i), 1))] = slots[i];
+        }
+        return out;
+    }
+
+    // Hoisting precomputes the digit decomposition of the input once and
+    // applies each automorphism to it. HElib only offers that along one
+    // native dimension, which is the whole rotation when the slots form a
+    // single one; otherwise every step is an ordinary rotate().
+    bool rotate_many(const Cipher &a, const std::vector<int> &steps,
+                     std::vector<std::unique_ptr<Cipher>> &out, bool hoist) override {
+        if (!hoist || ea->dimension() != 1 || !ea->nativeDimension(0)) {
+            return Backend::rotate_many(a, steps, out, false);
+        }
+        long n = ea->sizeOfDimension(0);
+        auto precon = helib::buildGeneralAutomorphPrecon(helib_ct(a), 0, *ea);
+        for (size_t i = 0; i < steps.size(); i++) {
+            helib_ct(*out[i]) = *precon->automorph(((-steps[i] % n) + n) % n);
+        }
+        return true;
+    }
+
+    size_t cipher_bytes(const Cipher &cipher) const override {
+        const auto &ct = helib_ct(cipher);
+        return static_cast<size_t>(ct.size() * ct.getPrimeSet().card() * keys->context->getPhiM()) * sizeof(long);
+    }
+
+    // HElib has a single binary format without compression or seeds.
+    std::vector<std::string> wire_formats() const override { return {"binary"}; }
+
+    size_t save_cipher(const Cipher &cipher, const std::string &format, std::ostream &out) const override {
+        if (format != "binary") throw std::invalid_argument("unknown HElib wire format " + format);
+        auto start = out.tellp();
+        helib_ct(cipher).writeTo(out);
+        return static_cast<size_t>(out.tellp() - start);
+    }
+
+    void load_cipher(std::istream &in, Cipher &out) override { helib_ct(out).read(in); }
+
+    // Relinearization matrices switch from s^2; every other key-switching
+    // matrix serves an automorphism (rotation / Frobenius).
+    KeySizes key_sizes() const override {
+        if (!keys->sized) {
+            const helib::PubKey &pk = public_key();
+            size_t total = serialized_size([&](std::ostream &out) { pk.writeTo(out); });
+            KeySizes sizes;
+            for (const auto &matrix : pk.keySWlist()) {
+                size_t bytes = serialized_size([&](std::ostream &out) { matrix.writeTo(out); });
+                if (matrix.fromKey.getPowerOfS() == 2 && matrix.fromKey.getPowerOfX() == 1) {
+                    sizes.relin_keys += bytes;
+                } else {
+                    sizes.galois_keys += bytes;
+                    sizes.galois_key_count++;
+                }
+            }
+            sizes.public_key = total - sizes.relin_keys - sizes.galois_keys;
+            keys->sizes = sizes;
+            keys->sized = true;
+        }
+        return keys->sizes;
+    }
+
+    KeyGenTimes keygen_times() const override { return keys->keygen_times; }
+
+    const helib::Context &helib_context() const { return *keys->context; }
+    const helib::EncryptedArray &helib_ea() const { return *ea; }
+    const helib::SecKey &helib_secret_key() const { return *keys->secret_key; }
+};
+
+// Real-valued slots; decrypt() leaves its result here too.
+struct HelibCkksPlain : Plain {
+    std::unique_ptr<helib::PtxtArray> array;
+};
+
+inline const helib::PtxtArray &helib_array(const Plain &p) { return *static_cast<const HelibCkksPlain &>(p).array; }
+
+// HElib, CKKS scheme. ParamSet::poly_modulus_degree is the cyclotomic index
+// m (a power of two), ckks_scale_bits the precision. HElib tracks levels and
+// scales itself and drops primes inside multiplications, so there is no
+// separate rescale.
+class HelibCkksBackend : public CkksBackend {
+    std::map<std::string, std::shared_ptr<HelibKeySet>> cache;
+    std::shared_ptr<HelibKeySet> keys;
+    int precision = 0;
+
+    const helib::PubKey &public_key() const { return *keys->secret_key; }
+
+    static std::shared_ptr<HelibKeySet> generate(const ParamSet &params) {
+        auto ks = std::make_shared<HelibKeySet>();
+        ks->context.reset(helib::ContextBuilder<helib::CKKS>()
+                              .m(static_cast<long>(params.poly_modulus_degree))
+                              .precision(params.ckks_scale_bits)
+                              .bits(params.helib_bits)
+                              .c(params.helib_c)
+                              .buildPtr());
+        if (params.security_bits && ks->context->securityLevel() < params.security_bits) {
+            throw std::invalid_argument("context below " + std::to_string(params.security_bits) + "-bit security");
+        }
+        ks->secret_key = std::make_unique<helib::SecKey>(*ks->context);
+        ks->secret_key->GenSecKey();
+        return ks;
+    }
+
+public:
+    std::string library() const override { return "HElib"; }
+
+    bool setup(const ParamSet &params) override {
+        keys.reset();
+        Timer timer;
+        timer.tic();
+        std::string key = params.cache_key() + "_ckks" + std::to_string(params.ckks_scale_bits);
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            keys = it->second;
+        } else {
+            try {
+                keys = generate(params);
+            } catch (const std::exception &) {
+                keys.reset();
+                return false;
+            }
+            cache[key] = keys;
+        }
+        precision = params.ckks_scale_bits;
+        setup_ms = timer.toc();
+        return true;
+    }
+
+    void clear_cache() override {
+        keys.reset();
+        cache.clear();
+    }
+
+    size_t slot_count() const override { return static_cast<size_t>(keys->context->getNSlots()); }
+    int modulus_bits() const override { return static_cast<int>(keys->context->bitSizeOfQ()); }
+    double security_level() const override { return keys->context->securityLevel(); }
+    int scale_bits() const override { return precision; }
+
+    std::unique_ptr<Plain> make_plain() const override { return std::make_unique<HelibCkksPlain>(); }
+    std::unique_ptr<Cipher> make_cipher() const override { return std::make_unique<HelibCipher>(public_key()); }
+
+    void encode(const std::vector<double> &values, Plain &out) override {
+        static_cast<HelibCkksPlain &>(out).array = std::make_unique<helib::PtxtArray>(*keys->context, values);
+    }
+
+    void decode(const Plain &plain, std::vector<double> &out) override { helib_array(plain).store(out); }
+
+    void encrypt(const Plain &plain, Cipher &out) override { helib_array(plain).encrypt(helib_ct(out)); }
+
+    void decrypt(const Cipher &cipher, Plain &out) override {
+        auto &array = static_cast<HelibCkksPlain &>(out).array;
+        if (!array) array = std::make_unique<helib::PtxtArray>(*keys->context);
+        array->decrypt(helib_ct(cipher), *keys->secret_key);
+    }
+
+    double capacity_bits(const Cipher &cipher) const override { return helib_ct(cipher).capacity(); }
+
+    void add(const Cipher &a, const Cipher &b, Cipher &out) override {
+        helib_ct(out) = helib_ct(a);
+        helib_ct(out) += helib_ct(b);
+    }
+
+    void add_plain(const Cipher &a, const Plain &b, Cipher &out) override {
+        helib_ct(out) = helib_ct(a);
+        helib_ct(out).addConstant(helib_array(b));
+    }
+
+    void multiply_plain(const Cipher &a, const Plain &b, Cipher &out) override {
+        helib_ct(out) = helib_ct(a);
+        helib_ct(out).multByConstant(helib_array(b));
+    }
+
+    void multiply(const Cipher &a, const Cipher &b, Cipher &out) override {
+        helib_ct(out) = helib_ct(a);
+        helib_ct(out).multiplyBy(helib_ct(b));
+    }
+
+    bool rescale(Cipher &c) override {
+        (void)c;
+        return false;
+    }
+
+    void copy_cipher(const Cipher &from, Cipher &to) override { helib_ct(to) = helib_ct(from); }
+
+    size_t cipher_bytes(const Cipher &cipher) const override {
+        const auto &ct = helib_ct(cipher);
+        return static_cast<size_t>(ct.size() * ct.getPrimeSet().card() * keys->context->getPhiM()) * sizeof(long);
+    }
+};
+
+// The m values and ContextBuilder settings of the original HElib drivers.
+inline std::vector<ParamSet> helib_default_params(size_t m, bool galois_keys = true) {
+    ParamSet p;
+    p.poly_modulus_degree = m;
+    p.plain_modulus = 65537;
+    p.helib_bits = 300;
+    p.helib_c = 2;
+    p.helib_r = 1;
+    p.galois_keys = galois_keys;
+    return {p};
+}
+
+// Smallest prime p = 1 (mod m) of at least `bits` bits. Such a p splits
+// completely, so every one of the phi(m) slots holds one integer mod p.
+inline long helib_batching_prime(long m, int bits) {
+    auto is_prime = [](long n) {
+        for (long d = 2; d * d <= n; d++) {
+            if (n % d == 0) return false;
+        }
+        return n > 1;
+    };
+    long p = ((1L << (bits - 1)) / m) * m + 1;
+    while (p < (1L << (bits - 1)) || !is_prime(p)) {
+        p += m;
+    }
+    return p;
+}
+
+// Search space of the parameter optimizer (param_search.h): every modulus
+// size in `bits` with c = 2 and 3 key-switching columns.
+inline std::vector<ParamSet> helib_search_params(size_t m, int plain_bits, int security_bits,
+                                                 const std::vector<long> &bits = {150, 200, 300, 400, 500, 600, 800}) {
+    std::vector<ParamSet> candidates;
+    for (long c : {2L, 3L}) {
+        for (long b : bits) {
+            ParamSet p;
+            p.poly_modulus_degree = m;
+            p.plain_modulus = static_cast<uint64_t>(helib_batching_prime(static_cast<long>(m), plain_bits));
+            p.helib_bits = b;
+            p.helib_c = c;
+            p.security_bits = security_bits;
+            candidates.push_back(p);
+        }
+    }
+    return candidates;
+}
+
+// CKKS at cyclotomic index m (a power of two): HElib's default 20 bits of
+// precision and a modulus of 13 bits per 1024 of m, about what the HE
+// standard allows at 128-bit security for ring dimension m / 2.
+inline std::vector<ParamSet> helib_ckks_params(size_t m) {
+    ParamSet p;
+    p.poly_modulus_degree = m;
+    p.ckks_scale_bits = 20;
+    p.helib_bits = static_cast<long>(13 * m / 1024);
+    p.helib_c = 2;
+    return {p};
+}
+
+} // namespace bench
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "backend.h"
+#include "kernels.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+inline ColumnSet kernel_sweep_columns() {
+    return keyed_columns(
+        result_columns(concat_columns({
+            {"kernel", "size", "shape", "rotations", "multiplications", "prepare_ms"},
+            stats_columns("kernel"),
+            {"valid"}})),
+        {"kernel", "size", "shape"});
+}
+
+// Every rotation the kernel sweep uses, so candidates can carry exactly
+// those Galois keys.
+inline std::vector<int> kernel_rotations(const SweepConfig &config) {
+    std::vector<int> steps;
+    auto add = [&](const std::vector<int> &more) {
+        for (int step : more) {
+            if (std::find(steps.begin(), steps.end(), step) == steps.end()) steps.push_back(step);
+        }
+    };
+    for (auto n : config.kernel_sizes) {
+        add(dot_product_rotations(n));
+        add(BsgsPlan(n).rotations());
+    }
+    add(convolution_rotations(config.conv_taps));
+    return steps;
+}
+
+// End-to-end latency of the kernels in kernels.h at every degree and kernel
+// size, inputs encrypted and plaintext operands encoded beforehand (the
+// encoding of the matrix diagonals or taps is reported as prepare_ms):
+//   DOT_PRODUCT  x . y of two encrypted n-vectors
+//   MATVEC_BSGS  n x n plaintext matrix times an encrypted n-vector
+//   CONV1D       conv_taps-tap plaintext filter over an encrypted n-signal
+// Candidates get Galois keys for kernel_rotations() unless the workload
+// declared its rotations. Shapes that do not fit the slot layout are
+// skipped.
+inline void run_kernel_sweep(Backend &backend, const SweepConfig &config, CsvLog &log) {
+    const TimingConfig &timing = config.timing;
+    std::vector<int> rotations = kernel_rotations(config);
+
+    // One dataset per size, large enough for the n x n matrix and the taps:
+    // left operands (x, v, the signal) are its first elements, right ones
+    // (y, the matrix rows, the taps) likewise.
+    auto dataset_size = [&](size_t n) { return std::max(n * n, config.conv_taps); };
+    DatasetStore datasets = sweep_datasets(config);
+    std::vector<size_t> sizes;
+    for (auto n : config.kernel_sizes) {
+        if (n >= 2) sizes.push_back(dataset_size(n));
+    }
+    datasets.prepare(sizes);
+
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " kernels PolyModulus=" << degree << " ===" << std::endl;
+        std::vector<ParamSet> candidates = sweep_candidates(config, degree);
+        for (auto &params : candidates) {
+            params.galois_keys = true;
+            if (config.required_rotations.empty()) params.galois_steps = rotations;
+        }
+        if (!setup_first_working(backend, candidates)) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        size_t slot_count = backend.slot_count();
+        size_t row_size = backend.row_size();
+        uint64_t t = backend.plain_modulus();
+
+        auto log_kernel = [&](const char *kernel, size_t n, const std::string &shape, size_t rotation_count,
+                              size_t multiplications, double prepare_ms, const Stats &stats, bool valid) {
+            log.row(backend.library(), backend.scheme(), degree, slot_count, kernel, n, shape, rotation_count,
+                    multiplications, prepare_ms, stats, valid ? 1 : 0);
+            std::cout << "  " << kernel << " " << shape << ": " << stats.median_ms << " ms (p99 "
+                      << stats.p99_ms << "), " << rotation_count << " rotations, " << multiplications
+                      << " multiplications" << (valid ? "" : ", INVALID") << std::endl;
+        };
+
+        for (auto n : config.kernel_sizes) {
+            if (n < 2) continue;
+            const Dataset &dataset = datasets.get(dataset_size(n));
+            auto plain = backend.make_plain();
+            auto x = backend.make_cipher();
+            auto out = backend.make_cipher();
+            auto tmp = backend.make_cipher();
+            auto term = backend.make_cipher();
+            std::vector<uint64_t> decoded;
+            auto encrypt = [&](const std::vector<uint64_t> &values, Cipher &c) {
+                backend.encode(values, *plain);
+                backend.encrypt(*plain, c);
+            };
+            auto decrypt = [&](const Cipher &c) {
+                backend.decrypt(c, *plain);
+                backend.decode(*plain, decoded);
+            };
+
+            try {
+                size_t span = 2;
+                while (span < n) span *= 2;
+                if (span <= row_size) {
+                    std::vector<uint64_t> a, b;
+                    dataset.chunk_a(0, n, a);
+                    dataset.chunk_b(0, n, b);
+                    a.resize(slot_count, 0);
+                    b.resize(slot_count, 0);
+                    auto y = backend.make_cipher();
+                    encrypt(a, *x);
+                    encrypt(b, *y);
+                    Stats stats = measure(timing, [&] { dot_product(backend, *x, *y, n, *out, *tmp); });
+                    uint64_t expected = 0;
+                    for (size_t i = 0; i < n; i++) {
+                        expected = (expected + expected_value(OpType::CipherMulCipher, a[i], b[i], t)) % t;
+                    }
+                    decrypt(*out);
+                    log_kernel("DOT_PRODUCT", n, "n=" + std::to_string(n), dot_product_rotations(n).size(), 1, 0,
+                               stats, decoded[0] == expected);
+                } else {
+                    std::cout << "  DOT_PRODUCT n=" << n << " - SKIPPING (exceeds row of " << row_size << ")"
+                              << std::endl;
+                }
+
+                if (row_size % n == 0) {
+                    BsgsPlan plan(n);
+                    std::vector<std::vector<uint64_t>> m(n);
+                    for (size_t r = 0; r < n; r++) dataset.chunk_b(r, n, m[r]);
+                    std::vector<uint64_t> v;
+                    dataset.chunk_a(0, n, v);
+                    Timer timer;
+                    timer.tic();
+                    auto diagonals = encode_bsgs_diagonals(backend, m, plan);
+                    double prepare_ms = timer.toc();
+                    encrypt(tile(v, slot_count), *x);
+                    BsgsScratch scratch(backend, plan);
+                    Stats stats = measure(timing, [&] { matvec_bsgs(backend, diagonals, plan, *x, *out, scratch); });
+                    decrypt(*out);
+                    bool valid = true;
+                    for (size_t r = 0; r < n && valid; r++) {
+                        uint64_t expected = 0;
+                        for (size_t c = 0; c < n; c++) {
+                            expected = (expected + expected_value(OpType::CipherMulPlain, m[r][c], v[c], t)) % t;
+                        }
+                        valid = decoded[r] == expected;
+                    }
+                    std::string shape = std::to_string(n) + "x" + std::to_string(n) + " bsgs " +
+                                        std::to_string(plan.baby) + "x" + std::to_string(plan.giant);
+                    log_kernel("MATVEC_BSGS", n, shape, plan.rotation_count(), n, prepare_ms, stats, valid);
+                } else {
+                    std::cout << "  MATVEC_BSGS n=" << n << " - SKIPPING (" << n << " does not divide row of "
+                              << row_size << ")" << std::endl;
+                }
+
+                size_t taps = config.conv_taps;
+                if (n + taps - 1 <= row_size) {
+                    std::vector<uint64_t> signal, h;
+                    dataset.chunk_a(0, n, signal);
+                    signal.resize(slot_count, 0);
+                    dataset.chunk_b(0, taps, h);
+                    Timer timer;
+                    timer.tic();
+                    auto encoded_taps = encode_taps(backend, h);
+                    double prepare_ms = timer.toc();
+                    encrypt(signal, *x);
+                    Stats stats = measure(timing, [&] { convolve(backend, *x, encoded_taps, *out, *tmp, *term); });
+                    decrypt(*out);
+                    bool valid = true;
+                    for (size_t s = 0; s < n && valid; s++) {
+                        uint64_t expected = 0;
+                        for (size_t k = 0; k < taps && s + k < n; k++) {
+                            expected = (expected + expected_value(OpType::CipherMulPlain, signal[s + k], h[k], t)) % t;
+                        }
+                        valid = decoded[s] == expected;
+                    }
+                    std::string shape = "n=" + std::to_string(n) + " taps=" + std::to_string(taps);
+                    log_kernel("CONV1D", n, shape, taps - 1, taps, prepare_ms, stats, valid);
+                } else {
+                    std::cout << "  CONV1D n=" << n << " - SKIPPING (exceeds row of " << row_size << ")" << std::endl;
+                }
+            } catch (const std::exception &e) {
+                std::cout << "Error with PolyModulus: " << degree << ", kernel size " << n << " - " << e.what()
+                          << std::endl;
+            }
+        }
+    }
+}
+
+} // namespace bench
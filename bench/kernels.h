@@ -0,0 +1,156 @@
+#pragma once
+
+#include "backend.h"
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace bench {
+
+// Encrypted linear-algebra kernels written against Backend, so they run
+// unchanged on SEAL and HElib. Rotations are left rotations within
+// backend.row_size(); callers generate Galois keys for kernel_rotations()
+// of the shapes they use, or rely on the backend composing them.
+
+// v repeated across all slot_count slots; v.size() must divide row_size().
+inline std::vector<uint64_t> tile(const std::vector<uint64_t> &v, size_t slot_count) {
+    std::vector<uint64_t> out(slot_count);
+    for (size_t i = 0; i < slot_count; i++) out[i] = v[i % v.size()];
+    return out;
+}
+
+// x . y of two vectors in the first n (>= 2) slots, into slot 0 of out:
+// one multiplication and ceil(log2(n)) rotate-and-adds. The slots after the
+// vectors must be zero up to n rounded up to a power of two.
+inline void dot_product(Backend &backend, const Cipher &x, const Cipher &y, size_t n, Cipher &out, Cipher &tmp) {
+    backend.multiply(x, y, tmp);
+    backend.rotate(tmp, 1, out);
+    backend.add_inplace(out, tmp);
+    for (size_t step = 2; step < n; step *= 2) {
+        backend.rotate(out, static_cast<int>(step), tmp);
+        backend.add_inplace(out, tmp);
+    }
+}
+
+inline std::vector<int> dot_product_rotations(size_t n) {
+    std::vector<int> steps;
+    for (size_t step = 1; step < n; step *= 2) steps.push_back(static_cast<int>(step));
+    return steps;
+}
+
+// Baby-step / giant-step split of the diagonal method for a dim x dim
+// matrix: diagonal k = j * baby + i is applied as
+//   rot(rot(diag_k, -j * baby) * rot(x, i), j * baby)
+// so only baby - 1 rotations of x and giant - 1 rotations of partial sums
+// are needed instead of dim - 1.
+struct BsgsPlan {
+    size_t dim = 0;
+    size_t baby = 0;
+    size_t giant = 0;
+
+    explicit BsgsPlan(size_t dim)
+        : dim(dim), baby(static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(dim))))),
+          giant((dim + baby - 1) / baby) {}
+
+    std::vector<int> rotations() const {
+        std::vector<int> steps;
+        for (size_t i = 1; i < baby; i++) steps.push_back(static_cast<int>(i));
+        for (size_t j = 1; j < giant; j++) steps.push_back(static_cast<int>(j * baby));
+        return steps;
+    }
+
+    size_t rotation_count() const { return (baby - 1) + (giant - 1); }
+};
+
+// Generalized diagonals of the row-major dim x dim matrix m, rotated for
+// the plan and encoded tiled across all slots (so dim must divide
+// row_size()): entry k = j * baby + i holds
+//   rot(diag_k, -j * baby), diag_k[s] = m[s][(s + k) mod dim].
+inline std::vector<std::unique_ptr<Plain>> encode_bsgs_diagonals(Backend &backend,
+                                                                const std::vector<std::vector<uint64_t>> &m,
+                                                                const BsgsPlan &plan) {
+    size_t d = plan.dim;
+    std::vector<std::unique_ptr<Plain>> diagonals;
+    std::vector<uint64_t> diag(d);
+    for (size_t k = 0; k < d; k++) {
+        size_t shift = (k / plan.baby) * plan.baby;
+        for (size_t s = 0; s < d; s++) {
+            size_t row = (s + d - shift) % d;
+            diag[s] = m[row][(row + k) % d];
+        }
+        diagonals.push_back(backend.make_plain());
+        backend.encode(tile(diag, backend.slot_count()), *diagonals.back());
+    }
+    return diagonals;
+}
+
+// Scratch ciphertexts of matvec_bsgs, allocated once per plan: the baby-step
+// rotations x rotated by 1 .. baby - 1, and a partial sum.
+struct BsgsScratch {
+    std::vector<std::unique_ptr<Cipher>> baby;
+    std::unique_ptr<Cipher> inner, term;
+
+    BsgsScratch(const Backend &backend, const BsgsPlan &plan)
+        : inner(backend.make_cipher()), term(backend.make_cipher()) {
+        for (size_t i = 1; i < plan.baby; i++) baby.push_back(backend.make_cipher());
+    }
+};
+
+// out = m x for x tiled across all slots (see tile()); the result is tiled
+// the same way, so y sits in the first dim slots.
+inline void matvec_bsgs(Backend &backend, const std::vector<std::unique_ptr<Plain>> &diagonals, const BsgsPlan &plan,
+                        const Cipher &x, Cipher &out, BsgsScratch &scratch) {
+    for (size_t i = 1; i < plan.baby; i++) backend.rotate(x, static_cast<int>(i), *scratch.baby[i - 1]);
+    auto rotated_x = [&](size_t i) -> const Cipher & { return i == 0 ? x : *scratch.baby[i - 1]; };
+
+    for (size_t j = 0; j < plan.giant; j++) {
+        for (size_t i = 0; i < plan.baby && j * plan.baby + i < plan.dim; i++) {
+            const Plain &diagonal = *diagonals[j * plan.baby + i];
+            if (i == 0) {
+                backend.multiply_plain(rotated_x(i), diagonal, *scratch.inner);
+            } else {
+                backend.multiply_plain(rotated_x(i), diagonal, *scratch.term);
+                backend.add_inplace(*scratch.inner, *scratch.term);
+            }
+        }
+        if (j == 0) {
+            backend.copy_cipher(*scratch.inner, out);
+        } else {
+            backend.rotate(*scratch.inner, static_cast<int>(j * plan.baby), *scratch.term);
+            backend.add_inplace(out, *scratch.term);
+        }
+    }
+}
+
+// Filter taps h_k, each encoded as a constant across all slots.
+inline std::vector<std::unique_ptr<Plain>> encode_taps(Backend &backend, const std::vector<uint64_t> &taps) {
+    std::vector<std::unique_ptr<Plain>> encoded;
+    for (auto h : taps) {
+        encoded.push_back(backend.make_plain());
+        backend.encode(std::vector<uint64_t>(backend.slot_count(), h), *encoded.back());
+    }
+    return encoded;
+}
+
+// 1D convolution in correlation form, y[s] = sum_k h_k x[s + k], over a
+// signal followed by at least taps - 1 zero slots (zero padding at the end):
+// taps - 1 rotations and one plain multiplication per tap.
+inline void convolve(Backend &backend, const Cipher &x, const std::vector<std::unique_ptr<Plain>> &taps, Cipher &out,
+                     Cipher &rotated, Cipher &term) {
+    backend.multiply_plain(x, *taps[0], out);
+    for (size_t k = 1; k < taps.size(); k++) {
+        backend.rotate(x, static_cast<int>(k), rotated);
+        backend.multiply_plain(rotated, *taps[k], term);
+        backend.add_inplace(out, term);
+    }
+}
+
+inline std::vector<int> convolution_rotations(size_t taps) {
+    std::vector<int> steps;
+    for (size_t k = 1; k < taps; k++) steps.push_back(static_cast<int>(k));
+    return steps;
+}
+
+} // namespace bench
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "backend.h"
+#include "results.h"
+#include "workloads.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+inline ColumnSet key_profile_columns() {
+    return keyed_columns(
+        result_columns({"coeff_modulus_bits", "modulus_bits", "galois_steps",
+                        "public_keygen_ms", "relin_keygen_ms", "galois_keygen_ms", "total_setup_ms",
+                        "public_key_bytes", "relin_keys_bytes", "galois_keys_bytes", "galois_key_count",
+                        "disk_load_ms"}),
+        {"coeff_modulus_bits", "modulus_bits", "galois_steps"});
+}
+
+// Key material cost of every candidate parameter set: generation time and
+// serialized size of the public, relinearization and Galois keys, and with
+// a key cache directory also how long loading them back from disk takes.
+// Keys are always generated here, whatever the in-memory or disk cache
+// holds; candidates pick up the sweep's declared rotations.
+inline void run_key_profile(Backend &backend, const SweepConfig &config, CsvLog &log) {
+    std::string cache_dir = backend.get_key_cache_dir();
+
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " key material, PolyModulus=" << degree << " ===" << std::endl;
+        for (const auto &params : sweep_candidates(config, degree)) {
+            std::cout << "  " << params.describe() << " ... ";
+            backend.set_key_cache_dir("");
+            backend.clear_cache();
+            if (!backend.setup(params)) {
+                std::cout << "FAILED" << std::endl;
+                continue;
+            }
+            KeyGenTimes times = backend.keygen_times();
+            KeySizes sizes = backend.key_sizes();
+            double total_ms = backend.last_setup_ms();
+            size_t slot_count = backend.slot_count();
+            int modulus_bits = backend.modulus_bits();
+
+            // Persist once (or find an existing file), then time a cold load.
+            double load_ms = 0;
+            if (!cache_dir.empty()) {
+                backend.set_key_cache_dir(cache_dir);
+                backend.clear_cache();
+                backend.setup(params);
+                backend.clear_cache();
+                if (backend.setup(params) && backend.last_setup_source() == "disk") {
+                    load_ms = backend.last_setup_ms();
+                }
+            }
+
+            std::string steps = params.galois_keys ? (params.galois_steps.empty() ? "default" : join_steps(params.galois_steps))
+                                                   : "none";
+
+            log.row(backend.library(), backend.scheme(), degree, slot_count, coeff_modulus_string(params), modulus_bits, steps,
+                    times.public_key_ms, times.relin_keys_ms, times.galois_keys_ms, total_ms,
+                    sizes.public_key, sizes.relin_keys, sizes.galois_keys, sizes.galois_key_count, load_ms);
+
+            std::cout << "public " << times.public_key_ms << " ms / " << sizes.public_key / 1024 << " KB"
+                      << ", relin " << times.relin_keys_ms << " ms / " << sizes.relin_keys / 1024 << " KB"
+                      << ", galois " << times.galois_keys_ms << " ms / " << sizes.galois_keys / 1024 << " KB ("
+                      << sizes.galois_key_count << " keys)";
+            if (load_ms) std::cout << ", disk load " << load_ms << " ms";
+            std::cout << std::endl;
+        }
+    }
+    backend.set_key_cache_dir(cache_dir);
+}
+
+} // namespace bench
@@ -0,0 +1,521 @@
+#pragma once
+
+#include "backend.h"
+#include "kernels.h"
+#include "options.h"
+#include "parallel.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// Requests the evaluation service serves, each on one ciphertext of fresh
+// operands the worker holds:
+//   add       ciphertext + ciphertext
+//   multiply  ciphertext x ciphertext, relinearized
+//   rotate    rotation by one slot
+//   dot       dot product of two dot_size-vectors (multiply + rotate-and-sum)
+enum class RequestType { Add, Multiply, Rotate, Dot };
+constexpr size_t RequestTypeCount = 4;
+
+inline const char *request_type_name(RequestType type) {
+    switch (type) {
+    case RequestType::Add: return "add";
+    case RequestType::Multiply: return "multiply";
+    case RequestType::Rotate: return "rotate";
+    case RequestType::Dot: return "dot";
+    }
+    return "unknown";
+}
+
+inline RequestType parse_request_type(const std::string &name) {
+    for (size_t i = 0; i < RequestTypeCount; i++) {
+        auto type = static_cast<RequestType>(i);
+        if (name == request_type_name(type)) return type;
+    }
+    throw std::invalid_argument("unknown request type " + name);
+}
+
+struct LoadConfig {
+    // Relative frequency of each request type, indexed by RequestType.
+    double mix[RequestTypeCount] = {4, 2, 2, 1};
+
+    // Service worker threads (0 for one per hardware thread) and client
+    // threads generating the arrivals.
+    size_t service_threads = 0;
+    size_t clients = 8;
+
+    // Offered loads as fractions of the capacity estimated from the mix's
+    // single-request latencies, unless absolute rates (requests/s) are given.
+    std::vector<double> load_levels = {0.1, 0.25, 0.5, 0.7, 0.8, 0.9, 0.95, 1.0, 1.1};
+    std::vector<double> rates;
+
+    double duration_s = 5;
+    size_t dot_size = 64;
+
+    // Requests waiting beyond this many are dropped rather than queued, so
+    // an overloaded level ends instead of building an unbounded backlog.
+    size_t max_backlog = 100000;
+
+    std::string describe_mix() const {
+        std::ostringstream ss;
+        for (size_t i = 0; i < RequestTypeCount; i++) {
+            if (i) ss << ";";
+            ss << request_type_name(static_cast<RequestType>(i)) << ":" << mix[i];
+        }
+        return ss.str();
+    }
+};
+
+// Load options:
+//   --mix=add:4,multiply:2,rotate:2,dot:1  request mix (unlisted types get 0)
+//   --service-threads=N  evaluation workers (default all cores)
+//   --clients=N          arrival-generating client threads (default 8)
+//   --load-levels=a,b..  offered load as fractions of estimated capacity
+//   --rates=a,b,...      offered load in requests/s instead
+//   --duration=S         seconds of arrivals per level (default 5)
+//   --dot-size=N         dot product length (default 64)
+//   --max-backlog=N      queued requests beyond which arrivals are dropped
+inline void apply_options(LoadConfig &load, const Options &options) {
+    auto mix = options.get_strings("mix");
+    if (!mix.empty()) {
+        std::fill(load.mix, load.mix + RequestTypeCount, 0.0);
+        for (const auto &entry : mix) {
+            auto colon = entry.find(':');
+            RequestType type = parse_request_type(entry.substr(0, colon));
+            load.mix[static_cast<size_t>(type)] =
+                colon == std::string::npos ? 1.0 : std::max(0.0, std::strtod(entry.c_str() + colon + 1, nullptr));
+        }
+    }
+    load.service_threads = static_cast<size_t>(std::max(0L, options.get_long("service-threads", 0)));
+    load.clients = static_cast<size_t>(std::max(1L, options.get_long("clients", static_cast<long>(load.clients))));
+    auto levels = options.get_strings("load-levels");
+    if (!levels.empty()) {
+        load.load_levels.clear();
+        for (const auto &l : levels) load.load_levels.push_back(std::strtod(l.c_str(), nullptr));
+    }
+    for (const auto &r : options.get_strings("rates")) load.rates.push_back(std::strtod(r.c_str(), nullptr));
+    load.duration_s = std::max(0.1, options.get_double("duration", load.duration_s));
+    load.dot_size = static_cast<size_t>(std::max(2L, options.get_long("dot-size", static_cast<long>(load.dot_size))));
+    load.max_backlog = static_cast<size_t>(std::max(1L, options.get_long("max-backlog", static_cast<long>(load.max_backlog))));
+}
+
+using LoadClock = std::chrono::steady_clock;
+
+struct Request {
+    RequestType type;
+    LoadClock::time_point arrival;  // when it was scheduled to arrive
+};
+
+// Latencies of completed requests, per type.
+struct LatencyLog {
+    std::vector<double> total_ms[RequestTypeCount];    // arrival to completion
+    std::vector<double> service_ms[RequestTypeCount];  // execution only
+
+    void merge(const LatencyLog &o) {
+        for (size_t i = 0; i < RequestTypeCount; i++) {
+            total_ms[i].insert(total_ms[i].end(), o.total_ms[i].begin(), o.total_ms[i].end());
+            service_ms[i].insert(service_ms[i].end(), o.service_ms[i].begin(), o.service_ms[i].end());
+        }
+    }
+};
+
+// Long-lived evaluation service over the backend's current setup: one
+// worker backend per thread (see Backend::make_worker), sharing the cached
+// context and keys, serving a FIFO of requests until stopped.
+class EvaluatorService {
+private:
+    Backend &backend;
+    size_t dot_size;
+    size_t max_backlog;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable idle;
+    std::deque<Request> queue;
+    size_t busy = 0;
+    bool stopping = false;
+    std::vector<LatencyLog> logs;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> dropped{0};
+    std::atomic<size_t> failed{0};
+    std::atomic<size_t> completed_count{0};
+    std::atomic<size_t> failed_count{0};
+    std::string setup_error;
+    std::string request_error;  // the first request that threw since the last collect()
+
+public:
+    EvaluatorService(Backend &backend, size_t workers, size_t dot_size, size_t max_backlog, uint32_t seed)
+        : backend(backend), dot_size(dot_size), max_backlog(max_backlog), logs(workers) {
+        StartGate started(workers + 1);
+        for (size_t w = 0; w < workers; w++) {
+            threads.emplace_back([this, w, seed, &started] { serve(w, seed, started); });
+        }
+        started.arrive_and_wait();
+        if (!setup_error.empty()) {
+            stop();
+            throw std::runtime_error(setup_error);
+        }
+    }
+    EvaluatorService(const EvaluatorService &) = delete;
+    EvaluatorService &operator=(const EvaluatorService &) = delete;
+    ~EvaluatorService() { stop(); }
+
+    size_t workers() const { return threads.size(); }
+    size_t completed() const { return completed_count; }
+    // Requests that threw while executing; they count as dropped too.
+    size_t failures() const { return failed_count; }
+
+    // False (and counted as dropped) if the backlog is full.
+    bool submit(const Request &request) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.size() >= max_backlog) {
+                dropped++;
+                return false;
+            }
+            queue.push_back(request);
+        }
+        ready.notify_one();
+        return true;
+    }
+
+    // Waits until every submitted request has completed.
+    void drain() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return queue.empty() && busy == 0; });
+    }
+
+    // Latencies and drops since the last collect(); failed_out is the part
+    // of the drops that threw, and error the first of those errors.
+    LatencyLog collect(size_t &dropped_out, size_t &failed_out, std::string &error) {
+        std::lock_guard<std::mutex> lock(mutex);
+        LatencyLog all;
+        for (auto &log : logs) {
+            all.merge(log);
+            log = LatencyLog();
+        }
+        dropped_out = dropped.exchange(0);
+        failed_out = failed.exchange(0);
+        error = request_error;
+        request_error.clear();
+        return all;
+    }
+
+private:
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto &t : threads) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+    // A worker that fails before the start gate still arrives at it, and the
+    // constructor rethrows its error. A request that throws is counted as
+    // failed and dropped, and the worker moves on to the next one.
+    void serve(size_t w, uint32_t seed, StartGate &started) {
+        bool arrived = false;
+        try {
+            run_worker(w, seed, started, arrived);
+        } catch (const std::exception &e) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                setup_error = e.what();
+            }
+            if (!arrived) started.arrive_and_wait();
+        }
+    }
+
+    void run_worker(size_t w, uint32_t seed, StartGate &started, bool &arrived) {
+        auto worker = backend.make_worker();
+        size_t slot_count = worker->slot_count();
+        DataSpec spec;
+        spec.pattern = DataPattern::Random;
+        spec.seed = seed + static_cast<uint32_t>(w);
+        std::vector<uint64_t> values(slot_count, 0);
+        auto plain = worker->make_plain();
+        auto x = worker->make_cipher();
+        auto y = worker->make_cipher();
+        auto out = worker->make_cipher();
+        auto tmp = worker->make_cipher();
+        // The dot product reduces the first dot_size slots; the rest are zero.
+        size_t used = std::min(dot_size, worker->row_size());
+        for (size_t i = 0; i < used; i++) values[i] = operand_value(spec, 0, i);
+        worker->encode(values, *plain);
+        worker->encrypt(*plain, *x);
+        for (size_t i = 0; i < used; i++) values[i] = operand_value(spec, 1, i);
+        worker->encode(values, *plain);
+        worker->encrypt(*plain, *y);
+
+        auto execute = [&](RequestType type) {
+            switch (type) {
+            case RequestType::Add: worker->add(*x, *y, *out); break;
+            case RequestType::Multiply: worker->multiply(*x, *y, *out); break;
+            case RequestType::Rotate: worker->rotate(*x, 1, *out); break;
+            case RequestType::Dot: dot_product(*worker, *x, *y, used, *out, *tmp); break;
+            }
+        };
+        for (size_t i = 0; i < RequestTypeCount; i++) execute(static_cast<RequestType>(i));
+        arrived = true;
+        started.arrive_and_wait();
+
+        LatencyLog &log = logs[w];
+        while (true) {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) return;
+                request = queue.front();
+                queue.pop_front();
+                busy++;
+            }
+            auto start = LoadClock::now();
+            try {
+                execute(request.type);
+            } catch (const std::exception &e) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (request_error.empty()) request_error = e.what();
+                failed++;
+                dropped++;
+                failed_count++;
+                if (--busy == 0 && queue.empty()) idle.notify_all();
+                continue;
+            }
+            auto done = LoadClock::now();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                size_t t = static_cast<size_t>(request.type);
+                log.total_ms[t].push_back(std::chrono::duration<double, std::milli>(done - request.arrival).count());
+                log.service_ms[t].push_back(std::chrono::duration<double, std::milli>(done - start).count());
+                completed_count++;
+                if (--busy == 0 && queue.empty()) idle.notify_all();
+            }
+        }
+    }
+};
+
+// Open loop: `clients` threads each draw Poisson arrivals at rate / clients
+// and request types from the mix, and submit every request at its scheduled
+// time whether or not earlier ones have finished. Latency is measured from
+// the scheduled arrival, so a stalled service is charged for the requests
+// queued behind it.
+inline void offer_load(EvaluatorService &service, const LoadConfig &load, double rate, uint32_t seed) {
+    auto start = LoadClock::now() + std::chrono::milliseconds(10);
+    auto end = start + std::chrono::duration_cast<LoadClock::duration>(std::chrono::duration<double>(load.duration_s));
+    run_on_threads(load.clients, [&](size_t c) {
+        std::mt19937_64 rng(seed * 1000003ULL + c);
+        std::exponential_distribution<double> gap(rate / load.clients);
+        std::discrete_distribution<size_t> pick(load.mix, load.mix + RequestTypeCount);
+        auto at = start;
+        while (true) {
+            at += std::chrono::duration_cast<LoadClock::duration>(std::chrono::duration<double>(gap(rng)));
+            if (at >= end) break;
+            std::this_thread::sleep_until(at);
+            service.submit({static_cast<RequestType>(pick(rng)), at});
+        }
+    });
+    service.drain();
+}
+
+// Closed loop for the saturation throughput: 2 x workers requests kept
+// outstanding, topped up as the service completes them.
+inline double saturate(EvaluatorService &service, const LoadConfig &load, uint32_t seed, size_t &completed) {
+    size_t outstanding = 2 * service.workers();
+    std::mt19937_64 rng(seed);
+    std::discrete_distribution<size_t> pick(load.mix, load.mix + RequestTypeCount);
+    size_t first = service.completed() + service.failures();
+    size_t submitted = 0;
+    Timer timer;
+    timer.tic();
+    auto end = LoadClock::now() + std::chrono::duration_cast<LoadClock::duration>(std::chrono::duration<double>(load.duration_s));
+    while (LoadClock::now() < end) {
+        while (submitted - (service.completed() + service.failures() - first) < outstanding) {
+            service.submit({static_cast<RequestType>(pick(rng)), LoadClock::now()});
+            submitted++;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+    service.drain();
+    double seconds = timer.toc() / 1000.0;
+    size_t dropped = 0, failed = 0;
+    std::string error;
+    service.collect(dropped, failed, error);
+    if (failed) throw std::runtime_error(std::to_string(failed) + " requests failed: " + error);
+    completed = service.completed() + service.failures() - first;
+    return completed / seconds;
+}
+
+inline ColumnSet load_sweep_columns() {
+    return keyed_columns(
+        result_columns(
+            {"mode", "service_threads", "clients", "mix", "load_level", "offered_rate", "offered_load_ratio",
+             "achieved_per_s", "completed_requests", "dropped_requests", "request_type", "latency_p50_ms",
+             "latency_p99_ms", "latency_p999_ms",
+             "latency_mean_ms", "latency_max_ms", "service_p50_ms"}),
+        {"mode", "service_threads", "clients", "mix", "load_level", "request_type"});
+}
+
+struct LatencySummary {
+    size_t count = 0;
+    double p50 = 0, p99 = 0, p999 = 0, mean = 0, max = 0;
+};
+
+inline LatencySummary summarize(std::vector<double> v) {
+    LatencySummary s;
+    if (v.empty()) return s;
+    std::sort(v.begin(), v.end());
+    s.count = v.size();
+    s.p50 = percentile(v, 50);
+    s.p99 = percentile(v, 99);
+    s.p999 = percentile(v, 99.9);
+    s.max = v.back();
+    for (double x : v) s.mean += x;
+    s.mean /= v.size();
+    return s;
+}
+
+// Latency under load at every degree: an EvaluatorService on the cached
+// setup, first driven closed-loop for its saturation throughput, then
+// open-loop at each offered load. Offered loads default to fractions of
+// the capacity estimated from single-request latencies (service_threads /
+// mean service time of the mix). Every level logs one row for all requests
+// and one per request type: p50 / p99 / p99.9 latency from arrival to
+// completion and the median execution time alone. Rows are keyed on the
+// level as configured (load_level); the rate it resolved to is reported as
+// offered_rate, which run comparison leaves alone. dropped_requests counts
+// requests refused by a full backlog or that threw while executing; a
+// failure while measuring capacity or saturation fails the degree. Results
+// carry the run_tags(), so --ab-hexl yields the curve per HEXL setting.
+inline void run_load_sweep(Backend &backend, const SweepConfig &config, const LoadConfig &load, CsvLog &log) {
+    size_t workers = load.service_threads ? load.service_threads : hardware_threads();
+    std::string mix = load.describe_mix();
+
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " load PolyModulus=" << degree << ", " << workers
+                  << " service threads, mix " << mix << " ===" << std::endl;
+        std::vector<ParamSet> candidates = sweep_candidates(config, degree);
+        for (auto &params : candidates) {
+            params.galois_keys = true;
+            if (config.required_rotations.empty()) params.galois_steps = dot_product_rotations(load.dot_size);
+        }
+        if (!setup_first_working(backend, candidates)) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        size_t slot_count = backend.slot_count();
+
+        try {
+            EvaluatorService service(backend, workers, load.dot_size, load.max_backlog, config.seed);
+
+            // Single-request latencies on an otherwise idle service.
+            double weight = 0, mean_ms = 0;
+            for (size_t i = 0; i < RequestTypeCount; i++) {
+                if (load.mix[i] <= 0) continue;
+                for (int k = 0; k < config.timing.iterations; k++) {
+                    service.submit({static_cast<RequestType>(i), LoadClock::now()});
+                    service.drain();
+                }
+                size_t dropped = 0, failed = 0;
+                std::string error;
+                LatencyLog idle = service.collect(dropped, failed, error);
+                if (failed) throw std::runtime_error(error);
+                mean_ms += load.mix[i] * summarize(idle.service_ms[i]).p50;
+                weight += load.mix[i];
+            }
+            if (weight == 0) throw std::invalid_argument("empty request mix");
+            mean_ms /= weight;
+            double capacity = workers * 1000.0 / mean_ms;
+
+            size_t completed = 0;
+            double saturation = saturate(service, load, config.seed, completed);
+            log.row(backend.library(), backend.scheme(), degree, slot_count, "closed", workers, 2 * workers, mix,
+                    "saturation", "", "", saturation, completed, 0, "all", "", "", "", "", "", "");
+            std::cout << "  estimated capacity " << capacity << " req/s, saturation " << saturation << " req/s"
+                      << std::endl;
+
+            // (level as configured, rate): a fraction of the estimated
+            // capacity ("0.5") or a rate ("200/s"). The level keys the row;
+            // the rate it resolves to and its ratio to the measured
+            // saturation are results.
+            std::vector<std::pair<std::string, double>> levels;
+            auto level_name = [](double level, const char *unit) {
+                std::ostringstream ss;
+                ss << level << unit;
+                return ss.str();
+            };
+            if (!load.rates.empty()) {
+                for (double r : load.rates) levels.emplace_back(level_name(r, "/s"), r);
+            } else {
+                for (double f : load.load_levels) levels.emplace_back(level_name(f, ""), f * capacity);
+            }
+
+            for (size_t l = 0; l < levels.size(); l++) {
+                const std::string &level = levels[l].first;
+                double rate = levels[l].second;
+                double ratio = saturation > 0 ? rate / saturation : 0;
+                if (rate <= 0) continue;
+                Timer wall;
+                wall.tic();
+                offer_load(service, load, rate, config.seed + static_cast<uint32_t>(l));
+                double seconds = wall.toc() / 1000.0;
+                size_t dropped = 0, failed = 0;
+                std::string error;
+                LatencyLog latencies = service.collect(dropped, failed, error);
+
+                std::vector<double> all_total, all_service;
+                for (size_t i = 0; i < RequestTypeCount; i++) {
+                    all_total.insert(all_total.end(), latencies.total_ms[i].begin(), latencies.total_ms[i].end());
+                    all_service.insert(all_service.end(), latencies.service_ms[i].begin(),
+                                       latencies.service_ms[i].end());
+                }
+                double achieved = all_total.size() / seconds;
+                auto row = [&](const char *type, const std::vector<double> &total, const std::vector<double> &exec,
+                               size_t drops) {
+                    LatencySummary s = summarize(total);
+                    log.row(backend.library(), backend.scheme(), degree, slot_count, "open", workers, load.clients,
+                            mix, level, rate, ratio, s.count / seconds, s.count, drops, type, s.p50, s.p99, s.p999,
+                            s.mean, s.max, summarize(exec).p50);
+                    return s;
+                };
+                LatencySummary s = row("all", all_total, all_service, dropped);
+                for (size_t i = 0; i < RequestTypeCount; i++) {
+                    if (load.mix[i] <= 0) continue;
+                    row(request_type_name(static_cast<RequestType>(i)), latencies.total_ms[i],
+                        latencies.service_ms[i], 0);
+                }
+                std::cout << "  offered " << rate << " req/s (" << level << "): achieved " << achieved
+                          << " req/s, p50 " << s.p50 << " ms, p99 " << s.p99 << " ms, p99.9 " << s.p999 << " ms";
+                if (dropped) std::cout << ", dropped " << dropped;
+                if (failed) std::cout << " (" << failed << " failed: " << error << ")";
+                std::cout << std::endl;
+            }
+        } catch (const std::exception &e) {
+            std::cout << "Error with PolyModulus: " << degree << " - " << e.what() << std::endl;
+        }
+    }
+}
+
+} // namespace bench
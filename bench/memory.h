@@ -0,0 +1,121 @@
+#pragma once
+
+#include "backend.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace bench {
+
+// A "Vm...:" field of /proc/self/status in KB; 0 where /proc is unavailable.
+inline long proc_status_kb(const char *field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    size_t len = std::strlen(field);
+    while (std::getline(status, line)) {
+        if (line.compare(0, len, field) == 0) {
+            return std::strtol(line.c_str() + len, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+inline long current_rss_kb() { return proc_status_kb("VmRSS:"); }
+inline long peak_rss_kb() { return proc_status_kb("VmHWM:"); }
+
+// Resets the kernel's peak-RSS watermark to the current RSS so the next
+// peak_rss_kb() reflects only what happened since. Linux-only; returns
+// false if the watermark could not be reset.
+inline bool reset_peak_rss() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    return static_cast<bool>(clear_refs);
+}
+
+// Bytes currently handed out by malloc; 0 where glibc's mallinfo2 is missing.
+inline size_t heap_in_use_bytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+// Stream buffer that only counts what is written to it, used to size
+// objects through their library serializers without keeping the bytes.
+class CountingStreambuf : public std::streambuf {
+private:
+    size_t count = 0;
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) count++;
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char *, std::streamsize n) override {
+        count += static_cast<size_t>(n);
+        return n;
+    }
+
+public:
+    size_t size() const { return count; }
+};
+
+template <typename Fn>
+size_t serialized_size(Fn &&write) {
+    CountingStreambuf buf;
+    std::ostream out(&buf);
+    write(out);
+    return buf.size();
+}
+
+// What one call cost in memory.
+struct MemoryUsage {
+    size_t pool_bytes = 0;          // allocated from the library's pool (SEAL only)
+    long heap_delta_bytes = 0;      // net malloc growth, i.e. what the call left allocated
+    long peak_rss_delta_kb = 0;     // peak resident set above the starting RSS
+};
+
+// Runs fn once with a fresh library pool and a reset RSS watermark. fn should
+// allocate its outputs through backend.make_cipher()/make_plain() and keep
+// them alive outside its own scope so they are charged to the call.
+template <typename Fn>
+MemoryUsage probe_memory(Backend &backend, Fn &&fn) {
+    MemoryUsage usage;
+    reset_peak_rss();
+    long rss_before = current_rss_kb();
+    size_t heap_before = heap_in_use_bytes();
+
+    backend.begin_memory_probe();
+    fn();
+    usage.heap_delta_bytes = static_cast<long>(heap_in_use_bytes()) - static_cast<long>(heap_before);
+    usage.pool_bytes = backend.end_memory_probe();
+    usage.peak_rss_delta_kb = peak_rss_kb() - rss_before;
+    return usage;
+}
+
+// Backend arena for the lifetime of the scope (see Backend::begin_arena).
+class ArenaScope {
+private:
+    Backend &backend;
+
+public:
+    ArenaScope(Backend &backend, size_t polys) : backend(backend) { backend.begin_arena(polys); }
+    ~ArenaScope() { backend.end_arena(); }
+
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+};
+
+} // namespace bench
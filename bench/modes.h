@@ -0,0 +1,213 @@
+#pragma once
+
+#include "backend.h"
+#include "cold_start.h"
+#include "distributed.h"
+#include "kernel_sweep.h"
+#include "key_profile.h"
+#include "load_sweep.h"
+#include "mul_phases.h"
+#include "numa_sweep.h"
+#include "packing_sweep.h"
+#include "options.h"
+#include "parallel_sweep.h"
+#include "perf_sweep.h"
+#include "plain_cache.h"
+#include "pipeline_sweep.h"
+#include "results.h"
+#include "serialization.h"
+#include "streaming.h"
+#include "workloads.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Thread counts from --threads=N[,M...]; a bare --threads means all cores.
+inline std::vector<size_t> thread_counts(const Options &options) {
+    std::vector<size_t> counts;
+    for (long n : options.get_list("threads")) {
+        if (n > 0) counts.push_back(static_cast<size_t>(n));
+    }
+    if (counts.empty()) counts.push_back(hardware_threads());
+    return counts;
+}
+
+// --stage-threads=E,C,V,D (encode, encrypt, evaluate, decrypt workers),
+// --queue-depth=N and --stream-ciphertexts=N.
+inline PipelineConfig pipeline_config(const Options &options) {
+    PipelineConfig pipeline;
+    auto stage_threads = options.get_list("stage-threads");
+    for (size_t s = 0; s < StageCount && s < stage_threads.size(); s++) {
+        pipeline.stage_threads[s] = static_cast<size_t>(std::max(1L, stage_threads[s]));
+    }
+    pipeline.queue_depth = static_cast<size_t>(std::max(1L, options.get_long("queue-depth", 4)));
+    pipeline.min_ciphertexts = static_cast<size_t>(std::max(0L, options.get_long("stream-ciphertexts", 0)));
+    return pipeline;
+}
+
+// --cold-start of the op and rotation drivers, into <csv_base>_cold_start.csv.
+inline void run_cold_start_mode(Backend &backend, const SweepConfig &config, const Options &options,
+                                const std::string &csv_base) {
+    CsvLog log(csv_base + "_cold_start.csv", cold_start_columns());
+    size_t dataset_ciphertexts = static_cast<size_t>(std::max(1L, options.get_long("dataset-ciphertexts", 16)));
+    run_cold_start(backend, config, dataset_ciphertexts, log);
+}
+
+// Entry point of the element-wise op drivers. Picks the execution mode from
+// the command line and writes <csv_base>[_<mode>].csv:
+//   (default)          serial op sweep
+//   --threads=N[,M..]  chunk-parallel sweep of the multi-ciphertext sizes
+//   --pipeline         encode/encrypt/evaluate/decrypt as overlapping stages
+//   --worker=PORT      serve distributed coordinators on PORT (never
+//                      returns; writes nothing)
+//   --distributed=host:port,...
+//                      shard chunks over those workers, 1..all of them,
+//                      results in --wire-format=F (default uncompressed)
+//   --numa             pinned workers with per-node key replicas, per
+//                      --placement=a,b (none, compact, spread; default all)
+//                      over --threads (default 1, 2, 4, ... all CPUs)
+//   --key-profile      key generation time and size per parameter set
+//   --mul-phases       tensor / relinearize / mod-switch split and lazy
+//                      relinearization of multiply-add chains
+//   --perf             hardware counters and ntt / tensor / key-switch /
+//                      mod-switch breakdown of each basic op; the AVX-512
+//                      license event is --perf-avx512=CODE (raw event; 0
+//                      leaves it out; by default 0x2028 on the Intel server
+//                      cores it is defined for, off elsewhere)
+//   --packing          several vectors per ciphertext versus one-per-chunk
+//   --serialization    wire size and (de)serialization cost per format, and
+//                      --stream-ciphertexts=N products (default 16)
+//                      serialized inline versus double-buffered
+//   --stream           encrypted running sums and products over a record
+//                      stream in a fixed ciphertext window (see
+//                      StreamConfig for --stream-input, --records, ...)
+//   --kernels          dot product, BSGS matrix-vector and 1D convolution
+//   --plain-cache      weighted sums over cached plaintext weights, per
+//                      plain encoding and with NTT-resident ciphertexts
+//   --cold-start       key store load versus keygen, and a pre-encrypted
+//                      dataset of --dataset-ciphertexts=N (default 16)
+//   --load             p50 / p99 / p99.9 latency of a shared evaluator
+//                      service under open-loop client load (see LoadConfig
+//                      for --mix, --clients, --load-levels, ...)
+//
+// B is the driver's backend class, so the default sweep's timed loops make
+// direct calls into it.
+template <typename B>
+void run_op_modes(B &backend, const SweepConfig &config, const Options &options, const std::string &csv_base) {
+    if (options.has("worker")) {
+        run_distributed_worker(backend, options.get("worker"));
+        return;
+    }
+    if (options.has("key-profile")) {
+        CsvLog log(csv_base + "_keys.csv", key_profile_columns());
+        run_key_profile(backend, config, log);
+        return;
+    }
+    if (options.has("mul-phases")) {
+        CsvLog log(csv_base + "_mul_phases.csv", mul_phases_columns());
+        run_mul_phases(backend, config, log);
+        return;
+    }
+    if (options.has("perf")) {
+        CsvLog log(csv_base + "_perf.csv", perf_sweep_columns());
+        std::string event = options.get("perf-avx512");
+        uint64_t avx512_event = event.empty() ? default_avx512_event() : std::strtoull(event.c_str(), nullptr, 0);
+        run_perf_sweep(backend, config, avx512_event, log);
+        return;
+    }
+    if (options.has("packing")) {
+        CsvLog log(csv_base + "_packing.csv", packing_sweep_columns());
+        run_packing_sweep(backend, config, log);
+        return;
+    }
+    if (options.has("cold-start")) {
+        run_cold_start_mode(backend, config, options, csv_base);
+        return;
+    }
+    if (options.has("stream")) {
+        StreamConfig stream;
+        apply_options(stream, options);
+        CsvLog log(csv_base + "_stream.csv", stream_columns());
+        run_stream_sweep(backend, config, stream, log);
+        return;
+    }
+    if (options.has("kernels")) {
+        CsvLog log(csv_base + "_kernels.csv", kernel_sweep_columns());
+        run_kernel_sweep(backend, config, log);
+        return;
+    }
+    if (options.has("plain-cache")) {
+        CsvLog log(csv_base + "_plain_cache.csv", plain_cache_columns());
+        run_plain_cache_sweep(backend, config, log);
+        return;
+    }
+    if (options.has("serialization")) {
+        CsvLog log(csv_base + "_serialization.csv", serialization_columns());
+        CsvLog stream_log(csv_base + "_serialization_stream.csv", serialization_stream_columns());
+        size_t stream_ciphertexts = static_cast<size_t>(std::max(0L, options.get_long("stream-ciphertexts", 16)));
+        run_serialization_sweep(backend, config, stream_ciphertexts, log, stream_log);
+        return;
+    }
+    if (options.has("pipeline")) {
+        CsvLog log(csv_base + "_pipeline.csv", pipeline_sweep_columns());
+        run_pipeline_sweep(backend, config, pipeline_config(options), log);
+        return;
+    }
+    if (options.has("distributed")) {
+        std::vector<WorkerAddress> workers;
+        for (const auto &spec : options.get_strings("distributed")) workers.push_back(parse_worker_address(spec));
+        CsvLog log(csv_base + "_distributed.csv", distributed_columns());
+        run_distributed_sweep(backend, config, workers, options.get("wire-format"), log);
+        return;
+    }
+    if (options.has("numa")) {
+        std::vector<Placement> placements;
+        for (const auto &name : options.get_strings("placement")) placements.push_back(parse_placement(name));
+        if (placements.empty()) placements = {Placement::None, Placement::Compact, Placement::Spread};
+        CsvLog log(csv_base + "_numa.csv", numa_sweep_columns());
+        run_numa_sweep(backend, config, placements, options.get_list("threads"), log);
+        return;
+    }
+    if (options.has("load")) {
+        LoadConfig load;
+        apply_options(load, options);
+        CsvLog log(csv_base + "_load.csv", load_sweep_columns());
+        run_load_sweep(backend, config, load, log);
+        return;
+    }
+    if (options.has("threads")) {
+        CsvLog log(csv_base + "_parallel.csv", parallel_sweep_columns());
+        run_parallel_sweep(backend, config, thread_counts(options), log);
+        return;
+    }
+    CsvLog log(csv_base + ".csv", op_sweep_columns());
+    run_op_sweep(backend, config, log);
+}
+
+// Entry point of the rotation drivers: the rotation suite into
+// <csv_base>.csv, with --key-profile the cost of each Galois key set it
+// compares into <csv_base>_keys.csv, or --cold-start as for the op drivers.
+inline void run_rotation_modes(Backend &backend, const SweepConfig &config, const Options &options,
+                               const std::string &csv_base) {
+    if (options.has("key-profile")) {
+        CsvLog log(csv_base + "_keys.csv", key_profile_columns());
+        for (const auto &key_set : config.rotation_key_sets) {
+            SweepConfig key_config = config;
+            if (key_set == "steps") key_config.required_rotations = rotation_suite_steps(config);
+            run_key_profile(backend, key_config, log);
+        }
+        return;
+    }
+    if (options.has("cold-start")) {
+        run_cold_start_mode(backend, config, options, csv_base);
+        return;
+    }
+    CsvLog log(csv_base + ".csv", rotation_sweep_columns());
+    run_rotation_sweep(backend, config, log);
+}
+
+} // namespace bench
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "backend.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+inline ColumnSet mul_phases_columns() {
+    return keyed_columns(
+        result_columns(concat_columns({
+            {"phase", "chain_length"},
+            stats_columns("phase"),
+            {"result_bytes", "noise_budget", "valid"}})),
+        {"phase", "chain_length"});
+}
+
+// Ciphertext x ciphertext multiplication broken into its phases, on full
+// vectors at every degree:
+//   TENSOR       multiply_no_relin(), three-component result
+//   RELINEARIZE  key switching of a tensor product back to two components
+//   MOD_SWITCH   next modulus of the chain, on a relinearized product
+//   MULTIPLY     multiply() as the op sweep times it (tensor + relinearize)
+// and the sum of mul_chain_length products a_i * b_i:
+//   CHAIN_EAGER  every product relinearized before it is added
+//   CHAIN_LAZY   three-component products added, relinearized once
+// Rows carry the size and noise budget of the phase's result and whether it
+// decrypts to the expected slots.
+inline void run_mul_phases(Backend &backend, const SweepConfig &config, CsvLog &log) {
+    OperandSource source(config);
+    const TimingConfig &timing = config.timing;
+    size_t chain_length = config.mul_chain_length;
+
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " multiply phases PolyModulus=" << degree << " ===" << std::endl;
+        if (!setup_first_working(backend, sweep_candidates(config, degree))) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        size_t slot_count = backend.slot_count();
+        uint64_t t = backend.plain_modulus();
+
+        std::vector<std::vector<uint64_t>> data_a(chain_length), data_b(chain_length);
+        std::vector<std::unique_ptr<Cipher>> a, b;
+        auto plain = backend.make_plain();
+        for (size_t i = 0; i < chain_length; i++) {
+            source.fill_a(data_a[i], slot_count, slot_count);
+            source.fill_b(data_b[i], slot_count, slot_count);
+            a.push_back(backend.make_cipher());
+            b.push_back(backend.make_cipher());
+            backend.encode(data_a[i], *plain);
+            backend.encrypt(*plain, *a[i]);
+            backend.encode(data_b[i], *plain);
+            backend.encrypt(*plain, *b[i]);
+        }
+        auto result = backend.make_cipher();
+        auto tmp = backend.make_cipher();
+
+        std::vector<uint64_t> decoded;
+        auto decrypts_to = [&](size_t products) {
+            backend.decrypt(*result, *plain);
+            backend.decode(*plain, decoded);
+            for (size_t j = 0; j < slot_count; j++) {
+                uint64_t expected = 0;
+                for (size_t i = 0; i < products; i++) {
+                    expected = (expected + expected_value(OpType::CipherMulCipher, data_a[i][j],
+                                                          data_b[i][j], t)) % t;
+                }
+                if (decoded[j] != expected) return false;
+            }
+            return true;
+        };
+        auto log_phase = [&](const char *phase, size_t products, const Stats &stats) {
+            double budget = backend.noise_budget(*result);
+            bool valid = decrypts_to(products);
+            log.row(backend.library(), backend.scheme(), degree, slot_count, phase, products, stats,
+                    backend.cipher_bytes(*result), budget, valid ? 1 : 0);
+            std::cout << "  " << phase;
+            if (products > 1) std::cout << " x" << products;
+            std::cout << ": " << stats.median_ms << " ms (p99 " << stats.p99_ms << "), "
+                      << backend.cipher_bytes(*result) / 1024 << " KB, budget " << budget
+                      << (valid ? "" : ", INVALID") << std::endl;
+        };
+        auto chain = [&](bool lazy) {
+            auto product = [&](size_t i, Cipher &out) {
+                if (lazy) {
+                    backend.multiply_no_relin(*a[i], *b[i], out);
+                } else {
+                    backend.multiply(*a[i], *b[i], out);
+                }
+            };
+            product(0, *result);
+            for (size_t i = 1; i < chain_length; i++) {
+                product(i, *tmp);
+                backend.add(*result, *tmp, *result);
+            }
+            if (lazy) backend.relinearize(*result);
+        };
+
+        try {
+            Stats stats = measure(timing, [&] { backend.multiply_no_relin(*a[0], *b[0], *result); });
+            log_phase("TENSOR", 1, stats);
+            stats = measure_prepared(timing, [&] { backend.multiply_no_relin(*a[0], *b[0], *result); },
+                                     [&] { backend.relinearize(*result); });
+            log_phase("RELINEARIZE", 1, stats);
+
+            backend.multiply(*a[0], *b[0], *result);
+            if (backend.mod_switch(*result)) {
+                stats = measure_prepared(timing, [&] { backend.multiply(*a[0], *b[0], *result); },
+                                         [&] { backend.mod_switch(*result); });
+                log_phase("MOD_SWITCH", 1, stats);
+            } else {
+                std::cout << "  MOD_SWITCH: SKIPPING - single-modulus chain" << std::endl;
+            }
+
+            stats = measure(timing, [&] { backend.multiply(*a[0], *b[0], *result); });
+            log_phase("MULTIPLY", 1, stats);
+            stats = measure(timing, [&] { chain(false); });
+            log_phase("CHAIN_EAGER", chain_length, stats);
+            stats = measure(timing, [&] { chain(true); });
+            log_phase("CHAIN_LAZY", chain_length, stats);
+        } catch (const std::exception &e) {
+            std::cout << "Error with PolyModulus: " << degree << " - " << e.what() << std::endl;
+        }
+    }
+}
+
+} // namespace bench
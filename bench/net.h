@@ -0,0 +1,253 @@
+#pragma once
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <utility>
+
+namespace bench {
+
+// Blocking TCP connection carrying length-prefixed frames (see write_frame).
+// Socket errors throw std::runtime_error. One thread may send while another
+// receives; the byte counters are kept per direction.
+class Socket {
+    int fd = -1;
+    size_t sent = 0;
+    size_t received = 0;
+
+public:
+    Socket() = default;
+    explicit Socket(int fd) : fd(fd) {
+        // Frames are written as header + payload; do not hold either back.
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    Socket(Socket &&other) noexcept
+        : fd(std::exchange(other.fd, -1)), sent(other.sent), received(other.received) {}
+    Socket &operator=(Socket &&other) noexcept {
+        if (this != &other) {
+            close();
+            fd = std::exchange(other.fd, -1);
+            sent = other.sent;
+            received = other.received;
+        }
+        return *this;
+    }
+    Socket(const Socket &) = delete;
+    Socket &operator=(const Socket &) = delete;
+    ~Socket() { close(); }
+
+    void close() {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+
+    static Socket connect_to(const std::string &host, const std::string &port) {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo *found = nullptr;
+        int rc = getaddrinfo(host.c_str(), port.c_str(), &hints, &found);
+        if (rc != 0) throw std::runtime_error("cannot resolve " + host + ": " + gai_strerror(rc));
+        for (addrinfo *a = found; a; a = a->ai_next) {
+            int s = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if (s < 0) continue;
+            if (::connect(s, a->ai_addr, a->ai_addrlen) == 0) {
+                freeaddrinfo(found);
+                return Socket(s);
+            }
+            ::close(s);
+        }
+        freeaddrinfo(found);
+        throw std::runtime_error("cannot connect to " + host + ":" + port);
+    }
+
+    void write_all(const void *data, size_t size) {
+        const char *p = static_cast<const char *>(data);
+        while (size) {
+            ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("send failed: ") + std::strerror(errno));
+            }
+            p += n;
+            size -= static_cast<size_t>(n);
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+    // False if the peer closed the connection before the first byte.
+    bool read_all(void *data, size_t size) {
+        char *p = static_cast<char *>(data);
+        size_t got = 0;
+        while (got < size) {
+            ssize_t n = ::recv(fd, p + got, size - got, 0);
+            if (n == 0) {
+                if (got == 0) return false;
+                throw std::runtime_error("connection closed mid-frame");
+            }
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("recv failed: ") + std::strerror(errno));
+            }
+            got += static_cast<size_t>(n);
+        }
+        received += size;
+        return true;
+    }
+
+    // Whatever is available, up to size bytes; 0 once the peer has closed.
+    size_t read_some(void *data, size_t size) {
+        while (true) {
+            ssize_t n = ::recv(fd, data, size, 0);
+            if (n >= 0) {
+                received += static_cast<size_t>(n);
+                return static_cast<size_t>(n);
+            }
+            if (errno != EINTR) throw std::runtime_error(std::string("recv failed: ") + std::strerror(errno));
+        }
+    }
+
+    size_t bytes_sent() const { return sent; }
+    size_t bytes_received() const { return received; }
+};
+
+// Passive socket on every interface.
+class Listener {
+    int fd = -1;
+
+public:
+    explicit Listener(const std::string &port) {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo *found = nullptr;
+        int rc = getaddrinfo(nullptr, port.c_str(), &hints, &found);
+        if (rc != 0) throw std::runtime_error("cannot resolve port " + port + ": " + gai_strerror(rc));
+        for (addrinfo *a = found; a; a = a->ai_next) {
+            int s = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if (s < 0) continue;
+            int one = 1;
+            setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (::bind(s, a->ai_addr, a->ai_addrlen) == 0 && ::listen(s, 16) == 0) {
+                fd = s;
+                break;
+            }
+            ::close(s);
+        }
+        freeaddrinfo(found);
+        if (fd < 0) throw std::runtime_error("cannot listen on port " + port);
+    }
+    Listener(const Listener &) = delete;
+    Listener &operator=(const Listener &) = delete;
+    ~Listener() {
+        if (fd >= 0) ::close(fd);
+    }
+
+    Socket accept_one() {
+        while (true) {
+            int s = ::accept(fd, nullptr, nullptr);
+            if (s >= 0) return Socket(s);
+            if (errno != EINTR) throw std::runtime_error(std::string("accept failed: ") + std::strerror(errno));
+        }
+    }
+};
+
+// Read side of a socket as a std::istream buffer, for line-oriented input.
+class SocketStreambuf : public std::streambuf {
+    Socket &socket;
+    char buffer[1 << 16];
+
+protected:
+    int_type underflow() override {
+        size_t n = socket.read_some(buffer, sizeof(buffer));
+        if (n == 0) return traits_type::eof();
+        setg(buffer, buffer, buffer + n);
+        return traits_type::to_int_type(buffer[0]);
+    }
+
+public:
+    explicit SocketStreambuf(Socket &socket) : socket(socket) {}
+};
+
+// Frame: 4-byte type, 8-byte payload length, payload. Integers are in host
+// byte order; both ends are builds of the same driver.
+constexpr size_t FrameHeaderBytes = 12;
+
+inline void write_frame(Socket &socket, uint32_t type, const std::string &payload) {
+    char header[FrameHeaderBytes];
+    uint64_t size = payload.size();
+    std::memcpy(header, &type, 4);
+    std::memcpy(header + 4, &size, 8);
+    socket.write_all(header, sizeof(header));
+    socket.write_all(payload.data(), payload.size());
+}
+
+// False on a clean close between frames.
+inline bool read_frame(Socket &socket, uint32_t &type, std::string &payload) {
+    char header[FrameHeaderBytes];
+    if (!socket.read_all(header, sizeof(header))) return false;
+    uint64_t size = 0;
+    std::memcpy(&type, header, 4);
+    std::memcpy(&size, header + 4, 8);
+    payload.resize(size);
+    if (size && !socket.read_all(&payload[0], size)) throw std::runtime_error("connection closed mid-frame");
+    return true;
+}
+
+// Appends fixed-size integers and length-prefixed byte strings to a payload.
+class FrameWriter {
+    std::string buffer;
+
+public:
+    void put_u32(uint32_t v) { buffer.append(reinterpret_cast<const char *>(&v), sizeof(v)); }
+    void put_u64(uint64_t v) { buffer.append(reinterpret_cast<const char *>(&v), sizeof(v)); }
+    void put_bytes(const std::string &bytes) {
+        put_u64(bytes.size());
+        buffer += bytes;
+    }
+    const std::string &data() const { return buffer; }
+};
+
+// Reads back what FrameWriter wrote; throws on a truncated payload.
+class FrameReader {
+    const std::string &buffer;
+    size_t pos = 0;
+
+    const char *take(size_t n) {
+        if (buffer.size() - pos < n) throw std::runtime_error("truncated frame");
+        const char *p = buffer.data() + pos;
+        pos += n;
+        return p;
+    }
+
+public:
+    explicit FrameReader(const std::string &buffer) : buffer(buffer) {}
+
+    uint32_t get_u32() {
+        uint32_t v;
+        std::memcpy(&v, take(sizeof(v)), sizeof(v));
+        return v;
+    }
+    uint64_t get_u64() {
+        uint64_t v;
+        std::memcpy(&v, take(sizeof(v)), sizeof(v));
+        return v;
+    }
+    std::string get_bytes() {
+        size_t n = static_cast<size_t>(get_u64());
+        return std::string(take(n), n);
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "backend.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// What the op sweep records about noise in every cell:
+//   Off        nothing; the noise columns stay empty
+//   Measured   Backend::noise_budget(), which decrypts in SEAL
+//   Estimated  Backend::estimated_noise_budget(), no secret key involved
+enum class NoiseTelemetry { Off, Measured, Estimated };
+
+inline const char *noise_telemetry_name(NoiseTelemetry mode) {
+    switch (mode) {
+    case NoiseTelemetry::Off: return "off";
+    case NoiseTelemetry::Measured: return "measured";
+    case NoiseTelemetry::Estimated: return "estimated";
+    }
+    return "unknown";
+}
+
+inline NoiseTelemetry parse_noise_telemetry(const std::string &name) {
+    for (auto mode : {NoiseTelemetry::Off, NoiseTelemetry::Measured, NoiseTelemetry::Estimated}) {
+        if (name == noise_telemetry_name(mode)) return mode;
+    }
+    throw std::invalid_argument("unknown noise telemetry mode " + name);
+}
+
+// Noise budget going into one op (the smaller of two ciphertext operands)
+// and coming out, the modulus bits at both ends, and what the readings
+// cost.
+struct NoiseSample {
+    NoiseTelemetry mode = NoiseTelemetry::Off;
+    double before = 0;
+    double after = 0;
+    double modulus_bits_before = 0;
+    double modulus_bits_after = 0;
+    double ms = 0;
+};
+
+inline std::vector<std::string> noise_columns() {
+    return {"noise_mode", "budget_before", "budget_after", "budget_consumed",
+            "modulus_bits_before", "modulus_bits_after", "noise_ms"};
+}
+
+inline std::ostream &operator<<(std::ostream &out, const NoiseSample &n) {
+    out << noise_telemetry_name(n.mode);
+    if (n.mode == NoiseTelemetry::Off) return out << ",,,,,,";
+    return out << "," << n.before << "," << n.after << "," << n.before - n.after << ","
+               << n.modulus_bits_before << "," << n.modulus_bits_after << "," << n.ms;
+}
+
+inline double read_noise_budget(Backend &backend, NoiseTelemetry mode, const Cipher &c) {
+    return mode == NoiseTelemetry::Measured ? backend.noise_budget(c) : backend.estimated_noise_budget(c);
+}
+
+// Readings around out = a op b; b only counts for cipher x cipher ops.
+inline NoiseSample sample_noise(Backend &backend, NoiseTelemetry mode, OpType op, const Cipher &a,
+                                const Cipher &b, const Cipher &out) {
+    NoiseSample sample;
+    sample.mode = mode;
+    if (mode == NoiseTelemetry::Off) return sample;
+    Timer timer;
+    timer.tic();
+    sample.before = read_noise_budget(backend, mode, a);
+    if (!is_plain_op(op)) sample.before = std::min(sample.before, read_noise_budget(backend, mode, b));
+    sample.after = read_noise_budget(backend, mode, out);
+    sample.ms = timer.toc();
+    sample.modulus_bits_before = backend.cipher_modulus_bits(a);
+    sample.modulus_bits_after = backend.cipher_modulus_bits(out);
+    return sample;
+}
+
+} // namespace bench
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "parallel.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Scheduling layer of the NUMA workload. Memory is placed by Linux's
+// default first-touch policy: a pinned thread's fresh allocations land on
+// its own node, so pinning workers and building per-node key replicas
+// (Backend::make_replica) on pinned threads is enough without libnuma.
+
+struct NumaNode {
+    int id = 0;
+    std::vector<int> cpus;  // the ones this process may run on
+};
+
+// Kernel CPU list syntax, e.g. "0-3,8,10-11".
+inline std::vector<int> parse_cpu_list(const std::string &list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        auto dash = range.find('-');
+        int first = std::atoi(range.c_str());
+        int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+inline std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) {
+        for (size_t cpu = 0; cpu < hardware_threads(); cpu++) cpus.push_back(static_cast<int>(cpu));
+    }
+    return cpus;
+}
+
+// Nodes holding at least one allowed CPU, by id, from sysfs. Without node
+// information (non-NUMA kernels, containers) every allowed CPU is node 0.
+inline std::vector<NumaNode> numa_topology() {
+    std::vector<int> allowed = allowed_cpus();
+    std::vector<NumaNode> nodes;
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+            name.find_first_not_of("0123456789", 4) != std::string::npos) {
+            continue;
+        }
+        std::ifstream in(entry.path() / "cpulist");
+        std::string list;
+        std::getline(in, list);
+        NumaNode node;
+        node.id = std::atoi(name.c_str() + 4);
+        for (int cpu : parse_cpu_list(list)) {
+            if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) node.cpus.push_back(cpu);
+        }
+        if (!node.cpus.empty()) nodes.push_back(node);
+    }
+    if (nodes.empty()) {
+        NumaNode node;
+        node.cpus = allowed;
+        nodes.push_back(node);
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const NumaNode &a, const NumaNode &b) { return a.id < b.id; });
+    return nodes;
+}
+
+// How workers are laid out on the machine:
+//   None     unpinned, sharing the original keys (the parallel sweep)
+//   Compact  fill each node's cores before moving to the next
+//   Spread   round-robin over the nodes
+enum class Placement { None, Compact, Spread };
+
+inline const char *placement_name(Placement placement) {
+    switch (placement) {
+    case Placement::None: return "none";
+    case Placement::Compact: return "compact";
+    case Placement::Spread: return "spread";
+    }
+    return "unknown";
+}
+
+inline Placement parse_placement(const std::string &name) {
+    for (auto placement : {Placement::None, Placement::Compact, Placement::Spread}) {
+        if (name == placement_name(placement)) return placement;
+    }
+    throw std::invalid_argument("unknown placement " + name);
+}
+
+// Where one worker runs: a CPU (-1 for unpinned) and the index of its node
+// in the topology.
+struct ThreadSlot {
+    int cpu = -1;
+    size_t node = 0;
+};
+
+// Slots for `threads` workers. More workers than CPUs wrap around.
+inline std::vector<ThreadSlot> place_threads(const std::vector<NumaNode> &nodes, size_t threads,
+                                             Placement placement) {
+    std::vector<ThreadSlot> slots(threads);
+    if (placement == Placement::None) return slots;
+    std::vector<ThreadSlot> order;
+    if (placement == Placement::Compact) {
+        for (size_t n = 0; n < nodes.size(); n++) {
+            for (int cpu : nodes[n].cpus) order.push_back({cpu, n});
+        }
+    } else {
+        size_t widest = 0;
+        for (const auto &node : nodes) widest = std::max(widest, node.cpus.size());
+        for (size_t i = 0; i < widest; i++) {
+            for (size_t n = 0; n < nodes.size(); n++) {
+                if (i < nodes[n].cpus.size()) order.push_back({nodes[n].cpus[i], n});
+            }
+        }
+    }
+    for (size_t i = 0; i < threads; i++) slots[i] = order[i % order.size()];
+    return slots;
+}
+
+inline bool pin_current_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+// run_on_threads() with worker i pinned to slots[i] before fn(i) runs;
+// exceptions from fn are rethrown the same way. A worker that cannot be
+// pinned (its CPU went offline or left the cpuset) still runs fn, so start
+// gates are not left waiting, and a std::runtime_error is thrown after the
+// join.
+template <typename Fn>
+void run_on_placed_threads(const std::vector<ThreadSlot> &slots, Fn &&fn) {
+    std::atomic<int> unpinned{-1};
+    run_on_threads(slots.size(), [&](size_t i) {
+        if (slots[i].cpu >= 0 && !pin_current_thread(slots[i].cpu)) unpinned = slots[i].cpu;
+        fn(i);
+    });
+    if (unpinned >= 0) throw std::runtime_error("could not pin a worker to CPU " + std::to_string(unpinned.load()));
+}
+
+} // namespace bench
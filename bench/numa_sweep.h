@@ -0,0 +1,260 @@
+#pragma once
+
+#include "backend.h"
+#include "numa.h"
+#include "parallel.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+inline ColumnSet numa_sweep_columns() {
+    return keyed_columns(
+        result_columns(concat_columns({
+            {"vector_size", "num_ciphertexts", "operation_type", "placement", "threads", "nodes", "node",
+             "node_threads", "replica_ms", "wall_time_ms", "ciphertexts_per_s", "scaling_efficiency"},
+            stats_columns("chunk"),
+            {"valid"}})),
+        {"vector_size", "num_ciphertexts", "operation_type", "placement", "threads", "node"});
+}
+
+// Key replicas of the current setup, one per NUMA node (null for nodes
+// without one), each built on one of the node's own CPUs so its memory is
+// first touched there. build_ms is the time each took.
+struct NodeReplicas {
+    std::vector<std::unique_ptr<Backend>> backends;
+    std::vector<double> build_ms;
+};
+
+// Replicas for every node that a pinned placement puts one of up to
+// `max_threads` workers on.
+inline NodeReplicas build_node_replicas(const Backend &backend, const std::vector<NumaNode> &nodes,
+                                        const std::vector<Placement> &placements, size_t max_threads) {
+    std::vector<bool> used(nodes.size(), false);
+    for (auto placement : placements) {
+        if (placement == Placement::None) continue;
+        for (const auto &slot : place_threads(nodes, max_threads, placement)) used[slot.node] = true;
+    }
+    NodeReplicas replicas;
+    replicas.backends.resize(nodes.size());
+    replicas.build_ms.assign(nodes.size(), 0);
+    for (size_t n = 0; n < nodes.size(); n++) {
+        if (!used[n]) continue;
+        run_on_placed_threads({ThreadSlot{nodes[n].cpus[0], n}}, [&](size_t) {
+            Timer timer;
+            timer.tic();
+            replicas.backends[n] = backend.make_replica();
+            replicas.build_ms[n] = timer.toc();
+        });
+    }
+    return replicas;
+}
+
+// One (degree, vector_size, op, placement, threads) cell. Workers are
+// pinned per place_threads() and each derives from its node's replica
+// (the backend itself when unpinned or the backend has no replicas).
+// Chunks come from a shared counter as in the parallel sweep. Logs an
+// "all" row plus, when pinned, one row per node, with throughput per
+// thread relative to baseline_per_thread as the scaling efficiency.
+// Returns this cell's ciphertexts/s per thread. A worker that throws or
+// cannot be pinned fails the cell with its error.
+inline double run_numa_cell(Backend &backend, const std::vector<NumaNode> &nodes, const NodeReplicas &replicas,
+                            size_t degree, size_t vector_size, OpType op, Placement placement, size_t threads,
+                            double baseline_per_thread, const TimingConfig &timing, const Dataset &dataset,
+                            CsvLog &log) {
+    size_t slot_count = backend.slot_count();
+    size_t num_ciphertexts = (vector_size + slot_count - 1) / slot_count;
+    uint64_t t = backend.plain_modulus();
+
+    ChunkedOperands inputs(dataset, slot_count);
+
+    std::vector<ThreadSlot> slots = place_threads(nodes, threads, placement);
+    std::vector<size_t> node_threads(nodes.size(), 0);
+    for (const auto &slot : slots) node_threads[slot.node]++;
+
+    std::vector<double> replica_ms(nodes.size(), 0);
+    if (placement != Placement::None) {
+        for (size_t n = 0; n < nodes.size(); n++) {
+            if (node_threads[n]) replica_ms[n] = replicas.build_ms[n];
+        }
+    }
+
+    std::vector<SampleSet> chunk_samples(threads);
+    std::vector<size_t> chunks_done(threads, 0);
+    std::vector<double> finish_ms(threads, 0);
+    std::atomic<size_t> next_chunk{0};
+    std::atomic<bool> valid{true};
+    StartGate gate(threads);
+
+    run_on_placed_threads(slots, [&](size_t tid) {
+        GatePass pass(gate);
+        const auto &replica = replicas.backends[slots[tid].node];
+        const Backend &origin = placement != Placement::None && replica ? *replica : backend;
+        auto worker = origin.make_worker();
+        auto plain_a = worker->make_plain();
+        auto plain_b = worker->make_plain();
+        auto cipher_a = worker->make_cipher();
+        auto cipher_b = worker->make_cipher();
+        auto result = worker->make_cipher();
+        auto decrypted = worker->make_plain();
+        std::vector<uint64_t> decoded;
+
+        worker->encode(inputs.a[0], *plain_a);
+        worker->encode(inputs.b[0], *plain_b);
+        worker->encrypt(*plain_a, *cipher_a);
+        worker->encrypt(*plain_b, *cipher_b);
+        warm_up(timing, [&] { worker->apply(op, *cipher_a, *cipher_b, *plain_b, *result); });
+
+        pass.arrive_and_wait();
+
+        Timer chunk_timer;
+        for (size_t i = next_chunk++; i < num_ciphertexts; i = next_chunk++) {
+            chunk_timer.tic();
+            worker->encode(inputs.a[i], *plain_a);
+            worker->encode(inputs.b[i], *plain_b);
+            worker->encrypt(*plain_a, *cipher_a);
+            if (!is_plain_op(op)) worker->encrypt(*plain_b, *cipher_b);
+            worker->apply(op, *cipher_a, *cipher_b, *plain_b, *result);
+            worker->decrypt(*result, *decrypted);
+            worker->decode(*decrypted, decoded);
+            chunk_samples[tid].add(chunk_timer.toc());
+            chunks_done[tid]++;
+
+            for (size_t j = 0; j < inputs.used[i]; j++) {
+                if (decoded[j] != expected_value(op, inputs.a[i][j], inputs.b[i][j], t)) {
+                    valid = false;
+                    break;
+                }
+            }
+        }
+        finish_ms[tid] = gate.elapsed_ms();
+    });
+    double wall_ms = *std::max_element(finish_ms.begin(), finish_ms.end());
+
+    size_t nodes_used = static_cast<size_t>(std::count_if(node_threads.begin(), node_threads.end(),
+                                                          [](size_t n) { return n > 0; }));
+    auto log_group = [&](const std::string &node, size_t group_threads, double group_replica_ms,
+                         const SampleSet &chunks, size_t group_chunks) {
+        double per_s = group_chunks / (wall_ms / 1000.0);
+        double per_thread = per_s / group_threads;
+        double efficiency = baseline_per_thread > 0 ? per_thread / baseline_per_thread : 1.0;
+        log.row(backend.library(), backend.scheme(), degree, slot_count, vector_size, num_ciphertexts,
+                op_name(op), placement_name(placement), threads, nodes_used, node, group_threads,
+                group_replica_ms, wall_ms, per_s, efficiency, chunks.stats(), valid ? 1 : 0);
+        return per_thread;
+    };
+
+    if (placement != Placement::None) {
+        for (size_t n = 0; n < nodes.size(); n++) {
+            if (!node_threads[n]) continue;
+            SampleSet chunks;
+            size_t done = 0;
+            for (size_t i = 0; i < threads; i++) {
+                if (slots[i].node != n) continue;
+                chunks.merge(chunk_samples[i]);
+                done += chunks_done[i];
+            }
+            double per_thread = log_group(std::to_string(nodes[n].id), node_threads[n], replica_ms[n], chunks, done);
+            std::cout << "    node " << nodes[n].id << ": " << node_threads[n] << " threads, "
+                      << per_thread * node_threads[n] << " ct/s" << std::endl;
+        }
+    }
+    SampleSet chunks;
+    for (const auto &samples : chunk_samples) chunks.merge(samples);
+    double total_replica_ms = 0;
+    for (double ms : replica_ms) total_replica_ms += ms;
+    double per_thread = log_group("all", threads, total_replica_ms, chunks, num_ciphertexts);
+
+    std::cout << "  " << backend.library() << " PolyModulus: " << degree << ", VectorSize: " << vector_size
+              << ", Operation: " << op_name(op) << ", Placement: " << placement_name(placement)
+              << ", Threads: " << threads << " on " << nodes_used << " node(s), Wall: " << wall_ms << " ms"
+              << ", Throughput: " << per_thread * threads << " ct/s"
+              << ", Efficiency: " << (baseline_per_thread > 0 ? per_thread / baseline_per_thread : 1.0)
+              << ", Valid: " << (valid ? "YES" : "NO") << std::endl;
+    return per_thread;
+}
+
+// Thread counts of the NUMA sweep: --threads if given, otherwise powers of
+// two up to every allowed CPU, and all of them.
+inline std::vector<size_t> numa_thread_counts(const std::vector<NumaNode> &nodes,
+                                              const std::vector<long> &requested) {
+    std::vector<size_t> counts;
+    for (long n : requested) {
+        if (n > 0) counts.push_back(static_cast<size_t>(n));
+    }
+    if (counts.empty()) {
+        size_t cpus = 0;
+        for (const auto &node : nodes) cpus += node.cpus.size();
+        for (size_t n = 1; n < cpus; n *= 2) counts.push_back(n);
+        counts.push_back(cpus);
+    }
+    std::sort(counts.begin(), counts.end());
+    counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+    return counts;
+}
+
+// Throughput of every degree x multi-ciphertext vector size x op x
+// placement over the thread counts. Node replicas are built once per
+// degree and shared by its cells. Scaling efficiency is relative to the
+// smallest count of the same placement (one thread by default).
+inline void run_numa_sweep(Backend &backend, const SweepConfig &config, const std::vector<Placement> &placements,
+                           const std::vector<long> &requested_threads, CsvLog &log) {
+    DatasetStore datasets = sweep_datasets(config);
+    datasets.prepare(config.vector_sizes);
+    std::vector<NumaNode> nodes = numa_topology();
+    std::vector<size_t> counts = numa_thread_counts(nodes, requested_threads);
+    std::cout << "NUMA nodes:";
+    for (const auto &node : nodes) std::cout << " " << node.id << " (" << node.cpus.size() << " CPUs)";
+    std::cout << std::endl;
+
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " NUMA PolyModulus=" << degree << " ===" << std::endl;
+        if (!setup_first_working(backend, sweep_candidates(config, degree))) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        if (backend.slot_count() < config.min_slots) {
+            std::cout << "SKIPPING - too few slots" << std::endl;
+            continue;
+        }
+        NodeReplicas replicas;
+        try {
+            replicas = build_node_replicas(backend, nodes, placements, counts.back());
+        } catch (const std::exception &e) {
+            std::cout << "Error with PolyModulus: " << degree << " - " << e.what() << std::endl;
+            continue;
+        }
+        for (auto vector_size : config.vector_sizes) {
+            if (vector_size <= backend.slot_count()) continue;
+            for (auto op : all_ops()) {
+                for (auto placement : placements) {
+                    double baseline = 0;
+                    for (auto threads : counts) {
+                        try {
+                            double per_thread = run_numa_cell(backend, nodes, replicas, degree, vector_size, op,
+                                                              placement, threads, baseline, config.timing,
+                                                              datasets.get(vector_size), log);
+                            if (baseline == 0) baseline = per_thread;
+                        } catch (const std::exception &e) {
+                            std::cout << "Error with PolyModulus: " << degree << ", VectorSize: " << vector_size
+                                      << ", Operation: " << op_name(op)
+                                      << ", Placement: " << placement_name(placement) << ", Threads: " << threads
+                                      << " - " << e.what() << std::endl;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Command-line options of the form --name=value (or bare --name for flags).
+// Unknown names are kept so drivers only look up what they use.
+class Options {
+private:
+    std::map<std::string, std::string> values;
+
+public:
+    Options(int argc, char **argv) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) {
+                std::cerr << "Ignoring argument: " << arg << std::endl;
+                continue;
+            }
+            arg = arg.substr(2);
+            auto eq = arg.find('=');
+            if (eq == std::string::npos) {
+                values[arg] = "1";
+            } else {
+                values[arg.substr(0, eq)] = arg.substr(eq + 1);
+            }
+        }
+    }
+
+    bool has(const std::string &name) const { return values.count(name) > 0; }
+
+    std::string get(const std::string &name, const std::string &fallback = "") const {
+        auto it = values.find(name);
+        return it == values.end() ? fallback : it->second;
+    }
+
+    long get_long(const std::string &name, long fallback) const {
+        auto it = values.find(name);
+        return it == values.end() ? fallback : std::strtol(it->second.c_str(), nullptr, 10);
+    }
+
+    double get_double(const std::string &name, double fallback) const {
+        auto it = values.find(name);
+        return it == values.end() ? fallback : std::strtod(it->second.c_str(), nullptr);
+    }
+
+    // Comma-separated integers, e.g. --threads=1,2,4.
+    std::vector<long> get_list(const std::string &name) const {
+        std::vector<long> list;
+        auto it = values.find(name);
+        if (it == values.end()) return list;
+        std::stringstream ss(it->second);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) list.push_back(std::strtol(item.c_str(), nullptr, 10));
+        }
+        return list;
+    }
+
+    // Comma-separated names, e.g. --key-sets=default,steps.
+    std::vector<std::string> get_strings(const std::string &name) const {
+        std::vector<std::string> list;
+        auto it = values.find(name);
+        if (it == values.end()) return list;
+        std::stringstream ss(it->second);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) list.push_back(item);
+        }
+        return list;
+    }
+
+    bool get_flag(const std::string &name) const {
+        auto it = values.find(name);
+        return it != values.end() && it->second != "0" && it->second != "false";
+    }
+};
+
+} // namespace bench
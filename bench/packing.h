@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace bench {
+
+// Where a run of a user vector lives: `length` elements starting at slot
+// `offset` of ciphertext `cipher`.
+struct Segment {
+    size_t cipher = 0;
+    size_t offset = 0;
+    size_t length = 0;
+};
+
+// Placement of a batch of user vectors in ciphertext slots.
+//
+// packed(): every vector is cut into lanes of one power-of-two width (the
+// longest vector rounded up, at most the largest power of two in a row),
+// and lanes are laid out back to back across the rows of each ciphertext:
+// both batch rows in SEAL, the single slot row in HElib. A lane never
+// straddles rows, so rotations by less than the lane width stay inside it
+// as far as its first slot is concerned, and the reduction steps leave
+// each lane's sum in its first slot. Unused slots are zero.
+//
+// padded(): the original layout, each vector on ceil(length / slot_count)
+// ciphertexts of its own, for comparison.
+class PackedLayout {
+private:
+    size_t slots = 0;
+    size_t width = 0;
+    size_t ciphers = 0;
+    bool lanes = false;
+    std::vector<std::vector<Segment>> placement;
+
+    PackedLayout(size_t slot_count) : slots(slot_count) {}
+
+public:
+    static PackedLayout packed(const std::vector<size_t> &lengths, size_t slot_count, size_t row_size) {
+        if (lengths.empty() || row_size == 0 || slot_count % row_size) {
+            throw std::invalid_argument("packed layout needs vectors and whole rows");
+        }
+        size_t longest = *std::max_element(lengths.begin(), lengths.end());
+        size_t row_width = 1;
+        while (row_width * 2 <= row_size) row_width *= 2;
+        size_t width = 1;
+        while (width < longest && width < row_width) width *= 2;
+
+        PackedLayout layout(slot_count);
+        layout.width = width;
+        layout.lanes = true;
+        size_t lanes_per_row = row_size / width;
+        size_t lanes_per_cipher = lanes_per_row * (slot_count / row_size);
+        size_t lane = 0;
+        for (size_t length : lengths) {
+            std::vector<Segment> segments;
+            for (size_t start = 0; start < length; start += width, lane++) {
+                size_t in_cipher = lane % lanes_per_cipher;
+                Segment s;
+                s.cipher = lane / lanes_per_cipher;
+                s.offset = (in_cipher / lanes_per_row) * row_size + (in_cipher % lanes_per_row) * width;
+                s.length = std::min(width, length - start);
+                segments.push_back(s);
+            }
+            layout.placement.push_back(segments);
+        }
+        layout.ciphers = (lane + lanes_per_cipher - 1) / lanes_per_cipher;
+        return layout;
+    }
+
+    static PackedLayout padded(const std::vector<size_t> &lengths, size_t slot_count) {
+        PackedLayout layout(slot_count);
+        layout.width = slot_count;
+        for (size_t length : lengths) {
+            std::vector<Segment> segments;
+            for (size_t start = 0; start < length; start += slot_count) {
+                Segment s;
+                s.cipher = layout.ciphers++;
+                s.length = std::min(slot_count, length - start);
+                segments.push_back(s);
+            }
+            layout.placement.push_back(segments);
+        }
+        return layout;
+    }
+
+    size_t num_vectors() const { return placement.size(); }
+    size_t num_ciphertexts() const { return ciphers; }
+    size_t slot_count() const { return slots; }
+    size_t lane_width() const { return width; }
+    const std::vector<Segment> &segments(size_t vector) const { return placement[vector]; }
+
+    // Share of the ciphertext slots that hold user data.
+    double utilization() const {
+        size_t used = 0;
+        for (const auto &segments : placement) {
+            for (const auto &s : segments) used += s.length;
+        }
+        return ciphers ? static_cast<double>(used) / (ciphers * slots) : 0;
+    }
+
+    // Whether sum_lanes() leaves every lane's sum in its first slot; only
+    // packed layouts keep lanes inside rotation rows.
+    bool reducible() const { return lanes; }
+
+    // Left rotations whose rotate-and-add sum every lane into its first slot.
+    std::vector<int> reduction_steps() const {
+        std::vector<int> steps;
+        if (!lanes) return steps;
+        for (size_t step = 1; step < width; step *= 2) steps.push_back(static_cast<int>(step));
+        return steps;
+    }
+
+    // Slot vectors, one per ciphertext, holding `vectors` in this layout.
+    void pack(const std::vector<std::vector<uint64_t>> &vectors, std::vector<std::vector<uint64_t>> &out) const {
+        out.assign(ciphers, std::vector<uint64_t>(slots, 0));
+        for (size_t v = 0; v < placement.size(); v++) {
+            size_t start = 0;
+            for (const auto &s : placement[v]) {
+                std::copy(vectors[v].begin() + start, vectors[v].begin() + start + s.length,
+                          out[s.cipher].begin() + s.offset);
+                start += s.length;
+            }
+        }
+    }
+
+    // Inverse of pack() on decoded slot vectors.
+    void unpack(const std::vector<std::vector<uint64_t>> &slot_vectors,
+                std::vector<std::vector<uint64_t>> &out) const {
+        out.assign(placement.size(), {});
+        for (size_t v = 0; v < placement.size(); v++) {
+            for (const auto &s : placement[v]) {
+                const auto &src = slot_vectors[s.cipher];
+                out[v].insert(out[v].end(), src.begin() + s.offset, src.begin() + s.offset + s.length);
+            }
+        }
+    }
+
+    // Per-vector sums mod t from decoded slot vectors after the
+    // reduction_steps() rotate-and-add: the lane sums of each vector added up.
+    std::vector<uint64_t> unpack_sums(const std::vector<std::vector<uint64_t>> &slot_vectors, uint64_t t) const {
+        std::vector<uint64_t> sums(placement.size(), 0);
+        for (size_t v = 0; v < placement.size(); v++) {
+            for (const auto &s : placement[v]) {
+                sums[v] = (sums[v] + slot_vectors[s.cipher][s.offset]) % t;
+            }
+        }
+        return sums;
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "backend.h"
+#include "packing.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+inline ColumnSet packing_sweep_columns() {
+    return keyed_columns(
+        result_columns(concat_columns({
+            {"vector_size", "num_vectors", "layout", "lane_width", "num_ciphertexts", "utilization"},
+            stats_columns("add"),
+            stats_columns("multiply"),
+            stats_columns("sum"),
+            {"multiply_per_vector_ms", "valid"}})),
+        {"vector_size", "num_vectors", "layout", "lane_width"});
+}
+
+// A batch of equal-length vectors, laid out padded and packed (see
+// packing.h), with every ciphertext of the batch added, multiplied and (for
+// packed layouts) reduced to per-vector sums by rotate-and-add. Samples time
+// the whole batch. Validity checks the unpacked products and sums. Vector v
+// of the batch is elements v * vector_size onwards of `dataset`.
+inline void run_packing_cell(Backend &backend, size_t degree, size_t vector_size, const PackedLayout &layout,
+                             const char *layout_name, const TimingConfig &timing, const Dataset &dataset,
+                             CsvLog &log) {
+    size_t slot_count = backend.slot_count();
+    size_t n = layout.num_ciphertexts();
+    uint64_t t = backend.plain_modulus();
+
+    std::vector<std::vector<uint64_t>> vectors_a(layout.num_vectors()), vectors_b(layout.num_vectors());
+    for (size_t v = 0; v < layout.num_vectors(); v++) {
+        dataset.chunk_a(v, vector_size, vectors_a[v]);
+        dataset.chunk_b(v, vector_size, vectors_b[v]);
+    }
+    std::vector<std::vector<uint64_t>> slots_a, slots_b, decoded(n);
+    layout.pack(vectors_a, slots_a);
+    layout.pack(vectors_b, slots_b);
+
+    auto plain = backend.make_plain();
+    std::vector<std::unique_ptr<Cipher>> a, b, result;
+    for (size_t i = 0; i < n; i++) {
+        a.push_back(backend.make_cipher());
+        b.push_back(backend.make_cipher());
+        result.push_back(backend.make_cipher());
+        backend.encode(slots_a[i], *plain);
+        backend.encrypt(*plain, *a[i]);
+        backend.encode(slots_b[i], *plain);
+        backend.encrypt(*plain, *b[i]);
+    }
+    auto tmp = backend.make_cipher();
+    auto decrypt_all = [&] {
+        for (size_t i = 0; i < n; i++) {
+            backend.decrypt(*result[i], *plain);
+            backend.decode(*plain, decoded[i]);
+        }
+    };
+
+    bool valid = true;
+    std::vector<std::vector<uint64_t>> unpacked;
+    auto check = [&](bool multiply) {
+        decrypt_all();
+        layout.unpack(decoded, unpacked);
+        for (size_t v = 0; v < unpacked.size() && valid; v++) {
+            for (size_t j = 0; j < unpacked[v].size() && valid; j++) {
+                OpType op = multiply ? OpType::CipherMulCipher : OpType::CipherAddCipher;
+                valid = unpacked[v][j] == expected_value(op, vectors_a[v][j], vectors_b[v][j], t);
+            }
+        }
+    };
+
+    Stats add_stats = measure(timing, [&] {
+        for (size_t i = 0; i < n; i++) backend.add(*a[i], *b[i], *result[i]);
+    });
+    check(false);
+    Stats multiply_stats = measure(timing, [&] {
+        for (size_t i = 0; i < n; i++) backend.multiply(*a[i], *b[i], *result[i]);
+    });
+    check(true);
+
+    // One-slot lanes are their own sums.
+    Stats sum_stats;
+    if (layout.reducible() && layout.lane_width() > 1) {
+        sum_stats = measure(timing, [&] {
+            for (size_t i = 0; i < n; i++) rotate_and_sum(backend, *a[i], layout.lane_width(), *result[i], *tmp);
+        });
+        decrypt_all();
+        std::vector<uint64_t> sums = layout.unpack_sums(decoded, t);
+        for (size_t v = 0; v < sums.size() && valid; v++) {
+            uint64_t expected = 0;
+            for (auto x : vectors_a[v]) expected = (expected + x) % t;
+            valid = sums[v] == expected;
+        }
+    }
+
+    double per_vector_ms = multiply_stats.median_ms / layout.num_vectors();
+    log.row(backend.library(), backend.scheme(), degree, slot_count, vector_size, layout.num_vectors(),
+            layout_name, layout.lane_width(), n, layout.utilization(),
+            add_stats, multiply_stats, sum_stats, per_vector_ms, valid ? 1 : 0);
+    std::cout << "  VectorSize: " << vector_size << " x" << layout.num_vectors() << ", " << layout_name
+              << ": " << n << " ciphertexts, " << static_cast<int>(layout.utilization() * 100) << "% used"
+              << ", Add: " << add_stats.median_ms << " ms, Multiply: " << multiply_stats.median_ms << " ms";
+    if (layout.reducible()) std::cout << ", Sum: " << sum_stats.median_ms << " ms";
+    std::cout << (valid ? "" : ", INVALID") << std::endl;
+}
+
+// Padded versus packed layouts of config.packed_vectors vectors at every
+// degree and vector size. Candidates get Galois keys for the reductions
+// unless the workload declared its rotations.
+inline void run_packing_sweep(Backend &backend, const SweepConfig &config, CsvLog &log) {
+    DatasetStore datasets = sweep_datasets(config);
+    std::vector<size_t> batch_sizes;
+    for (auto vector_size : config.vector_sizes) batch_sizes.push_back(config.packed_vectors * vector_size);
+    datasets.prepare(batch_sizes);
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " packing PolyModulus=" << degree << " ===" << std::endl;
+        std::vector<ParamSet> candidates = sweep_candidates(config, degree);
+        for (auto &params : candidates) params.galois_keys = true;
+        if (!setup_first_working(backend, candidates)) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        for (auto vector_size : config.vector_sizes) {
+            std::vector<size_t> lengths(config.packed_vectors, vector_size);
+            const Dataset &batch = datasets.get(config.packed_vectors * vector_size);
+            try {
+                run_packing_cell(backend, degree, vector_size, PackedLayout::padded(lengths, backend.slot_count()),
+                                 "padded", config.timing, batch, log);
+                run_packing_cell(backend, degree, vector_size,
+                                 PackedLayout::packed(lengths, backend.slot_count(), backend.row_size()),
+                                 "packed", config.timing, batch, log);
+            } catch (const std::exception &e) {
+                std::cout << "Error with PolyModulus: " << degree << ", VectorSize: " << vector_size
+                          << " - " << e.what() << std::endl;
+            }
+        }
+    }
+}
+
+} // namespace bench
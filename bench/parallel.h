@@ -0,0 +1,109 @@
+#pragma once
+
+#include "timer.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+// Runs fn(thread_index) on `threads` threads and waits for all of them.
+// Benchmark cells are seconds long, so spawning per cell costs nothing
+// measurable and keeps every cell's threads independent. An exception
+// thrown by fn is rethrown here once every thread has finished (the
+// lowest thread index's, if several threw), so the cell's caller sees it.
+template <typename Fn>
+void run_on_threads(size_t threads, Fn &&fn) {
+    std::vector<std::thread> pool;
+    std::vector<std::exception_ptr> errors(threads);
+    pool.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        pool.emplace_back([&fn, &errors, i] {
+            try {
+                fn(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto &t : pool) {
+        t.join();
+    }
+    for (auto &error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+}
+
+// Holds workers until all of them have finished their per-thread setup, so
+// that setup stays out of the timed region. The wall clock starts when the
+// last participant arrives. Workers hold a GatePass so that one failing
+// during setup still counts as arrived.
+class StartGate {
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t waiting;
+    bool open = false;
+    Timer timer;
+
+public:
+    explicit StartGate(size_t participants) : waiting(participants) {}
+
+    void arrive_and_wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (--waiting == 0) {
+            open = true;
+            timer.tic();
+            cv.notify_all();
+            return;
+        }
+        cv.wait(lock, [this] { return open; });
+    }
+
+    // Counts as arrived without waiting, for a participant that gives up.
+    void leave() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--waiting == 0) {
+            open = true;
+            timer.tic();
+            cv.notify_all();
+        }
+    }
+
+    // Milliseconds since the gate opened.
+    double elapsed_ms() const { return timer.toc(); }
+};
+
+// One participant's arrival at a StartGate: arrive_and_wait() in the normal
+// course, or leave() on destruction if that never happened, so a worker
+// whose setup throws does not hold the others at the gate forever.
+class GatePass {
+private:
+    StartGate &gate;
+    bool arrived = false;
+
+public:
+    explicit GatePass(StartGate &gate) : gate(gate) {}
+    GatePass(const GatePass &) = delete;
+    GatePass &operator=(const GatePass &) = delete;
+    ~GatePass() {
+        if (!arrived) gate.leave();
+    }
+
+    void arrive_and_wait() {
+        arrived = true;
+        gate.arrive_and_wait();
+    }
+};
+
+// Default worker count when --threads is given without a value.
+inline size_t hardware_threads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+} // namespace bench
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "backend.h"
+#include "memory.h"
+#include "parallel.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace bench {
+
+inline ColumnSet parallel_sweep_columns() {
+    return keyed_columns(
+        result_columns(concat_columns({
+            {"vector_size", "num_ciphertexts", "operation_type", "alloc_mode", "threads",
+             "wall_time_ms", "elements_per_s", "ciphertexts_per_s"},
+            stats_columns("chunk"),
+            stats_columns("operation"),
+            {"valid"}})),
+        {"vector_size", "num_ciphertexts", "operation_type", "alloc_mode", "threads"});
+}
+
+// One (degree, vector_size, op, threads) cell. Chunks are handed out from a
+// shared counter, so faster threads take more of them. Each thread works
+// through its own worker backend (own encryptor/evaluator, thread-local
+// memory pool). "chunk" samples are the end-to-end latency of one chunk:
+// encode, encrypt, op, decrypt and decode. With AllocMode::Fresh every
+// chunk allocates its ciphertexts (the op's output inside the op timer);
+// with Arena each worker reserves them in a pool of its own.
+inline void run_parallel_cell(Backend &backend, size_t degree, size_t vector_size, OpType op,
+                              AllocMode alloc, size_t threads, const TimingConfig &timing,
+                              const Dataset &dataset, CsvLog &log) {
+    size_t slot_count = backend.slot_count();
+    size_t num_ciphertexts = (vector_size + slot_count - 1) / slot_count;
+    uint64_t t = backend.plain_modulus();
+
+    // The op sweep's chunks of the same vector, split before the clock.
+    ChunkedOperands inputs(dataset, slot_count);
+
+    std::vector<SampleSet> chunk_samples(threads), operation_samples(threads);
+    std::vector<double> finish_ms(threads, 0);
+    std::atomic<size_t> next_chunk{0};
+    std::atomic<bool> valid{true};
+    StartGate gate(threads);
+
+    // A worker that throws (at setup or on a chunk) fails the cell: the
+    // others finish their chunks and run_on_threads rethrows its error.
+    run_on_threads(threads, [&](size_t tid) {
+        GatePass pass(gate);
+        auto worker = backend.make_worker();
+        std::unique_ptr<ArenaScope> arena;
+        if (alloc == AllocMode::Arena) arena = std::make_unique<ArenaScope>(*worker, ArenaCipherPolys);
+        auto plain_a = worker->make_plain();
+        auto plain_b = worker->make_plain();
+        auto cipher_a = worker->make_cipher();
+        auto cipher_b = worker->make_cipher();
+        auto result = worker->make_cipher();
+        auto decrypted = worker->make_plain();
+        std::vector<uint64_t> decoded;
+
+        // Warm the worker's pool and caches on the first chunk's data.
+        worker->encode(inputs.a[0], *plain_a);
+        worker->encode(inputs.b[0], *plain_b);
+        worker->encrypt(*plain_a, *cipher_a);
+        worker->encrypt(*plain_b, *cipher_b);
+        warm_up(timing, [&] { worker->apply(op, *cipher_a, *cipher_b, *plain_b, *result); });
+
+        pass.arrive_and_wait();
+
+        Timer chunk_timer, op_timer;
+        for (size_t i = next_chunk++; i < num_ciphertexts; i = next_chunk++) {
+            chunk_timer.tic();
+            if (alloc == AllocMode::Fresh) {
+                cipher_a = worker->make_cipher();
+                cipher_b = worker->make_cipher();
+                decrypted = worker->make_plain();
+            }
+            worker->encode(inputs.a[i], *plain_a);
+            worker->encode(inputs.b[i], *plain_b);
+            worker->encrypt(*plain_a, *cipher_a);
+            if (!is_plain_op(op)) {
+                worker->encrypt(*plain_b, *cipher_b);
+            }
+
+            op_timer.tic();
+            if (alloc == AllocMode::Fresh) result = worker->make_cipher();
+            worker->apply(op, *cipher_a, *cipher_b, *plain_b, *result);
+            operation_samples[tid].add(op_timer.toc());
+
+            worker->decrypt(*result, *decrypted);
+            worker->decode(*decrypted, decoded);
+            chunk_samples[tid].add(chunk_timer.toc());
+
+            for (size_t j = 0; j < inputs.used[i]; j++) {
+                if (decoded[j] != expected_value(op, inputs.a[i][j], inputs.b[i][j], t)) {
+                    valid = false;
+                    break;
+                }
+            }
+        }
+        finish_ms[tid] = gate.elapsed_ms();
+    });
+    // Wall time runs to the last chunk's completion, not the threads' exit.
+    double wall_ms = *std::max_element(finish_ms.begin(), finish_ms.end());
+
+    SampleSet chunks, operations;
+    for (size_t i = 0; i < threads; i++) {
+        chunks.merge(chunk_samples[i]);
+        operations.merge(operation_samples[i]);
+    }
+    Stats chunk_stats = chunks.stats();
+    Stats operation_stats = operations.stats();
+    double elements_per_s = vector_size / (wall_ms / 1000.0);
+    double ciphertexts_per_s = num_ciphertexts / (wall_ms / 1000.0);
+
+    log.row(backend.library(), backend.scheme(), degree, slot_count,
+            vector_size, num_ciphertexts, op_name(op), alloc_mode_name(alloc), threads,
+            wall_ms, elements_per_s, ciphertexts_per_s,
+            chunk_stats, operation_stats, valid ? 1 : 0);
+
+    std::cout << backend.library() << " PolyModulus: " << degree
+              << ", VectorSize: " << vector_size
+              << ", Operation: " << op_name(op)
+              << ", Alloc: " << alloc_mode_name(alloc)
+              << ", Threads: " << threads
+              << ", Wall: " << wall_ms << " ms"
+              << ", Throughput: " << elements_per_s << " elem/s"
+              << ", Chunk p50/p99: " << chunk_stats.median_ms << "/" << chunk_stats.p99_ms << " ms"
+              << ", Valid: " << (valid ? "YES" : "NO") << std::endl;
+}
+
+// Every degree x multi-ciphertext vector size x op x thread count. Vector
+// sizes that fit in one ciphertext are skipped: there is nothing to spread.
+inline void run_parallel_sweep(Backend &backend, const SweepConfig &config,
+                               const std::vector<size_t> &thread_counts, CsvLog &log) {
+    DatasetStore datasets = sweep_datasets(config);
+    datasets.prepare(config.vector_sizes);
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " Parallel PolyModulus=" << degree << " ===" << std::endl;
+        if (!setup_first_working(backend, sweep_candidates(config, degree))) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        if (backend.slot_count() < config.min_slots) {
+            std::cout << "SKIPPING - too few slots" << std::endl;
+            continue;
+        }
+        for (auto vector_size : config.vector_sizes) {
+            if (vector_size <= backend.slot_count()) continue;
+            for (auto op : all_ops()) {
+                for (auto alloc : config.alloc_modes) {
+                    for (auto threads : thread_counts) {
+                        try {
+                            run_parallel_cell(backend, degree, vector_size, op, alloc, threads, config.timing,
+                                              datasets.get(vector_size), log);
+                        } catch (const std::exception &e) {
+                            std::cout << "Error with PolyModulus: " << degree
+                                      << ", VectorSize: " << vector_size
+                                      << ", Operation: " << op_name(op)
+                                      << ", Alloc: " << alloc_mode_name(alloc)
+                                      << ", Threads: " << threads
+                                      << " - " << e.what() << std::endl;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "backend.h"
+#include "depth.h"
+#include "options.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// What the parameters have to support.
+struct SearchTarget {
+    int depth = 4;           // ciphertext x ciphertext multiplications in sequence
+    int plain_bits = 20;     // plaintext modulus size
+    int security_bits = 128;
+};
+
+struct SearchConfig {
+    SearchTarget target;
+    std::vector<size_t> poly_modulus_degrees;
+
+    // Candidate parameter sets for one degree.
+    std::function<std::vector<ParamSet>(size_t, const SearchTarget &)> candidates;
+
+    // Depth probes stop here, so depths above it are reported as max_depth.
+    // 0 selects target.depth + 2.
+    int max_depth = 0;
+
+    // Candidates are only benchmarked briefly.
+    TimingConfig timing{1, 5, false};
+};
+
+// Search options on top of the timing ones:
+//   --depth=N --plain-bits=N --security=N  the target (default 4 / 20 / 128)
+//   --degrees=a,b,...                      degrees (or HElib m) to search
+//   --max-depth=N                          depth probe cap
+inline void apply_options(SearchConfig &config, const Options &options) {
+    apply_timing_options(config.timing, options);
+    config.target.depth = static_cast<int>(options.get_long("depth", config.target.depth));
+    config.target.plain_bits = static_cast<int>(options.get_long("plain-bits", config.target.plain_bits));
+    config.target.security_bits = static_cast<int>(options.get_long("security", config.target.security_bits));
+    config.max_depth = static_cast<int>(options.get_long("max-depth", config.max_depth));
+    auto degrees = options.get_list("degrees");
+    if (!degrees.empty()) {
+        config.poly_modulus_degrees.assign(degrees.begin(), degrees.end());
+    }
+}
+
+// One benchmarked candidate.
+struct SearchResult {
+    ParamSet params;
+    size_t slot_count = 0;
+    uint64_t plain_modulus = 0;
+    int modulus_bits = 0;
+    double security_level = 0;  // as the backend reports it, not the target
+    double setup_ms = 0;
+    int depth = 0;
+    size_t ciphertext_bytes = 0;
+    Stats multiply;
+    bool meets_target = false;
+    bool pareto = false;
+};
+
+// b is at least as good as a in every objective (latency, ciphertext size,
+// depth) and strictly better in one.
+inline bool dominates(const SearchResult &b, const SearchResult &a) {
+    bool no_worse = b.multiply.median_ms <= a.multiply.median_ms &&
+                    b.ciphertext_bytes <= a.ciphertext_bytes && b.depth >= a.depth;
+    bool better = b.multiply.median_ms < a.multiply.median_ms ||
+                  b.ciphertext_bytes < a.ciphertext_bytes || b.depth > a.depth;
+    return no_worse && better;
+}
+
+// Marks the non-dominated results among those that meet the target.
+inline void mark_pareto(std::vector<SearchResult> &results) {
+    for (auto &a : results) {
+        if (!a.meets_target) continue;
+        a.pareto = std::none_of(results.begin(), results.end(), [&](const SearchResult &b) {
+            return b.meets_target && dominates(b, a);
+        });
+    }
+}
+
+inline ColumnSet param_search_columns() {
+    return keyed_columns(
+        result_columns(concat_columns({
+            {"coeff_modulus_bits", "modulus_bits", "plain_modulus", "helib_bits", "helib_c",
+             "security_bits", "setup_ms", "depth", "ciphertext_bytes"},
+            stats_columns("multiply"),
+            {"meets_target", "pareto"}})),
+        {"coeff_modulus_bits", "modulus_bits", "plain_modulus", "helib_bits", "helib_c"});
+}
+
+// Sets up one candidate and measures its depth, fresh-ciphertext size and
+// relinearized multiply latency. Returns false if the backend rejects it.
+inline bool evaluate_candidate(Backend &backend, const ParamSet &params, int max_depth,
+                               const TimingConfig &timing, SearchResult &result) {
+    if (!backend.setup(params)) return false;
+    result.params = params;
+    result.slot_count = backend.slot_count();
+    result.plain_modulus = backend.plain_modulus();
+    result.modulus_bits = backend.modulus_bits();
+    result.security_level = backend.security_level();
+    result.setup_ms = backend.last_setup_ms();
+
+    std::vector<uint64_t> values(result.slot_count, 3);
+    auto plain = backend.make_plain();
+    auto a = backend.make_cipher();
+    auto b = backend.make_cipher();
+    auto product = backend.make_cipher();
+    backend.encode(values, *plain);
+    backend.encrypt(*plain, *a);
+    backend.encrypt(*plain, *b);
+    result.ciphertext_bytes = backend.cipher_bytes(*a);
+    result.multiply = measure(timing, [&] { backend.multiply(*a, *b, *product); });
+
+    result.depth = probe_mul_depth(backend, max_depth).operations;
+    return true;
+}
+
+// Benchmarks every candidate of every degree, then logs all of them with
+// the Pareto-optimal ones (latency, ciphertext size, depth) flagged among
+// those reaching the target depth. Returns the Pareto set, fastest first.
+inline std::vector<SearchResult> run_param_search(Backend &backend, const SearchConfig &config, CsvLog &log) {
+    int max_depth = config.max_depth ? config.max_depth : config.target.depth + 2;
+    std::vector<SearchResult> results;
+
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " parameter search, degree " << degree
+                  << ", depth >= " << config.target.depth << " ===" << std::endl;
+        for (const auto &params : config.candidates(degree, config.target)) {
+            std::cout << "  " << params.describe() << " ... ";
+            SearchResult result;
+            try {
+                if (!evaluate_candidate(backend, params, max_depth, config.timing, result)) {
+                    std::cout << "REJECTED" << std::endl;
+                    continue;
+                }
+            } catch (const std::exception &e) {
+                std::cout << "FAILED - " << e.what() << std::endl;
+                continue;
+            }
+            result.meets_target = result.depth >= config.target.depth;
+            std::cout << "depth " << result.depth << ", multiply " << result.multiply.median_ms
+                      << " ms, ciphertext " << result.ciphertext_bytes / 1024 << " KB" << std::endl;
+            results.push_back(result);
+        }
+    }
+
+    mark_pareto(results);
+    std::vector<SearchResult> front;
+    for (const auto &r : results) {
+        log.row(backend.library(), backend.scheme(), r.params.poly_modulus_degree, r.slot_count,
+                coeff_modulus_string(r.params), r.modulus_bits, r.plain_modulus,
+                r.params.helib_bits, r.params.helib_c, r.security_level,
+                r.setup_ms, r.depth, r.ciphertext_bytes, r.multiply,
+                r.meets_target ? 1 : 0, r.pareto ? 1 : 0);
+        if (r.pareto) front.push_back(r);
+    }
+    std::sort(front.begin(), front.end(), [](const SearchResult &a, const SearchResult &b) {
+        return a.multiply.median_ms < b.multiply.median_ms;
+    });
+
+    std::cout << "\nPareto-optimal parameters (" << front.size() << "):" << std::endl;
+    for (const auto &r : front) {
+        std::cout << "  " << r.params.describe() << " q=" << r.modulus_bits << " bits"
+                  << ", depth " << r.depth << ", multiply " << r.multiply.median_ms << " ms"
+                  << ", ciphertext " << r.ciphertext_bytes / 1024 << " KB" << std::endl;
+    }
+    return front;
+}
+
+} // namespace bench
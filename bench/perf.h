@@ -0,0 +1,217 @@
+#pragma once
+
+#include "timer.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Hardware counters of one thread, read as one perf_event_open group so the
+// values come from the same interval:
+//   cycles, instructions  IPC
+//   llc_misses            last-level cache misses (PERF_COUNT_HW_CACHE_MISSES)
+//   avx512                optional raw event counting cycles spent with the
+//                         core at its AVX-512 frequency license; only as
+//                         good as the event code for the CPU model
+// Counts are scaled by time_enabled / time_running when the kernel had to
+// multiplex the group. Where perf events are unavailable (paranoid level,
+// containers, non-Linux), available() is false and every read is zero.
+struct CounterValues {
+    double cycles = 0;
+    double instructions = 0;
+    double llc_misses = 0;
+    double avx512 = 0;
+
+    CounterValues &operator+=(const CounterValues &o) {
+        cycles += o.cycles;
+        instructions += o.instructions;
+        llc_misses += o.llc_misses;
+        avx512 += o.avx512;
+        return *this;
+    }
+    CounterValues operator-(const CounterValues &o) const {
+        CounterValues d;
+        d.cycles = cycles - o.cycles;
+        d.instructions = instructions - o.instructions;
+        d.llc_misses = llc_misses - o.llc_misses;
+        d.avx512 = avx512 - o.avx512;
+        return d;
+    }
+};
+
+// CORE_POWER.LVL2_TURBO_LICENSE (event 0x28, umask 0x20) on Skylake-SP,
+// Cascade Lake and Ice Lake server cores.
+constexpr uint64_t Avx512LicenseEvent = 0x2028;
+
+// Avx512LicenseEvent on the cores it is defined for (Intel family 6, models
+// 0x55 Skylake-SP / Cascade Lake / Cooper Lake, 0x6a and 0x6c Ice Lake-SP),
+// 0 elsewhere: the same raw code counts something unrelated on other
+// models and vendors.
+inline uint64_t default_avx512_event() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx)) return 0;
+    // "GenuineIntel" in ebx, edx, ecx.
+    if (ebx != 0x756e6547 || edx != 0x49656e69 || ecx != 0x6c65746e) return 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return 0;
+    unsigned family = (eax >> 8) & 0xf;
+    unsigned model = ((eax >> 4) & 0xf) | (((eax >> 16) & 0xf) << 4);
+    if (family == 6 && (model == 0x55 || model == 0x6a || model == 0x6c)) return Avx512LicenseEvent;
+#endif
+    return 0;
+}
+
+class PerfCounters {
+private:
+    int leader = -1;
+    std::vector<int> fds;
+    bool has_avx512 = false;
+
+    static int open_event(uint32_t type, uint64_t config, int group) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = group < 0 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+
+public:
+    // Opens the group on the calling thread; avx512_event 0 leaves it out.
+    explicit PerfCounters(uint64_t avx512_event = 0) {
+        leader = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+        if (leader < 0) return;
+        fds.push_back(leader);
+        for (uint64_t config : {PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES}) {
+            int fd = open_event(PERF_TYPE_HARDWARE, config, leader);
+            if (fd < 0) {
+                close_all();
+                return;
+            }
+            fds.push_back(fd);
+        }
+        if (avx512_event) {
+            int fd = open_event(PERF_TYPE_RAW, avx512_event, leader);
+            if (fd >= 0) {
+                fds.push_back(fd);
+                has_avx512 = true;
+            }
+        }
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+    ~PerfCounters() { close_all(); }
+
+    bool available() const { return leader >= 0; }
+    bool avx512_available() const { return has_avx512; }
+
+    // Counts since the group was opened.
+    CounterValues read() const {
+        CounterValues v;
+        if (leader < 0) return v;
+        uint64_t buf[3 + 4] = {};
+        if (::read(leader, buf, sizeof(buf)) < static_cast<ssize_t>((3 + fds.size()) * sizeof(uint64_t))) return v;
+        double scale = buf[2] ? static_cast<double>(buf[1]) / static_cast<double>(buf[2]) : 1.0;
+        v.cycles = buf[3] * scale;
+        v.instructions = buf[4] * scale;
+        v.llc_misses = buf[5] * scale;
+        if (has_avx512) v.avx512 = buf[6] * scale;
+        return v;
+    }
+
+private:
+    void close_all() {
+        for (int fd : fds) ::close(fd);
+        fds.clear();
+        leader = -1;
+        has_avx512 = false;
+    }
+};
+
+// Time and counters accumulated by the ProfileScopes of one name.
+struct ScopeTotals {
+    size_t calls = 0;
+    double ms = 0;
+    CounterValues counters;
+};
+
+// Collects ProfileScopes on the thread that created it, while it lives.
+// Scopes nest; each name's totals are inclusive of the scopes inside it.
+class Profiler {
+private:
+    PerfCounters counters;
+    std::map<std::string, ScopeTotals> scopes;
+    Profiler *previous;
+
+    static Profiler *&active_slot() {
+        thread_local Profiler *active = nullptr;
+        return active;
+    }
+
+public:
+    explicit Profiler(uint64_t avx512_event = 0) : counters(avx512_event), previous(active_slot()) {
+        active_slot() = this;
+    }
+    Profiler(const Profiler &) = delete;
+    Profiler &operator=(const Profiler &) = delete;
+    ~Profiler() { active_slot() = previous; }
+
+    static Profiler *active() { return active_slot(); }
+
+    const PerfCounters &perf() const { return counters; }
+    CounterValues read() const { return counters.read(); }
+
+    void record(const char *name, double ms, const CounterValues &delta) {
+        ScopeTotals &t = scopes[name];
+        t.calls++;
+        t.ms += ms;
+        t.counters += delta;
+    }
+
+    void reset() { scopes.clear(); }
+    const std::map<std::string, ScopeTotals> &totals() const { return scopes; }
+};
+
+// Marks a stretch of backend code (an NTT, a key switch, ...) for the
+// thread's active Profiler. Without one it costs a thread-local load.
+class ProfileScope {
+private:
+    Profiler *profiler;
+    const char *name;
+    CounterValues start_counters;
+    Timer timer;
+
+public:
+    explicit ProfileScope(const char *name) : profiler(Profiler::active()), name(name) {
+        if (!profiler) return;
+        start_counters = profiler->read();
+        timer.tic();
+    }
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+    ~ProfileScope() {
+        if (!profiler) return;
+        double ms = timer.toc();
+        profiler->record(name, ms, profiler->read() - start_counters);
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "backend.h"
+#include "perf.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+inline ColumnSet perf_sweep_columns() {
+    return keyed_columns(
+        result_columns(
+            {"operation", "scope", "counters", "calls_per_op", "time_ms", "time_share_pct", "call_cycles",
+             "call_instructions", "ipc_ratio", "call_llc_misses", "llc_mpki", "avx512_cycle_share"}),
+        {"operation", "scope"});
+}
+
+// One "total" row for the whole call, then one per profile scope the
+// backend entered inside it, all per call: time (the median for the total,
+// the mean for scopes), its share of the total, and the counters. Counter
+// fields are empty where perf events are unavailable, the AVX-512 share
+// where its raw event is.
+inline void log_perf_rows(Backend &backend, size_t degree, const char *operation, const Profiler &profiler,
+                          int calls, const Stats &stats, const ScopeTotals &total, CsvLog &log) {
+    const PerfCounters &perf = profiler.perf();
+    const char *counters = perf.available() ? "perf_event" : "unavailable";
+    auto row = [&](const std::string &scope, const ScopeTotals &t, double ms) {
+        const CounterValues &c = t.counters;
+        std::string cycles, instructions, ipc, misses, mpki, avx512;
+        if (perf.available()) {
+            cycles = std::to_string(c.cycles / calls);
+            instructions = std::to_string(c.instructions / calls);
+            ipc = c.cycles ? std::to_string(c.instructions / c.cycles) : "";
+            misses = std::to_string(c.llc_misses / calls);
+            mpki = c.instructions ? std::to_string(1000 * c.llc_misses / c.instructions) : "";
+            if (perf.avx512_available() && c.cycles) avx512 = std::to_string(c.avx512 / c.cycles);
+        }
+        double share = stats.median_ms ? 100 * ms / stats.median_ms : 0;
+        log.row(backend.library(), backend.scheme(), degree, backend.slot_count(), operation, scope, counters,
+                static_cast<double>(t.calls) / calls, ms, share, cycles, instructions, ipc, misses, mpki, avx512);
+    };
+    row("total", total, stats.median_ms);
+    std::cout << "  " << operation << ": " << stats.median_ms << " ms";
+    if (perf.available() && total.counters.cycles) {
+        std::cout << ", IPC " << total.counters.instructions / total.counters.cycles << ", LLC misses "
+                  << total.counters.llc_misses / calls;
+    }
+    for (const auto &scope : profiler.totals()) {
+        double ms = scope.second.ms / calls;
+        row(scope.first, scope.second, ms);
+        std::cout << ", " << scope.first << " " << ms << " ms";
+    }
+    std::cout << std::endl;
+}
+
+// Profiles `iterations` calls of fn after the warm-up, each after an untimed
+// prepare(), and logs them with log_perf_rows().
+inline void profile_call(Backend &backend, size_t degree, const char *operation, const TimingConfig &timing,
+                         uint64_t avx512_event, const std::function<void()> &prepare,
+                         const std::function<void()> &fn, CsvLog &log) {
+    for (int i = 0; i < timing.warmup; i++) {
+        prepare();
+        fn();
+    }
+    Profiler profiler(avx512_event);
+    SampleSet samples;
+    ScopeTotals total;
+    Timer timer;
+    for (int i = 0; i < timing.iterations; i++) {
+        prepare();
+        CounterValues before = profiler.read();
+        timer.tic();
+        fn();
+        double ms = timer.toc();
+        total.counters += profiler.read() - before;
+        total.ms += ms;
+        total.calls++;
+        samples.add(ms);
+    }
+    log_perf_rows(backend, degree, operation, profiler, timing.iterations, samples.stats(), total, log);
+}
+
+// Hardware counters and profile-scope breakdown of every basic operation on
+// one full ciphertext at each degree: ENCODE, ENCRYPT, the element-wise ops,
+// ROTATE_LEFT_1, MOD_SWITCH and DECRYPT. The backends mark their NTTs
+// ("ntt"), tensor products ("tensor"), key switches of relinearization and
+// rotation ("key_switch") and modulus drops ("mod_switch"), at the
+// granularity of the library calls they make; work a library does inside
+// one call (SEAL's base conversions inside multiply, say) is charged to
+// the scope around that call. Counters cover the profiling thread only.
+inline void run_perf_sweep(Backend &backend, const SweepConfig &config, uint64_t avx512_event, CsvLog &log) {
+    OperandSource source(config);
+    const TimingConfig &timing = config.timing;
+
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " perf counters PolyModulus=" << degree << " ===" << std::endl;
+        std::vector<ParamSet> candidates = sweep_candidates(config, degree);
+        for (auto &params : candidates) params.galois_keys = true;
+        if (!setup_first_working(backend, candidates)) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        size_t slot_count = backend.slot_count();
+
+        std::vector<uint64_t> data_a, data_b;
+        source.fill_a(data_a, slot_count, slot_count);
+        source.fill_b(data_b, slot_count, slot_count);
+        auto plain_a = backend.make_plain();
+        auto plain_b = backend.make_plain();
+        auto a = backend.make_cipher();
+        auto b = backend.make_cipher();
+        auto out = backend.make_cipher();
+        auto work = backend.make_cipher();
+        backend.encode(data_a, *plain_a);
+        backend.encode(data_b, *plain_b);
+        backend.encrypt(*plain_a, *a);
+        backend.encrypt(*plain_b, *b);
+
+        auto nothing = [] {};
+        auto profile = [&](const char *operation, const std::function<void()> &prepare,
+                           const std::function<void()> &fn) {
+            try {
+                profile_call(backend, degree, operation, timing, avx512_event, prepare, fn, log);
+            } catch (const std::exception &e) {
+                std::cout << "Error with PolyModulus: " << degree << ", Operation: " << operation << " - "
+                          << e.what() << std::endl;
+            }
+        };
+
+        profile("ENCODE", nothing, [&] { backend.encode(data_b, *plain_b); });
+        profile("ENCRYPT", nothing, [&] { backend.encrypt(*plain_a, *out); });
+        for (OpType op : all_ops()) {
+            profile(op_name(op), nothing, [&] { backend.apply(op, *a, *b, *plain_b, *out); });
+        }
+        profile("ROTATE_LEFT_1", nothing, [&] { backend.rotate(*a, 1, *out); });
+        profile("MOD_SWITCH", [&] { backend.copy_cipher(*a, *work); }, [&] { backend.mod_switch(*work); });
+        profile("DECRYPT", nothing, [&] { backend.decrypt(*a, *plain_a); });
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,276 @@
+#pragma once
+
+#include "backend.h"
+#include "parallel.h"
+#include "pipeline.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+enum PipelineStage { StageEncode, StageEncrypt, StageEvaluate, StageDecrypt, StageCount };
+
+inline const char *stage_name(size_t stage) {
+    static const char *names[StageCount] = {"encode", "encrypt", "evaluate", "decrypt"};
+    return names[stage];
+}
+
+struct PipelineConfig {
+    // Worker threads per stage, indexed by PipelineStage.
+    size_t stage_threads[StageCount] = {1, 1, 1, 1};
+
+    // Capacity of each queue between two stages.
+    size_t queue_depth = 4;
+
+    // Stream at least this many ciphertexts by cycling over the vector's
+    // chunks; 0 streams each chunk once.
+    size_t min_ciphertexts = 0;
+
+    size_t total_threads() const {
+        size_t n = 0;
+        for (size_t s = 0; s < StageCount; s++) n += stage_threads[s];
+        return n;
+    }
+
+    std::string describe() const {
+        std::ostringstream ss;
+        for (size_t s = 0; s < StageCount; s++) {
+            ss << stage_threads[s];
+            if (s < StageCount - 1) ss << "-";
+        }
+        return ss.str();
+    }
+};
+
+inline ColumnSet pipeline_sweep_columns() {
+    std::vector<std::string> utilization;
+    for (size_t s = 0; s < StageCount; s++) {
+        utilization.push_back(std::string(stage_name(s)) + "_utilization");
+    }
+    return keyed_columns(
+        result_columns(concat_columns({
+            {"vector_size", "num_ciphertexts", "operation_type", "stage_threads", "queue_depth",
+             "stream_ciphertexts", "wall_time_ms", "ciphertexts_per_s", "elements_per_s"},
+            utilization,
+            {"bottleneck_stage"},
+            stats_columns("latency"),
+            {"valid"}})),
+        {"vector_size", "num_ciphertexts", "operation_type", "stage_threads", "queue_depth", "stream_ciphertexts"});
+}
+
+// One ciphertext's worth of buffers travelling through the pipeline. Items
+// are allocated once from the parent backend (whose pool is safe to use
+// from any thread) and recycled through a free list.
+struct PipelineItem {
+    size_t chunk = 0;
+    std::unique_ptr<Plain> plain_a, plain_b, decrypted;
+    std::unique_ptr<Cipher> cipher_a, cipher_b, result;
+    Timer latency;
+};
+
+// Streams the chunks of one (degree, vector_size, op) cell through
+// encode -> encrypt -> evaluate -> decrypt, each stage on its own threads
+// with bounded queues in between. Utilization is a stage's busy time over
+// wall time x its thread count; the busiest stage caps throughput.
+inline void run_pipeline_cell(Backend &backend, size_t degree, size_t vector_size, OpType op,
+                              const PipelineConfig &pipeline, const Dataset &dataset, CsvLog &log) {
+    size_t slot_count = backend.slot_count();
+    size_t num_ciphertexts = (vector_size + slot_count - 1) / slot_count;
+    size_t total = std::max(num_ciphertexts, pipeline.min_ciphertexts);
+    uint64_t t = backend.plain_modulus();
+
+    ChunkedOperands inputs(dataset, slot_count);
+    size_t total_elements = 0;
+    for (size_t i = 0; i < total; i++) total_elements += inputs.used[i % num_ciphertexts];
+
+    // Enough items to fill every queue and keep every worker busy.
+    size_t num_items = std::min(total, pipeline.queue_depth * (StageCount - 1) + pipeline.total_threads());
+    std::vector<std::unique_ptr<PipelineItem>> items(num_items);
+    BoundedQueue<PipelineItem *> free_items(num_items);
+    for (auto &item : items) {
+        item = std::make_unique<PipelineItem>();
+        item->plain_a = backend.make_plain();
+        item->plain_b = backend.make_plain();
+        item->decrypted = backend.make_plain();
+        item->cipher_a = backend.make_cipher();
+        item->cipher_b = backend.make_cipher();
+        item->result = backend.make_cipher();
+        free_items.push(item.get());
+    }
+
+    // queues[s] feeds stage s + 1.
+    std::vector<std::unique_ptr<BoundedQueue<PipelineItem *>>> queues;
+    for (size_t s = 0; s < StageCount - 1; s++) {
+        queues.push_back(std::make_unique<BoundedQueue<PipelineItem *>>(pipeline.queue_depth));
+    }
+
+    std::vector<size_t> thread_stage;
+    for (size_t s = 0; s < StageCount; s++) {
+        thread_stage.insert(thread_stage.end(), pipeline.stage_threads[s], s);
+    }
+    size_t threads = thread_stage.size();
+
+    std::vector<double> busy_ms(threads, 0), finish_ms(threads, 0);
+    std::vector<SampleSet> latency(threads);
+    std::atomic<size_t> next_chunk{0};
+    std::atomic<size_t> finished[StageCount] = {};
+    std::atomic<bool> valid{true};
+    StartGate gate(threads);
+
+    // A stage worker that throws closes every queue, so the other stages
+    // drain out instead of blocking on it; run_on_threads then rethrows.
+    auto abort_pipeline = [&] {
+        free_items.close();
+        for (auto &queue : queues) queue->close();
+    };
+
+    run_on_threads(threads, [&](size_t tid) {
+        GatePass pass(gate);
+        size_t stage = thread_stage[tid];
+        try {
+            auto worker = backend.make_worker();
+            std::vector<uint64_t> decoded;
+            Timer busy;
+            PipelineItem *item = nullptr;
+
+            pass.arrive_and_wait();
+
+            switch (stage) {
+            case StageEncode:
+                for (size_t i = next_chunk++; i < total; i = next_chunk++) {
+                    if (!free_items.pop(item)) break;
+                    item->latency.tic();
+                    busy.tic();
+                    item->chunk = i % num_ciphertexts;
+                    worker->encode(inputs.a[item->chunk], *item->plain_a);
+                    worker->encode(inputs.b[item->chunk], *item->plain_b);
+                    busy_ms[tid] += busy.toc();
+                    if (!queues[0]->push(item)) break;
+                }
+                break;
+            case StageEncrypt:
+                while (queues[0]->pop(item)) {
+                    busy.tic();
+                    worker->encrypt(*item->plain_a, *item->cipher_a);
+                    if (!is_plain_op(op)) {
+                        worker->encrypt(*item->plain_b, *item->cipher_b);
+                    }
+                    busy_ms[tid] += busy.toc();
+                    if (!queues[1]->push(item)) break;
+                }
+                break;
+            case StageEvaluate:
+                while (queues[1]->pop(item)) {
+                    busy.tic();
+                    worker->apply(op, *item->cipher_a, *item->cipher_b, *item->plain_b, *item->result);
+                    busy_ms[tid] += busy.toc();
+                    if (!queues[2]->push(item)) break;
+                }
+                break;
+            case StageDecrypt:
+                while (queues[2]->pop(item)) {
+                    busy.tic();
+                    worker->decrypt(*item->result, *item->decrypted);
+                    worker->decode(*item->decrypted, decoded);
+                    busy_ms[tid] += busy.toc();
+                    size_t c = item->chunk;
+                    for (size_t j = 0; j < inputs.used[c]; j++) {
+                        if (decoded[j] != expected_value(op, inputs.a[c][j], inputs.b[c][j], t)) {
+                            valid = false;
+                            break;
+                        }
+                    }
+                    latency[tid].add(item->latency.toc());
+                    free_items.push(item);
+                }
+                break;
+            }
+        } catch (...) {
+            abort_pipeline();
+            throw;
+        }
+        finish_ms[tid] = gate.elapsed_ms();
+
+        // The last worker of a stage closes the queue it feeds.
+        if (++finished[stage] == pipeline.stage_threads[stage] && stage < StageDecrypt) {
+            queues[stage]->close();
+        }
+    });
+    double wall_ms = *std::max_element(finish_ms.begin(), finish_ms.end());
+
+    double utilization[StageCount] = {};
+    for (size_t tid = 0; tid < threads; tid++) {
+        utilization[thread_stage[tid]] += busy_ms[tid];
+    }
+    size_t bottleneck = 0;
+    for (size_t s = 0; s < StageCount; s++) {
+        utilization[s] /= wall_ms * pipeline.stage_threads[s];
+        if (utilization[s] > utilization[bottleneck]) bottleneck = s;
+    }
+
+    SampleSet all_latency;
+    for (const auto &l : latency) all_latency.merge(l);
+    Stats latency_stats = all_latency.stats();
+    double ciphertexts_per_s = total / (wall_ms / 1000.0);
+    double elements_per_s = total_elements / (wall_ms / 1000.0);
+
+    log.row(backend.library(), backend.scheme(), degree, slot_count,
+            vector_size, num_ciphertexts, op_name(op), pipeline.describe(), pipeline.queue_depth,
+            total, wall_ms, ciphertexts_per_s, elements_per_s,
+            utilization[StageEncode], utilization[StageEncrypt],
+            utilization[StageEvaluate], utilization[StageDecrypt],
+            stage_name(bottleneck), latency_stats, valid ? 1 : 0);
+
+    std::cout << backend.library() << " PolyModulus: " << degree
+              << ", VectorSize: " << vector_size
+              << ", Operation: " << op_name(op)
+              << ", Stages: " << pipeline.describe()
+              << ", Throughput: " << ciphertexts_per_s << " ct/s"
+              << ", Utilization enc/encr/eval/dec: "
+              << utilization[StageEncode] << "/" << utilization[StageEncrypt] << "/"
+              << utilization[StageEvaluate] << "/" << utilization[StageDecrypt]
+              << ", Bottleneck: " << stage_name(bottleneck)
+              << ", Valid: " << (valid ? "YES" : "NO") << std::endl;
+}
+
+// Every degree x multi-ciphertext vector size x op through the pipeline.
+inline void run_pipeline_sweep(Backend &backend, const SweepConfig &config,
+                               const PipelineConfig &pipeline, CsvLog &log) {
+    DatasetStore datasets = sweep_datasets(config);
+    datasets.prepare(config.vector_sizes);
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " Pipeline PolyModulus=" << degree << " ===" << std::endl;
+        if (!setup_first_working(backend, sweep_candidates(config, degree))) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        if (backend.slot_count() < config.min_slots) {
+            std::cout << "SKIPPING - too few slots" << std::endl;
+            continue;
+        }
+        for (auto vector_size : config.vector_sizes) {
+            if (vector_size <= backend.slot_count() && pipeline.min_ciphertexts <= 1) continue;
+            for (auto op : all_ops()) {
+                try {
+                    run_pipeline_cell(backend, degree, vector_size, op, pipeline, datasets.get(vector_size), log);
+                } catch (const std::exception &e) {
+                    std::cout << "Error with PolyModulus: " << degree
+                              << ", VectorSize: " << vector_size
+                              << ", Operation: " << op_name(op)
+                              << " - " << e.what() << std::endl;
+                }
+            }
+        }
+    }
+}
+
+} // namespace bench
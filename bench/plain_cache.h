@@ -0,0 +1,117 @@
+#pragma once
+
+#include "backend.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+inline ColumnSet plain_cache_columns() {
+    return keyed_columns(
+        result_columns(concat_columns({
+            {"plain_encoding", "resident_ntt", "num_weights", "weight_encode_ms", "cipher_to_ntt_ms"},
+            stats_columns("weighted_sum"),
+            {"multiply_plain_ms", "valid"}})),
+        {"plain_encoding", "resident_ntt", "num_weights"});
+}
+
+// Model-weight style reuse of plaintext operands: y = sum_k x_k * w_k over
+// mul_chain_length encrypted inputs x_k and a cache of encoded weights w_k,
+// encoded once and reused by every sample. Runs for each of the backend's
+// plain encodings and, for the pre-transformed encodings (all but the
+// first) of a backend with an NTT representation, a resident variant: the x_k are transformed to NTT form once up front
+// (cipher_to_ntt_ms, as if stored that way), products are summed in NTT
+// form and y alone is transformed back inside each sample. weight_encode_ms
+// is the one-off cost of filling the cache.
+inline void run_plain_cache_sweep(Backend &backend, const SweepConfig &config, CsvLog &log) {
+    OperandSource source(config);
+    size_t num_weights = config.mul_chain_length;
+    std::string default_encoding = backend.plain_encodings().front();
+
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " plaintext cache PolyModulus=" << degree << " ===" << std::endl;
+        if (!setup_first_working(backend, sweep_candidates(config, degree))) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        size_t slot_count = backend.slot_count();
+        uint64_t t = backend.plain_modulus();
+
+        std::vector<std::vector<uint64_t>> x(num_weights), w(num_weights);
+        std::vector<uint64_t> expected(slot_count, 0), decoded;
+        for (size_t k = 0; k < num_weights; k++) {
+            source.fill_a(x[k], slot_count, slot_count);
+            source.fill_b(w[k], slot_count, slot_count);
+            for (size_t j = 0; j < slot_count; j++) {
+                expected[j] = (expected[j] + expected_value(OpType::CipherMulPlain, x[k][j], w[k][j], t)) % t;
+            }
+        }
+
+        for (const auto &encoding : backend.plain_encodings()) {
+            for (bool resident : {false, true}) {
+                if (resident && encoding == default_encoding) continue;
+                try {
+                    std::vector<std::unique_ptr<Plain>> weights;
+                    std::vector<std::unique_ptr<Cipher>> inputs;
+                    auto plain = backend.make_plain();
+                    backend.set_plain_encoding(default_encoding);
+                    for (size_t k = 0; k < num_weights; k++) {
+                        backend.encode(x[k], *plain);
+                        inputs.push_back(backend.make_cipher());
+                        backend.encrypt(*plain, *inputs[k]);
+                        weights.push_back(backend.make_plain());
+                    }
+                    backend.set_plain_encoding(encoding);
+                    Timer timer;
+                    timer.tic();
+                    for (size_t k = 0; k < num_weights; k++) backend.encode(w[k], *weights[k]);
+                    double encode_ms = timer.toc();
+
+                    double to_ntt_ms = 0;
+                    if (resident) {
+                        timer.tic();
+                        bool supported = true;
+                        for (auto &input : inputs) supported = backend.to_ntt(*input) && supported;
+                        to_ntt_ms = timer.toc();
+                        if (!supported) continue;
+                    }
+
+                    auto acc = backend.make_cipher();
+                    auto tmp = backend.make_cipher();
+                    Stats stats = measure(config.timing, [&] {
+                        backend.multiply_plain(*inputs[0], *weights[0], *acc);
+                        for (size_t k = 1; k < num_weights; k++) {
+                            backend.multiply_plain(*inputs[k], *weights[k], *tmp);
+                            backend.add_inplace(*acc, *tmp);
+                        }
+                        if (resident) backend.from_ntt(*acc);
+                    });
+                    backend.decrypt(*acc, *plain);
+                    backend.decode(*plain, decoded);
+                    bool valid = decoded == expected;
+
+                    double per_multiply_ms = stats.median_ms / num_weights;
+                    log.row(backend.library(), backend.scheme(), degree, slot_count, encoding, resident ? 1 : 0,
+                            num_weights, encode_ms, to_ntt_ms, stats, per_multiply_ms, valid ? 1 : 0);
+                    std::cout << "  " << encoding << (resident ? ", resident NTT" : "") << ": "
+                              << num_weights << " weights encoded in " << encode_ms << " ms, weighted sum "
+                              << stats.median_ms << " ms (" << per_multiply_ms << " ms per product)"
+                              << (valid ? "" : ", INVALID") << std::endl;
+                } catch (const std::exception &e) {
+                    std::cout << "Error with PolyModulus: " << degree << " [" << encoding
+                              << (resident ? ", resident" : "") << "] - " << e.what() << std::endl;
+                }
+            }
+        }
+        backend.set_plain_encoding(default_encoding);
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "options.h"
+#include "results.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// What a backend header was compiled against.
+struct BuildInfo {
+    std::string library;
+    std::string version;
+    bool hexl = false;  // linked against Intel HEXL
+};
+
+// x86 features HEXL dispatches on, ;-separated, or "none".
+inline std::string cpu_features() {
+    std::string features;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    auto add = [&](const char *name, bool present) {
+        if (!present) return;
+        if (!features.empty()) features += ";";
+        features += name;
+    };
+    add("avx2", __builtin_cpu_supports("avx2"));
+    add("avx512f", __builtin_cpu_supports("avx512f"));
+    add("avx512dq", __builtin_cpu_supports("avx512dq"));
+    add("avx512ifma", __builtin_cpu_supports("avx512ifma"));
+    add("avx512vbmi2", __builtin_cpu_supports("avx512vbmi2"));
+#endif
+    return features.empty() ? "none" : features;
+}
+
+// HEXL reads these once at startup and, when set to anything but 0, skips
+// the matching AVX-512 kernels for its portable ones.
+inline const std::vector<const char *> &hexl_disable_vars() {
+    static const std::vector<const char *> vars = {"HEXL_DISABLE_AVX512DQ", "HEXL_DISABLE_AVX512IFMA",
+                                                   "HEXL_DISABLE_AVX512VBMI2"};
+    return vars;
+}
+
+// Widest HEXL kernel set this process runs: "off" (not linked), "scalar",
+// "avx512dq" or "avx512ifma".
+inline std::string hexl_state(const BuildInfo &build) {
+    if (!build.hexl) return "off";
+    auto enabled = [](const char *feature, const char *var) {
+        const char *value = std::getenv(var);
+        bool disabled = value && std::string(value) != "0";
+        std::string features = ";" + cpu_features() + ";";
+        return !disabled && features.find(std::string(";") + feature + ";") != std::string::npos;
+    };
+    if (enabled("avx512ifma", "HEXL_DISABLE_AVX512IFMA")) return "avx512ifma";
+    if (enabled("avx512dq", "HEXL_DISABLE_AVX512DQ")) return "avx512dq";
+    return "scalar";
+}
+
+inline std::string env_or(const char *name, const std::string &fallback) {
+    const char *value = std::getenv(name);
+    return value ? value : fallback;
+}
+
+inline std::string host_name() {
+    char name[256] = {};
+    return gethostname(name, sizeof(name) - 1) == 0 ? name : "unknown";
+}
+
+// This process's command line, space-separated.
+inline std::string command_line() {
+    std::ifstream in("/proc/self/cmdline", std::ios::binary);
+    std::string command, arg;
+    while (std::getline(in, arg, '\0')) command += (command.empty() ? "" : " ") + arg;
+    return command;
+}
+
+inline std::string utc_timestamp() {
+    std::time_t now = std::time(nullptr);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    return buf;
+}
+
+// BENCH_RUN_ID, or a new host-time-pid id exported so child processes
+// (run_hexl_ab()) log under the same run.
+inline std::string run_id() {
+    std::string id = env_or("BENCH_RUN_ID", "");
+    if (id.empty()) {
+        std::string stamp = utc_timestamp();
+        stamp.erase(std::remove_if(stamp.begin(), stamp.end(), [](char c) { return c == '-' || c == ':'; }),
+                    stamp.end());
+        id = host_name() + "-" + stamp + "-" + std::to_string(getpid());
+        setenv("BENCH_RUN_ID", id.c_str(), 1);
+    }
+    return id;
+}
+
+// Tags every CSV row written from here on with the library version, HEXL
+// state, CPU features and, in a child of run_hexl_ab(), its variant and
+// round, and takes the child's file name prefix. With BENCH_RESULTS_LOG
+// set, also opens that result log and records the run's metadata in it.
+// Drivers call it before their first CsvLog.
+inline void tag_results(const BuildInfo &build) {
+    run_tags() = {{"library_version", build.version},
+                  {"hexl", hexl_state(build)},
+                  {"cpu_features", cpu_features()},
+                  {"ab_variant", env_or("BENCH_AB_VARIANT", "none")},
+                  {"ab_round", env_or("BENCH_AB_ROUND", "0")}};
+    results_prefix() = env_or("BENCH_RESULTS_PREFIX", "");
+
+    std::string log_path = env_or("BENCH_RESULTS_LOG", "");
+    if (log_path.empty()) return;
+    current_run_id() = run_id();
+    result_log().open(log_path);
+    ResultRecord run;
+    run.kind = RecordKind::Run;
+    run.fields = {{"run_id", current_run_id()}, {"started_utc", utc_timestamp()}, {"host", host_name()},
+                  {"command", command_line()}, {"library", build.library}};
+    run.fields.insert(run.fields.end(), run_tags().begin(), run_tags().end());
+    result_log().append(run);
+}
+
+// --ab-hexl[=N]: runs the driver's workload (the rest of the command line)
+// in child processes of this binary, N rounds (default 1) of two variants:
+// "hexl" with HEXL's AVX-512 kernels and "scalar" with them disabled
+// through hexl_disable_vars(), so HEXL falls back to its portable code.
+// Rounds alternate the order (AB BA ...) so drift on the machine does not
+// favor one variant. Children write <variant>_r<round>_<file>.csv and log
+// under this process's run_id(). Returns the first failing child's exit
+// status, else 0.
+inline int run_hexl_ab(int argc, char **argv, const Options &options, const BuildInfo &build) {
+    int rounds = std::max(1, static_cast<int>(options.get_long("ab-hexl", 1)));
+    if (!build.hexl) {
+        std::cout << "Note: " << build.library << " " << build.version
+                  << " is not linked against HEXL; both variants run the same code" << std::endl;
+    }
+    run_id();
+    std::vector<std::string> args = {argv[0]};
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg != "--ab-hexl" && arg.rfind("--ab-hexl=", 0) != 0) args.push_back(arg);
+    }
+
+    int rc = 0;
+    for (int round = 0; round < rounds; round++) {
+        std::vector<std::string> order = {"hexl", "scalar"};
+        if (round % 2) std::reverse(order.begin(), order.end());
+        for (const auto &variant : order) {
+            std::cout << "\n##### A/B round " << round << ": " << variant << " #####" << std::endl;
+            std::string prefix = variant + "_r" + std::to_string(round) + "_";
+            pid_t pid = fork();
+            if (pid == 0) {
+                setenv("BENCH_AB_VARIANT", variant.c_str(), 1);
+                setenv("BENCH_AB_ROUND", std::to_string(round).c_str(), 1);
+                setenv("BENCH_RESULTS_PREFIX", prefix.c_str(), 1);
+                for (const char *var : hexl_disable_vars()) {
+                    if (variant == "scalar") {
+                        setenv(var, "1", 1);
+                    } else {
+                        unsetenv(var);
+                    }
+                }
+                std::vector<char *> child_argv;
+                for (auto &arg : args) child_argv.push_back(&arg[0]);
+                child_argv.push_back(nullptr);
+                execv("/proc/self/exe", child_argv.data());
+                std::perror("execv");
+                _exit(127);
+            }
+            int status = 0;
+            if (pid < 0 || waitpid(pid, &status, 0) < 0) {
+                std::perror("fork");
+                return 1;
+            }
+            int child_rc = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+            if (child_rc && !rc) rc = child_rc;
+        }
+    }
+    return rc;
+}
+
+} // namespace bench
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "result_log.h"
+#include "results.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Values of one metric in one cell of a run: one per matching row, since a
+// run may repeat a cell (A/B rounds, several invocations under one run id).
+struct MetricValues {
+    std::vector<double> values;
+    std::vector<double> stddevs;  // from the row's <name>_stddev_ms, when it has one
+
+    double median() const {
+        std::vector<double> v = values;
+        std::sort(v.begin(), v.end());
+        size_t n = v.size();
+        return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+    }
+
+    // Run-to-run spread of the median: the reported per-row stddev, or the
+    // spread of repeated rows when that is larger.
+    double noise() const {
+        double sd = 0;
+        for (double s : stddevs) sd = std::max(sd, s);
+        if (values.size() > 1) {
+            double mean = 0, var = 0;
+            for (double v : values) mean += v;
+            mean /= values.size();
+            for (double v : values) var += (v - mean) * (v - mean);
+            sd = std::max(sd, std::sqrt(var / (values.size() - 1)));
+        }
+        return sd;
+    }
+};
+
+struct RunResults {
+    std::string run_id;
+    RecordFields metadata;
+    // cell key -> metric -> values
+    std::map<std::string, std::map<std::string, MetricValues>> cells;
+};
+
+enum class MetricKind { None, Latency, Throughput };
+
+// Medians (<name>_time_ms) and single timings (setup_ms, wall_ms, ...) are
+// latencies, *_per_s rates are throughputs. Spread columns are not compared
+// on their own.
+inline MetricKind metric_kind(const std::string &name) {
+    if (ends_with(name, "_per_s")) return MetricKind::Throughput;
+    if (!ends_with(name, "_ms")) return MetricKind::None;
+    for (const char *spread : {"_min_ms", "_p90_ms", "_p99_ms", "_stddev_ms"}) {
+        if (ends_with(name, spread)) return MetricKind::None;
+    }
+    return MetricKind::Latency;
+}
+
+// Splits a key_columns field ("a;b;c").
+inline std::vector<std::string> split_key_columns(const std::string &list) {
+    std::vector<std::string> names;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(';', start);
+        if (end == std::string::npos) end = list.size();
+        if (end > start) names.push_back(list.substr(start, end - start));
+        start = end + 1;
+    }
+    return names;
+}
+
+// Row records of every log, grouped by run in the order runs first appear.
+// A cell is identified by its workload and the key columns the row lists
+// (see ColumnSet); for rows without that list, by every column that is
+// neither a measurement nor run metadata (see is_measurement_column,
+// is_run_column).
+inline std::vector<RunResults> load_runs(const std::vector<std::string> &paths) {
+    std::vector<RunResults> runs;
+    std::map<std::string, size_t> index;
+    auto run_for = [&](const std::string &id) -> RunResults & {
+        auto it = index.find(id);
+        if (it != index.end()) return runs[it->second];
+        index[id] = runs.size();
+        runs.emplace_back();
+        runs.back().run_id = id;
+        return runs.back();
+    };
+
+    for (const auto &path : paths) {
+        for (const auto &record : read_result_log(path)) {
+            RunResults &run = run_for(record.get("run_id"));
+            if (record.kind == RecordKind::Run) {
+                if (run.metadata.empty()) run.metadata = record.fields;
+                continue;
+            }
+            std::vector<std::string> key_names = split_key_columns(record.get("key_columns"));
+            bool explicit_keys = !key_names.empty();
+            std::string key = "workload=" + record.get("workload");
+            std::map<std::string, std::string> values;
+            for (const auto &f : record.fields) {
+                if (is_run_column(f.first) || f.first == "workload" || f.first == "key_columns") continue;
+                bool is_key = explicit_keys ? std::find(key_names.begin(), key_names.end(), f.first) != key_names.end()
+                                            : !is_measurement_column(f.first);
+                if (is_key) {
+                    key += "," + f.first + "=" + f.second;
+                } else {
+                    values[f.first] = f.second;
+                }
+            }
+            auto &cell = run.cells[key];
+            for (const auto &v : values) {
+                if (metric_kind(v.first) == MetricKind::None || v.second.empty()) continue;
+                char *end = nullptr;
+                double x = std::strtod(v.second.c_str(), &end);
+                if (end == v.second.c_str() || !std::isfinite(x)) continue;
+                MetricValues &m = cell[v.first];
+                m.values.push_back(x);
+                std::string base = v.first.substr(0, v.first.size() - 3);
+                if (ends_with(base, "_time")) base.resize(base.size() - 5);
+                auto sd = values.find(base + "_stddev_ms");
+                if (sd != values.end() && !sd->second.empty()) m.stddevs.push_back(std::strtod(sd->second.c_str(), nullptr));
+            }
+        }
+    }
+    return runs;
+}
+
+struct RegressionConfig {
+    double threshold_pct = 5;  // smallest relative change that counts
+    double sigmas = 2;         // and it must exceed this many combined stddevs
+    double min_ms = 0.001;     // latencies below this are timer noise
+};
+
+struct Comparison {
+    std::string cell;
+    std::string metric;
+    double base = 0;
+    double candidate = 0;
+    double change_pct = 0;  // positive is worse, for either kind of metric
+    double noise = 0;
+    std::string verdict;    // regression, improvement or same
+};
+
+// Every metric both runs measured in a cell they share. A change is a
+// regression or improvement only when it clears both the relative threshold
+// and the combined noise of the two runs.
+inline std::vector<Comparison> compare_runs(const RunResults &base, const RunResults &candidate,
+                                            const RegressionConfig &config) {
+    std::vector<Comparison> out;
+    for (const auto &cell : candidate.cells) {
+        auto b = base.cells.find(cell.first);
+        if (b == base.cells.end()) continue;
+        for (const auto &metric : cell.second) {
+            auto bm = b->second.find(metric.first);
+            if (bm == b->second.end()) continue;
+            Comparison c;
+            c.cell = cell.first;
+            c.metric = metric.first;
+            c.base = bm->second.median();
+            c.candidate = metric.second.median();
+            MetricKind kind = metric_kind(metric.first);
+            if (kind == MetricKind::Latency && std::max(c.base, c.candidate) < config.min_ms) continue;
+            if (c.base == 0) continue;
+            double delta = kind == MetricKind::Latency ? c.candidate - c.base : c.base - c.candidate;
+            c.change_pct = 100 * delta / c.base;
+            c.noise = std::hypot(bm->second.noise(), metric.second.noise());
+            bool significant = std::fabs(c.change_pct) > config.threshold_pct &&
+                               std::fabs(c.candidate - c.base) > config.sigmas * c.noise;
+            c.verdict = !significant ? "same" : delta > 0 ? "regression" : "improvement";
+            out.push_back(c);
+        }
+    }
+    return out;
+}
+
+// Cells of `run` that `other` has no row for, so compare_runs() skips them.
+inline std::vector<std::string> unmatched_cells(const RunResults &run, const RunResults &other) {
+    std::vector<std::string> cells;
+    for (const auto &cell : run.cells) {
+        if (!other.cells.count(cell.first)) cells.push_back(cell.first);
+    }
+    return cells;
+}
+
+inline std::vector<std::string> comparison_columns() {
+    return {"base_run", "candidate_run", "cell", "metric", "base", "candidate", "change_pct", "noise", "verdict"};
+}
+
+// Cells hold commas; the comparison file quotes them.
+inline std::string quoted(const std::string &s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+inline void log_comparisons(const RunResults &base, const RunResults &candidate,
+                            const std::vector<Comparison> &comparisons, CsvLog &log) {
+    for (const auto &c : comparisons) {
+        log.row(base.run_id, candidate.run_id, quoted(c.cell), c.metric, c.base, c.candidate, c.change_pct,
+                c.noise, c.verdict);
+    }
+}
+
+} // namespace bench
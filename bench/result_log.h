@@ -0,0 +1,202 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// Append-only log every driver (C++ and pyfhel/) writes its results to when
+// BENCH_RESULTS_LOG names a file, so runs of all libraries and workloads
+// land in one place with one schema. Each record is a list of (column,
+// value) pairs:
+//
+//   file    8-byte magic "HEBRLOG1" (written once, by whoever creates it)
+//   record  uint32 kind, uint32 field count, then per field a uint32
+//           length and the bytes of the name, then the same for the value
+//
+// Integers are little-endian. A Run record holds the run's metadata
+// (run_id, started_utc, host, command and the run_tags()); every Row record
+// starts with run_id and workload (the CSV file it was also written to)
+// followed by that file's columns. Records are written with a single
+// O_APPEND write, so concurrent processes may share one log.
+constexpr char ResultLogMagic[8] = {'H', 'E', 'B', 'R', 'L', 'O', 'G', '1'};
+
+enum class RecordKind : uint32_t { Run = 1, Row = 2 };
+
+using RecordFields = std::vector<std::pair<std::string, std::string>>;
+
+struct ResultRecord {
+    RecordKind kind = RecordKind::Row;
+    RecordFields fields;
+
+    // Empty if the record has no such field.
+    std::string get(const std::string &name) const {
+        for (const auto &f : fields) {
+            if (f.first == name) return f.second;
+        }
+        return "";
+    }
+};
+
+inline void put_u32(std::string &out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+
+inline uint32_t get_u32(const char *p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= static_cast<uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    return v;
+}
+
+inline std::string encode_record(const ResultRecord &record) {
+    std::string out;
+    put_u32(out, static_cast<uint32_t>(record.kind));
+    put_u32(out, static_cast<uint32_t>(record.fields.size()));
+    for (const auto &f : record.fields) {
+        put_u32(out, static_cast<uint32_t>(f.first.size()));
+        out += f.first;
+        put_u32(out, static_cast<uint32_t>(f.second.size()));
+        out += f.second;
+    }
+    return out;
+}
+
+class ResultLog {
+private:
+    int fd = -1;
+    std::mutex mutex;
+
+public:
+    ResultLog() = default;
+    ResultLog(const ResultLog &) = delete;
+    ResultLog &operator=(const ResultLog &) = delete;
+    ~ResultLog() { close(); }
+
+    bool is_open() const { return fd >= 0; }
+
+    void open(const std::string &path) {
+        close();
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) throw std::runtime_error("cannot open result log " + path + ": " + std::strerror(errno));
+        // Only the creator sees an empty file; a racing creator's magic is
+        // caught by the reader as a bad record.
+        if (::lseek(fd, 0, SEEK_END) == 0) write_bytes(std::string(ResultLogMagic, sizeof(ResultLogMagic)));
+    }
+
+    void close() {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+
+    void append(const ResultRecord &record) {
+        if (fd < 0) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        write_bytes(encode_record(record));
+    }
+
+private:
+    void write_bytes(const std::string &bytes) {
+        ssize_t n = ::write(fd, bytes.data(), bytes.size());
+        if (n != static_cast<ssize_t>(bytes.size())) {
+            throw std::runtime_error(std::string("result log write failed: ") + std::strerror(errno));
+        }
+    }
+};
+
+// Process-wide log; closed until tag_results() opens it.
+inline ResultLog &result_log() {
+    static ResultLog log;
+    return log;
+}
+
+inline std::string &current_run_id() {
+    static std::string id;
+    return id;
+}
+
+// Every record of a log file, in write order. A truncated last record (a
+// writer killed mid-write) is dropped; anything else malformed throws.
+inline std::vector<ResultRecord> read_result_log(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("cannot open result log " + path);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(ResultLogMagic) || data.compare(0, sizeof(ResultLogMagic), ResultLogMagic, 8) != 0) {
+        throw std::runtime_error(path + " is not a result log");
+    }
+
+    std::vector<ResultRecord> records;
+    size_t pos = sizeof(ResultLogMagic);
+    auto take_string = [&](std::string &out) {
+        if (data.size() - pos < 4) return false;
+        uint32_t n = get_u32(data.data() + pos);
+        pos += 4;
+        if (data.size() - pos < n) return false;
+        out.assign(data, pos, n);
+        pos += n;
+        return true;
+    };
+    while (data.size() - pos >= 8) {
+        ResultRecord record;
+        uint32_t kind = get_u32(data.data() + pos);
+        uint32_t count = get_u32(data.data() + pos + 4);
+        if (kind != static_cast<uint32_t>(RecordKind::Run) && kind != static_cast<uint32_t>(RecordKind::Row)) {
+            throw std::runtime_error(path + ": bad record at byte " + std::to_string(pos));
+        }
+        pos += 8;
+        record.kind = static_cast<RecordKind>(kind);
+        bool complete = true;
+        for (uint32_t i = 0; i < count && complete; i++) {
+            std::pair<std::string, std::string> field;
+            complete = take_string(field.first) && take_string(field.second);
+            record.fields.push_back(std::move(field));
+        }
+        if (!complete) break;
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+inline bool ends_with(const std::string &s, const std::string &suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Columns holding what a cell measured rather than which cell it is, for
+// rows that do not list their key_columns (a CsvLog opened with a plain
+// column list, and pyfhel/): those are matched on everything else. Times end
+// in _ms, rates in _per_s, sizes in _bytes or _kb, shares in _pct, _share,
+// _ratio or _utilization, and noise readings mention budget, capacity or
+// precision.
+inline bool is_measurement_column(const std::string &name) {
+    for (const char *suffix : {"_ms", "_per_s", "_bytes", "_kb", "_samples", "_cycles", "_ratio", "_efficiency",
+                               "_speedup", "_error", "_utilization", "_pct", "_share", "_mpki", "_instructions", "_misses", "_requests"}) {
+        if (ends_with(name, suffix)) return true;
+    }
+    for (const char *part : {"budget", "capacity", "precision"}) {
+        if (name.find(part) != std::string::npos) return true;
+    }
+    for (const char *exact : {"valid", "speedup", "utilization", "depth", "max_operations", "meets_target", "pareto",
+                              "setup_source", "bytes_sent", "bytes_received", "flushes", "mod_switches",
+                              "final_level", "bottleneck_stage", "galois_key_count", "error", "calls_per_op"}) {
+        if (name == exact) return true;
+    }
+    return false;
+}
+
+// Run metadata that differs between otherwise comparable runs, such as the
+// library version an upgrade changes.
+inline bool is_run_column(const std::string &name) {
+    return name == "run_id" || name == "library_version" || name == "cpu_features" || name == "ab_round";
+}
+
+} // namespace bench
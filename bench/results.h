@@ -0,0 +1,161 @@
+#pragma once
+
+#include "result_log.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// Run-wide (name, value) fields appended to every row of every CsvLog opened
+// after they are set, and a prefix for the file names of those logs (see
+// tag_results() in platform.h).
+inline std::vector<std::pair<std::string, std::string>> &run_tags() {
+    static std::vector<std::pair<std::string, std::string>> tags;
+    return tags;
+}
+
+inline std::string &results_prefix() {
+    static std::string prefix;
+    return prefix;
+}
+
+// A workload's columns and the ones among them that identify a cell (the
+// parameters it was run at, as opposed to what it measured); see
+// keyed_columns(). Run-to-run comparison matches rows on these.
+struct ColumnSet {
+    std::vector<std::string> names;
+    std::vector<std::string> keys;
+};
+
+// Append-only CSV file with a fixed header. Every workload writes through one
+// of these so the column layout is defined in exactly one place per workload.
+// Rows also go to the result_log() when one is open, under the file's name
+// and, for a ColumnSet, with its key columns (plus the run tags that are not
+// run metadata) listed in a key_columns field.
+class CsvLog {
+private:
+    std::ofstream file;
+    std::string tag_fields;
+    std::string workload;
+    std::vector<std::string> names;
+    std::string key_names;
+
+    template <typename T>
+    void write_fields(std::ostream &out, const T &last) {
+        out << last;
+    }
+
+    template <typename T, typename... Rest>
+    void write_fields(std::ostream &out, const T &first, const Rest &...rest) {
+        out << first << ",";
+        write_fields(out, rest...);
+    }
+
+    void log_record(const std::string &line) {
+        ResultRecord record;
+        record.fields = {{"run_id", current_run_id()}, {"workload", workload}};
+        if (!key_names.empty()) record.fields.emplace_back("key_columns", key_names);
+        std::stringstream ss(line);
+        std::string value;
+        for (size_t i = 0; i < names.size() && std::getline(ss, value, ','); i++) {
+            record.fields.emplace_back(names[i], value);
+        }
+        result_log().append(record);
+    }
+
+public:
+    CsvLog(const std::string &path, const std::vector<std::string> &columns) {
+        std::filesystem::path file_path(path);
+        workload = file_path.stem().string();
+        file_path.replace_filename(results_prefix() + file_path.filename().string());
+        file.open(file_path);
+        names = columns;
+        for (size_t i = 0; i < columns.size(); i++) {
+            file << columns[i];
+            if (i < columns.size() - 1) file << ",";
+        }
+        for (const auto &tag : run_tags()) {
+            file << "," << tag.first;
+            tag_fields += "," + tag.second;
+            names.push_back(tag.first);
+        }
+        file << "\n";
+    }
+
+    CsvLog(const std::string &path, const ColumnSet &columns) : CsvLog(path, columns.names) {
+        for (const auto &key : columns.keys) key_names += (key_names.empty() ? "" : ";") + key;
+        for (const auto &tag : run_tags()) {
+            if (!is_run_column(tag.first)) key_names += ";" + tag.first;
+        }
+    }
+
+    ~CsvLog() {
+        if (file.is_open()) {
+            file.close();
+        }
+    }
+
+    template <typename... Fields>
+    void row(const Fields &...fields) {
+        std::ostringstream line;
+        write_fields(line, fields...);
+        line << tag_fields;
+        file << line.str() << "\n";
+        file.flush();
+        if (result_log().is_open()) log_record(line.str());
+    }
+};
+
+// Columns shared by every result file, followed by the workload's own.
+inline std::vector<std::string> result_columns(const std::vector<std::string> &workload_columns) {
+    std::vector<std::string> columns = {"library", "scheme", "poly_modulus_degree", "slot_count"};
+    columns.insert(columns.end(), workload_columns.begin(), workload_columns.end());
+    return columns;
+}
+
+// Columns written for one Stats field, in the order operator<< emits them.
+// The median keeps the historical "<name>_time_ms" column name.
+inline std::vector<std::string> stats_columns(const std::string &name) {
+    return {name + "_time_ms", name + "_min_ms", name + "_p90_ms", name + "_p99_ms",
+            name + "_stddev_ms", name + "_samples", name + "_cycles"};
+}
+
+inline std::ostream &operator<<(std::ostream &out, const Stats &s) {
+    return out << s.median_ms << "," << s.min_ms << "," << s.p90_ms << "," << s.p99_ms << ","
+               << s.stddev_ms << "," << s.samples << "," << s.median_cycles;
+}
+
+// A workload's result_columns() with its cell keys: the shared columns,
+// then workload_keys, each of which must be one of the columns.
+inline ColumnSet keyed_columns(const std::vector<std::string> &columns,
+                               const std::vector<std::string> &workload_keys) {
+    ColumnSet set{columns, {"library", "scheme", "poly_modulus_degree", "slot_count"}};
+    for (const auto &key : workload_keys) {
+        if (std::find(columns.begin(), columns.end(), key) == columns.end()) {
+            throw std::logic_error("key column " + key + " is not a column");
+        }
+        set.keys.push_back(key);
+    }
+    return set;
+}
+
+// Concatenates column groups.
+inline std::vector<std::string> concat_columns(std::initializer_list<std::vector<std::string>> groups) {
+    std::vector<std::string> columns;
+    for (const auto &group : groups) {
+        columns.insert(columns.end(), group.begin(), group.end());
+    }
+    return columns;
+}
+
+} // namespace bench
@@ -0,0 +1,1022 @@
+#pragma once
+
+#include "backend.h"
+#include "perf.h"
+#include "platform.h"
+#include "store.h"
+#include "timer.h"
+
+#include <seal/seal.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// The SEAL these benchmarks are compiled against, for tag_results().
+inline BuildInfo seal_build_info() {
+    BuildInfo build{"SEAL", SEAL_VERSION, false};
+#ifdef SEAL_USE_INTEL_HEXL
+    build.hexl = true;
+#endif
+    return build;
+}
+
+// With the "ntt" plain encoding, encode() also keeps the plaintext in NTT
+// form at the top level, which cipher x plain ops then use as is instead of
+// transforming pt on every call.
+struct SealPlain : Plain {
+    seal::Plaintext pt;
+    seal::Plaintext ntt;
+    std::vector<seal::Plaintext> ntt_lower;  // ntt switched to each level below the first
+    bool has_ntt = false;
+    explicit SealPlain(seal::MemoryPoolHandle pool) : pt(pool), ntt(pool) {}
+};
+
+// noise: estimated log2 of the invariant noise (see SealBfvBackend's
+// noise model), NaN when unknown.
+struct SealCipher : Cipher {
+    seal::Ciphertext ct;
+    double noise = std::nan("");
+    explicit SealCipher(seal::MemoryPoolHandle pool) : ct(pool) {}
+};
+
+inline const seal::Plaintext &seal_pt(const Plain &p) { return static_cast<const SealPlain &>(p).pt; }
+inline seal::Plaintext &seal_pt(Plain &p) { return static_cast<SealPlain &>(p).pt; }
+inline const SealPlain &seal_plain(const Plain &p) { return static_cast<const SealPlain &>(p); }
+inline SealPlain &seal_plain(Plain &p) { return static_cast<SealPlain &>(p); }
+inline const seal::Ciphertext &seal_ct(const Cipher &c) { return static_cast<const SealCipher &>(c).ct; }
+inline seal::Ciphertext &seal_ct(Cipher &c) { return static_cast<SealCipher &>(c).ct; }
+inline double seal_noise(const Cipher &c) { return static_cast<const SealCipher &>(c).noise; }
+inline double &seal_noise(Cipher &c) { return static_cast<SealCipher &>(c).noise; }
+
+// log2(2^a + 2^b).
+inline double log2_add(double a, double b) {
+    double hi = std::max(a, b), lo = std::min(a, b);
+    return hi + std::log2(1 + std::exp2(lo - hi));
+}
+
+// Encryptor, evaluator, decryptor and encoder bound to one context. The
+// cached key set owns one instance; every worker thread gets its own.
+struct SealTools {
+    std::unique_ptr<seal::Encryptor> encryptor;
+    std::unique_ptr<seal::Evaluator> evaluator;
+    std::unique_ptr<seal::Decryptor> decryptor;
+    std::unique_ptr<seal::BatchEncoder> batch_encoder;
+
+    // Without a secret key (an evaluation-only key set) there is no
+    // decryptor and no symmetric encryption.
+    void bind(const seal::SEALContext &context, const seal::PublicKey &public_key,
+              const seal::SecretKey *secret_key) {
+        // The secret key enables encrypt_symmetric (seeded ciphertexts).
+        if (secret_key) {
+            encryptor = std::make_unique<seal::Encryptor>(context, public_key, *secret_key);
+            decryptor = std::make_unique<seal::Decryptor>(context, *secret_key);
+        } else {
+            encryptor = std::make_unique<seal::Encryptor>(context, public_key);
+            decryptor.reset();
+        }
+        evaluator = std::make_unique<seal::Evaluator>(context);
+        // Throws if the plain modulus does not support batching.
+        batch_encoder = std::make_unique<seal::BatchEncoder>(context);
+    }
+};
+
+// Context and key material for one ParamSet, plus the tools bound to it.
+// Built once per parameter set and shared by every setup() that asks for it.
+struct SealKeySet {
+    std::shared_ptr<seal::SEALContext> context;
+    seal::SecretKey secret_key;
+    seal::PublicKey public_key;
+    seal::RelinKeys relin_keys;
+    seal::GaloisKeys galois_keys;
+    SealTools tools;
+    KeyGenTimes keygen_times;
+
+    // False for a key set loaded from an evaluation key bundle.
+    bool has_secret_key = true;
+
+    // Noise model inputs: log2 of t and N, and log2 of the invariant noise
+    // of a fresh encryption, measured once by decrypting one where the
+    // secret key is at hand and otherwise the usual 6-sigma bound.
+    double log_t = 0;
+    double log_n = 0;
+    double fresh_noise = 0;
+
+    const seal::SecretKey *secret() const { return has_secret_key ? &secret_key : nullptr; }
+
+    void bind() {
+        tools.bind(*context, public_key, secret());
+        const auto &data = *context->first_context_data();
+        log_t = std::log2(static_cast<double>(data.parms().plain_modulus().value()));
+        log_n = std::log2(static_cast<double>(data.parms().poly_modulus_degree()));
+        if (has_secret_key) {
+            seal::Plaintext zero;
+            seal::Ciphertext fresh;
+            tools.batch_encoder->encode(std::vector<uint64_t>(tools.batch_encoder->slot_count(), 0), zero);
+            tools.encryptor->encrypt(zero, fresh);
+            fresh_noise = -1.0 - tools.decryptor->invariant_noise_budget(fresh);
+        } else {
+            fresh_noise = log_t + std::log2(6 * 3.2 * 2) + 0.5 * log_n - data.total_coeff_modulus_bit_count();
+        }
+    }
+};
+
+// Wire format names of SEAL's compression modes.
+inline seal::compr_mode_type seal_compr_mode(const std::string &format) {
+    if (format == "none") return seal::compr_mode_type::none;
+    if (format == "zlib") return seal::compr_mode_type::zlib;
+    if (format == "zstd") return seal::compr_mode_type::zstd;
+    throw std::invalid_argument("unknown SEAL wire format " + format);
+}
+
+// SEAL's security levels; 0 selects its default of 128 bits.
+inline seal::sec_level_type seal_sec_level(int security_bits) {
+    switch (security_bits) {
+    case 0:
+    case 128: return seal::sec_level_type::tc128;
+    case 192: return seal::sec_level_type::tc192;
+    case 256: return seal::sec_level_type::tc256;
+    }
+    throw std::invalid_argument("SEAL supports 128, 192 or 256-bit security, not " + std::to_string(security_bits));
+}
+
+// Microsoft SEAL, BFV scheme with batching.
+class SealBfvBackend final : public Backend {
+private:
+    std::map<std::string, std::shared_ptr<SealKeySet>> cache;
+    std::shared_ptr<SealKeySet> keys;
+
+    // Tools in use: the key set's own, or worker_tools for a worker.
+    SealTools *tools = nullptr;
+    std::unique_ptr<SealTools> worker_tools;
+
+    // Pool for every ciphertext, plaintext and temporary this backend
+    // allocates. Workers use their thread's thread-local pool so threads do
+    // not contend on the global one.
+    seal::MemoryPoolHandle pool = seal::MemoryManager::GetPool();
+    seal::MemoryPoolHandle saved_pool;
+    seal::MemoryPoolHandle arena_saved_pool;
+    size_t arena_polys = 0;
+
+    // Set on replicas: workers draw from the replica's own (node-local) pool
+    // instead of a thread-local one.
+    bool workers_share_pool = false;
+
+    static seal::EncryptionParameters make_parms(const ParamSet &params) {
+        size_t n = params.poly_modulus_degree;
+        seal::EncryptionParameters parms(seal::scheme_type::bfv);
+        parms.set_poly_modulus_degree(n);
+        if (params.coeff_modulus_bits.empty()) {
+            parms.set_coeff_modulus(seal::CoeffModulus::BFVDefault(n, seal_sec_level(params.security_bits)));
+        } else {
+            parms.set_coeff_modulus(seal::CoeffModulus::Create(n, params.coeff_modulus_bits));
+        }
+        if (params.plain_modulus) {
+            parms.set_plain_modulus(params.plain_modulus);
+        } else {
+            parms.set_plain_modulus(seal::PlainModulus::Batching(n, params.plain_modulus_bits));
+        }
+        return parms;
+    }
+
+    // galois_steps reduced into (-N/2, N/2), the range rotate_rows accepts,
+    // without duplicates. Steps that wrap to 0 would ask for a column
+    // rotation and are dropped.
+    static std::vector<int> row_steps(const ParamSet &params) {
+        int half = static_cast<int>(params.poly_modulus_degree / 2);
+        std::vector<int> steps;
+        for (int step : params.galois_steps) {
+            int reduced = step % half;
+            if (step != 0 && reduced == 0) continue;
+            if (std::find(steps.begin(), steps.end(), reduced) == steps.end()) steps.push_back(reduced);
+        }
+        return steps;
+    }
+
+    std::string cache_path(const ParamSet &params) const {
+        return key_cache_dir + "/seal_bfv_" + params.cache_key() + ".store";
+    }
+
+    static std::shared_ptr<SealKeySet> generate(const ParamSet &params) {
+        auto ks = std::make_shared<SealKeySet>();
+        ks->context = std::make_shared<seal::SEALContext>(make_parms(params), true,
+                                                          seal_sec_level(params.security_bits));
+        // Reject non-batching plain moduli before paying for key generation.
+        if (!ks->context->parameters_set() || !ks->context->first_context_data()->qualifiers().using_batching) {
+            return nullptr;
+        }
+        Timer timer;
+        timer.tic();
+        seal::KeyGenerator keygen(*ks->context);
+        ks->secret_key = keygen.secret_key();
+        keygen.create_public_key(ks->public_key);
+        ks->keygen_times.public_key_ms = timer.toc();
+        if (params.relin_keys) {
+            timer.tic();
+            keygen.create_relin_keys(ks->relin_keys);
+            ks->keygen_times.relin_keys_ms = timer.toc();
+        }
+        if (params.galois_keys) {
+            timer.tic();
+            if (params.galois_steps.empty()) {
+                keygen.create_galois_keys(ks->galois_keys);
+            } else {
+                keygen.create_galois_keys(row_steps(params), ks->galois_keys);
+            }
+            ks->keygen_times.galois_keys_ms = timer.toc();
+        }
+        ks->bind();
+        return ks;
+    }
+
+    // Key stores (see store.h) hold the parameters, secret, public, relin
+    // and Galois keys as separate entries. Stored uncompressed since key
+    // material is incompressible and load time is what we are optimizing;
+    // loading reads straight from the mapped file.
+    static void save(const SealKeySet &ks, const ParamSet &params, const std::string &path) {
+        auto none = seal::compr_mode_type::none;
+        StoreWriter store;
+        store.add("parms", [&](std::ostream &out) { ks.context->key_context_data()->parms().save(out, none); });
+        store.add("secret_key", [&](std::ostream &out) { ks.secret_key.save(out, none); });
+        store.add("public_key", [&](std::ostream &out) { ks.public_key.save(out, none); });
+        if (params.relin_keys) store.add("relin_keys", [&](std::ostream &out) { ks.relin_keys.save(out, none); });
+        if (params.galois_keys) store.add("galois_keys", [&](std::ostream &out) { ks.galois_keys.save(out, none); });
+        store.write(path);
+    }
+
+    static std::shared_ptr<SealKeySet> load(const ParamSet &params, const std::string &path) {
+        if (!std::filesystem::exists(path)) {
+            return nullptr;
+        }
+        MappedStore store(path);
+        auto ks = std::make_shared<SealKeySet>();
+        seal::EncryptionParameters parms;
+        parms.load(store.data("parms"), store.size("parms"));
+        ks->context = std::make_shared<seal::SEALContext>(parms, true, seal_sec_level(params.security_bits));
+        ks->secret_key.load(*ks->context, store.data("secret_key"), store.size("secret_key"));
+        ks->public_key.load(*ks->context, store.data("public_key"), store.size("public_key"));
+        if (params.relin_keys) ks->relin_keys.load(*ks->context, store.data("relin_keys"), store.size("relin_keys"));
+        if (params.galois_keys) {
+            ks->galois_keys.load(*ks->context, store.data("galois_keys"), store.size("galois_keys"));
+        }
+        ks->bind();
+        return ks;
+    }
+
+public:
+    SealBfvBackend() { plain_encoding_name = "coeff"; }
+
+    std::string library() const override { return "SEAL"; }
+    std::string scheme() const override { return "BFV"; }
+
+    bool setup(const ParamSet &params) override {
+        keys.reset();
+        tools = nullptr;
+        Timer timer;
+        timer.tic();
+
+        std::string key = params.cache_key();
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            keys = it->second;
+            tools = &keys->tools;
+            setup_source = "memory";
+            setup_ms = timer.toc();
+            return true;
+        }
+
+        try {
+            if (!key_cache_dir.empty()) {
+                try {
+                    keys = load(params, cache_path(params));
+                    setup_source = "disk";
+                } catch (const std::exception &e) {
+                    std::cout << "  Ignoring unreadable key file " << cache_path(params)
+                              << ": " << e.what() << std::endl;
+                    keys.reset();
+                }
+            }
+            if (!keys) {
+                keys = generate(params);
+                if (!keys) {
+                    return false;
+                }
+                setup_source = "generated";
+                if (!key_cache_dir.empty()) {
+                    try {
+                        std::filesystem::create_directories(key_cache_dir);
+                        save(*keys, params, cache_path(params));
+                    } catch (const std::exception &e) {
+                        std::cout << "  Could not persist keys to " << cache_path(params)
+                                  << ": " << e.what() << std::endl;
+                    }
+                }
+            }
+        } catch (const std::exception &) {
+            keys.reset();
+            return false;
+        }
+
+        cache[key] = keys;
+        tools = &keys->tools;
+        setup_ms = timer.toc();
+        return true;
+    }
+
+    void clear_cache() override {
+        keys.reset();
+        tools = nullptr;
+        cache.clear();
+    }
+
+    std::unique_ptr<Backend> make_worker() const override {
+        auto worker = std::make_unique<SealBfvBackend>();
+        worker->keys = keys;
+        worker->worker_tools = std::make_unique<SealTools>();
+        worker->worker_tools->bind(*keys->context, keys->public_key, keys->secret());
+        worker->tools = worker->worker_tools.get();
+        worker->pool = workers_share_pool ? pool : seal::MemoryPoolHandle::ThreadLocal();
+        worker->plain_encoding_name = plain_encoding_name;
+        return worker;
+    }
+
+    // The context (with its NTT tables) is rebuilt and the keys copied while
+    // SEAL's global profile hands out a fresh pool, so every allocation of
+    // the replica comes from that pool and is first touched here.
+    std::unique_ptr<Backend> make_replica() const override {
+        auto replica = std::make_unique<SealBfvBackend>();
+        replica->pool = seal::MemoryPoolHandle::New();
+        seal::MMProfGuard guard(std::make_unique<seal::MMProfFixed>(replica->pool));
+        auto ks = std::make_shared<SealKeySet>();
+        ks->context = std::make_shared<seal::SEALContext>(keys->context->key_context_data()->parms(), true,
+                                                          keys->context->first_context_data()->qualifiers().sec_level);
+        ks->secret_key = keys->secret_key;
+        ks->public_key = keys->public_key;
+        ks->relin_keys = keys->relin_keys;
+        ks->galois_keys = keys->galois_keys;
+        ks->keygen_times = keys->keygen_times;
+        ks->has_secret_key = keys->has_secret_key;
+        ks->bind();
+        replica->keys = ks;
+        replica->tools = &ks->tools;
+        replica->workers_share_pool = true;
+        replica->plain_encoding_name = plain_encoding_name;
+        return replica;
+    }
+
+    // Bundle: parameters, a flag byte each for relin and Galois keys, then
+    // the public key and whichever of those are present. Receivers trust the
+    // sender's parameters, so the context is built without a security check.
+    void save_eval_keys(std::ostream &out) const override {
+        auto none = seal::compr_mode_type::none;
+        bool relin = keys->relin_keys.size() > 0;
+        bool galois = keys->galois_keys.size() > 0;
+        keys->context->key_context_data()->parms().save(out, none);
+        out.put(relin ? 1 : 0);
+        out.put(galois ? 1 : 0);
+        keys->public_key.save(out, none);
+        if (relin) keys->relin_keys.save(out, none);
+        if (galois) keys->galois_keys.save(out, none);
+    }
+
+    bool setup_eval_keys(std::istream &in) override {
+        keys.reset();
+        tools = nullptr;
+        Timer timer;
+        timer.tic();
+        try {
+            auto ks = std::make_shared<SealKeySet>();
+            ks->has_secret_key = false;
+            seal::EncryptionParameters parms;
+            parms.load(in);
+            bool relin = in.get() == 1;
+            bool galois = in.get() == 1;
+            ks->context = std::make_shared<seal::SEALContext>(parms, true, seal::sec_level_type::none);
+            ks->public_key.load(*ks->context, in);
+            if (relin) ks->relin_keys.load(*ks->context, in);
+            if (galois) ks->galois_keys.load(*ks->context, in);
+            ks->bind();
+            keys = ks;
+        } catch (const std::exception &) {
+            keys.reset();
+            return false;
+        }
+        tools = &keys->tools;
+        setup_source = "eval_keys";
+        setup_ms = timer.toc();
+        return true;
+    }
+
+    size_t slot_count() const override { return tools->batch_encoder->slot_count(); }
+    size_t row_size() const override { return slot_count() / 2; }
+
+    uint64_t plain_modulus() const override {
+        return keys->context->first_context_data()->parms().plain_modulus().value();
+    }
+
+    int modulus_bits() const override {
+        return keys->context->first_context_data()->total_coeff_modulus_bit_count();
+    }
+
+    double security_level() const override {
+        return static_cast<int>(keys->context->first_context_data()->qualifiers().sec_level);
+    }
+
+    std::unique_ptr<Plain> make_plain() const override { return std::make_unique<SealPlain>(pool); }
+    std::unique_ptr<Cipher> make_cipher() const override {
+        auto cipher = std::make_unique<SealCipher>(pool);
+        if (arena_polys) cipher->ct.reserve(*keys->context, keys->context->first_parms_id(), arena_polys);
+        return cipher;
+    }
+
+    std::vector<std::string> plain_encodings() const override { return {"coeff", "ntt"}; }
+
+    void encode(const std::vector<uint64_t> &values, Plain &out) override {
+        SealPlain &p = seal_plain(out);
+        tools->batch_encoder->encode(values, p.pt);
+        p.has_ntt = plain_encoding_name == "ntt";
+        if (p.has_ntt) {
+            ProfileScope scope("ntt");
+            tools->evaluator->transform_to_ntt(p.pt, keys->context->first_parms_id(), p.ntt, pool);
+            size_t lower = keys->context->first_context_data()->chain_index();
+            p.ntt_lower.resize(lower);
+            for (size_t i = 0; i < lower; i++) {
+                p.ntt_lower[i] = i == 0 ? p.ntt : p.ntt_lower[i - 1];
+                tools->evaluator->mod_switch_to_next_inplace(p.ntt_lower[i]);
+            }
+        }
+    }
+
+    // The NTT form of p at the level of ct.
+    const seal::Plaintext &ntt_at(const SealPlain &p, const seal::Ciphertext &ct) const {
+        auto data = keys->context->get_context_data(ct.parms_id());
+        size_t first = keys->context->first_context_data()->chain_index();
+        if (!data || data->chain_index() > first) throw std::invalid_argument("ciphertext above the data level");
+        size_t depth = first - data->chain_index();
+        return depth == 0 ? p.ntt : p.ntt_lower[depth - 1];
+    }
+
+    void decode(const Plain &plain, std::vector<uint64_t> &out) override {
+        tools->batch_encoder->decode(seal_pt(plain), out, pool);
+    }
+
+    void encrypt(const Plain &plain, Cipher &out) override {
+        tools->encryptor->encrypt(seal_pt(plain), seal_ct(out), pool);
+        seal_noise(out) = keys->fresh_noise;
+    }
+
+    void decrypt(const Cipher &cipher, Plain &out) override {
+        if (!tools->decryptor) throw std::logic_error("evaluation-only key set cannot decrypt");
+        seal_plain(out).has_ntt = false;
+        tools->decryptor->decrypt(seal_ct(cipher), seal_pt(out));
+    }
+
+    double noise_budget(const Cipher &cipher) override {
+        if (!tools->decryptor) throw std::logic_error("evaluation-only key set cannot measure noise budget");
+        return tools->decryptor->invariant_noise_budget(seal_ct(cipher));
+    }
+
+    // Heuristic noise model, carried through every op of this backend so
+    // the budget can be estimated without the secret key. In log2 of the
+    // invariant noise v (budget = -log2(2v)):
+    //   encrypt            the calibrated fresh noise
+    //   add                log-sum of the inputs
+    //   add_plain          unchanged
+    //   multiply_plain     + log2(t) + log2(N) / 2, a batched plaintext's norm
+    //   multiply           log-sum of the inputs + log2(t) + log2(N) + 1
+    //   mod_switch         log-sum with the rounding term t sqrt(N) / q'
+    //   relinearize, rotations: unchanged (special-prime key switching)
+    // Ciphertexts from load_cipher() or produced through seal_evaluator()
+    // directly are not tracked.
+    double estimated_noise_budget(const Cipher &cipher) const override { return -1.0 - seal_noise(cipher); }
+
+    double cipher_modulus_bits(const Cipher &cipher) const override {
+        auto data = keys->context->get_context_data(seal_ct(cipher).parms_id());
+        return data ? data->total_coeff_modulus_bit_count() : 0;
+    }
+
+    double plain_noise_cost() const { return keys->log_t + 0.5 * keys->log_n; }
+    double product_noise(const Cipher &a, const Cipher &b) const {
+        return log2_add(seal_noise(a), seal_noise(b)) + keys->log_t + keys->log_n + 1;
+    }
+
+    void add(const Cipher &a, const Cipher &b, Cipher &out) override {
+        double noise = log2_add(seal_noise(a), seal_noise(b));
+        tools->evaluator->add(seal_ct(a), seal_ct(b), seal_ct(out));
+        seal_noise(out) = noise;
+    }
+
+    void add_plain(const Cipher &a, const Plain &b, Cipher &out) override {
+        tools->evaluator->add_plain(seal_ct(a), seal_pt(b), seal_ct(out), pool);
+        seal_noise(out) = seal_noise(a);
+    }
+
+    void multiply_plain(const Cipher &a, const Plain &b, Cipher &out) override {
+        seal_noise(out) = seal_noise(a) + plain_noise_cost();
+        const SealPlain &p = seal_plain(b);
+        if (!p.has_ntt) {
+            tools->evaluator->multiply_plain(seal_ct(a), p.pt, seal_ct(out), pool);
+        } else if (seal_ct(a).is_ntt_form()) {
+            tools->evaluator->multiply_plain(seal_ct(a), ntt_at(p, seal_ct(a)), seal_ct(out), pool);
+        } else {
+            {
+                ProfileScope scope("ntt");
+                tools->evaluator->transform_to_ntt(seal_ct(a), seal_ct(out));
+            }
+            tools->evaluator->multiply_plain_inplace(seal_ct(out), ntt_at(p, seal_ct(out)), pool);
+            ProfileScope scope("ntt");
+            tools->evaluator->transform_from_ntt_inplace(seal_ct(out));
+        }
+    }
+
+    // Profile scopes: "tensor" is SEAL's whole BFV multiply, whose BEHZ base
+    // conversions and NTTs happen inside the library; "key_switch" is the
+    // relinearization.
+    void multiply(const Cipher &a, const Cipher &b, Cipher &out) override {
+        double noise = product_noise(a, b);
+        {
+            ProfileScope scope("tensor");
+            tools->evaluator->multiply(seal_ct(a), seal_ct(b), seal_ct(out), pool);
+        }
+        {
+            ProfileScope scope("key_switch");
+            tools->evaluator->relinearize_inplace(seal_ct(out), keys->relin_keys, pool);
+        }
+        seal_noise(out) = noise;
+    }
+
+    void add_inplace(Cipher &a, const Cipher &b) override {
+        tools->evaluator->add_inplace(seal_ct(a), seal_ct(b));
+        seal_noise(a) = log2_add(seal_noise(a), seal_noise(b));
+    }
+
+    void add_plain_inplace(Cipher &a, const Plain &b) override {
+        tools->evaluator->add_plain_inplace(seal_ct(a), seal_pt(b), pool);
+    }
+
+    void multiply_plain_inplace(Cipher &a, const Plain &b) override {
+        seal_noise(a) += plain_noise_cost();
+        const SealPlain &p = seal_plain(b);
+        if (!p.has_ntt) {
+            tools->evaluator->multiply_plain_inplace(seal_ct(a), p.pt, pool);
+            return;
+        }
+        bool ntt_form = seal_ct(a).is_ntt_form();
+        if (!ntt_form) to_ntt(a);
+        tools->evaluator->multiply_plain_inplace(seal_ct(a), ntt_at(p, seal_ct(a)), pool);
+        if (!ntt_form) from_ntt(a);
+    }
+
+    bool to_ntt(Cipher &c) override {
+        ProfileScope scope("ntt");
+        if (!seal_ct(c).is_ntt_form()) tools->evaluator->transform_to_ntt_inplace(seal_ct(c));
+        return true;
+    }
+
+    bool from_ntt(Cipher &c) override {
+        ProfileScope scope("ntt");
+        if (seal_ct(c).is_ntt_form()) tools->evaluator->transform_from_ntt_inplace(seal_ct(c));
+        return true;
+    }
+
+    void multiply_inplace(Cipher &a, const Cipher &b) override {
+        double noise = product_noise(a, b);
+        {
+            ProfileScope scope("tensor");
+            tools->evaluator->multiply_inplace(seal_ct(a), seal_ct(b), pool);
+        }
+        {
+            ProfileScope scope("key_switch");
+            tools->evaluator->relinearize_inplace(seal_ct(a), keys->relin_keys, pool);
+        }
+        seal_noise(a) = noise;
+    }
+
+    void copy_cipher(const Cipher &from, Cipher &to) override {
+        seal_ct(to) = seal_ct(from);
+        seal_noise(to) = seal_noise(from);
+    }
+    void move_cipher(Cipher &from, Cipher &to) override {
+        seal_ct(to) = std::move(seal_ct(from));
+        seal_noise(to) = seal_noise(from);
+    }
+
+    void multiply_no_relin(const Cipher &a, const Cipher &b, Cipher &out) override {
+        double noise = product_noise(a, b);
+        {
+            ProfileScope scope("tensor");
+            tools->evaluator->multiply(seal_ct(a), seal_ct(b), seal_ct(out), pool);
+        }
+        seal_noise(out) = noise;
+    }
+
+    void relinearize(Cipher &c) override {
+        ProfileScope scope("key_switch");
+        tools->evaluator->relinearize_inplace(seal_ct(c), keys->relin_keys, pool);
+    }
+
+    bool mod_switch(Cipher &c) override {
+        auto data = keys->context->get_context_data(seal_ct(c).parms_id());
+        if (!data || !data->next_context_data()) return false;
+        {
+            ProfileScope scope("mod_switch");
+            tools->evaluator->mod_switch_to_next_inplace(seal_ct(c), pool);
+        }
+        double rounding = plain_noise_cost() + 1 - data->next_context_data()->total_coeff_modulus_bit_count();
+        seal_noise(c) = log2_add(seal_noise(c), rounding);
+        return true;
+    }
+
+    void rotate(const Cipher &a, int steps, Cipher &out) override {
+        ProfileScope scope("key_switch");
+        tools->evaluator->rotate_rows(seal_ct(a), steps, keys->galois_keys, seal_ct(out), pool);
+        seal_noise(out) = seal_noise(a);
+    }
+
+    void rotate_columns(const Cipher &a, Cipher &out) override {
+        ProfileScope scope("key_switch");
+        tools->evaluator->rotate_columns(seal_ct(a), keys->galois_keys, seal_ct(out), pool);
+        seal_noise(out) = seal_noise(a);
+    }
+
+    size_t cipher_bytes(const Cipher &cipher) const override {
+        const auto &ct = seal_ct(cipher);
+        return ct.size() * ct.coeff_modulus_size() * ct.poly_modulus_degree() * sizeof(uint64_t);
+    }
+
+    std::vector<std::string> wire_formats() const override {
+        std::vector<std::string> formats = {"none"};
+        if (seal::Serialization::IsSupportedComprMode(seal::compr_mode_type::zlib)) formats.push_back("zlib");
+        if (seal::Serialization::IsSupportedComprMode(seal::compr_mode_type::zstd)) formats.push_back("zstd");
+        return formats;
+    }
+
+    size_t save_cipher(const Cipher &cipher, const std::string &format, std::ostream &out) const override {
+        return static_cast<size_t>(seal_ct(cipher).save(out, seal_compr_mode(format)));
+    }
+
+    void load_cipher(std::istream &in, Cipher &out) override {
+        seal_ct(out).load(*keys->context, in);
+        seal_noise(out) = std::nan("");
+    }
+
+    size_t save_seeded(const Plain &plain, const std::string &format, std::ostream &out) override {
+        auto seeded = tools->encryptor->encrypt_symmetric(seal_pt(plain), pool);
+        return static_cast<size_t>(seeded.save(out, seal_compr_mode(format)));
+    }
+
+    KeySizes key_sizes() const override {
+        auto none = seal::compr_mode_type::none;
+        KeySizes sizes;
+        sizes.public_key = static_cast<size_t>(keys->public_key.save_size(none));
+        if (keys->relin_keys.size()) sizes.relin_keys = static_cast<size_t>(keys->relin_keys.save_size(none));
+        if (keys->galois_keys.size()) sizes.galois_keys = static_cast<size_t>(keys->galois_keys.save_size(none));
+        sizes.galois_key_count = keys->galois_keys.size();
+        return sizes;
+    }
+
+    KeyGenTimes keygen_times() const override { return keys->keygen_times; }
+
+    void begin_memory_probe() override {
+        saved_pool = pool;
+        pool = seal::MemoryPoolHandle::New();
+    }
+
+    size_t end_memory_probe() override {
+        size_t bytes = pool.alloc_byte_count();
+        pool = saved_pool;
+        return bytes;
+    }
+
+    void begin_arena(size_t polys) override {
+        arena_saved_pool = pool;
+        pool = seal::MemoryPoolHandle::New();
+        arena_polys = polys;
+    }
+
+    void end_arena() override {
+        pool = arena_saved_pool;
+        arena_polys = 0;
+    }
+
+    const seal::SEALContext &seal_context() const { return *keys->context; }
+    seal::Evaluator &seal_evaluator() { return *tools->evaluator; }
+    seal::Decryptor &seal_decryptor() { return *tools->decryptor; }
+    const seal::MemoryPoolHandle &memory_pool() const { return pool; }
+    const SealKeySet &key_set() const { return *keys; }
+};
+
+// CKKS context, keys and the tools bound to them for one ParamSet.
+struct SealCkksKeySet {
+    std::shared_ptr<seal::SEALContext> context;
+    seal::SecretKey secret_key;
+    seal::PublicKey public_key;
+    seal::RelinKeys relin_keys;
+    std::unique_ptr<seal::Encryptor> encryptor;
+    std::unique_ptr<seal::Evaluator> evaluator;
+    std::unique_ptr<seal::Decryptor> decryptor;
+    std::unique_ptr<seal::CKKSEncoder> encoder;
+};
+
+// Microsoft SEAL, CKKS scheme. ParamSet::coeff_modulus_bits is the whole
+// chain, special prime last (see seal_ckks_params); the scale is
+// 2^ckks_scale_bits.
+class SealCkksBackend : public CkksBackend {
+private:
+    std::map<std::string, std::shared_ptr<SealCkksKeySet>> cache;
+    std::shared_ptr<SealCkksKeySet> keys;
+    double scale = 0;
+    seal::MemoryPoolHandle pool = seal::MemoryManager::GetPool();
+
+    static std::shared_ptr<SealCkksKeySet> generate(const ParamSet &params) {
+        size_t n = params.poly_modulus_degree;
+        seal::EncryptionParameters parms(seal::scheme_type::ckks);
+        parms.set_poly_modulus_degree(n);
+        parms.set_coeff_modulus(seal::CoeffModulus::Create(n, params.coeff_modulus_bits));
+
+        auto ks = std::make_shared<SealCkksKeySet>();
+        ks->context = std::make_shared<seal::SEALContext>(parms, true, seal_sec_level(params.security_bits));
+        if (!ks->context->parameters_set()) {
+            return nullptr;
+        }
+        seal::KeyGenerator keygen(*ks->context);
+        ks->secret_key = keygen.secret_key();
+        keygen.create_public_key(ks->public_key);
+        keygen.create_relin_keys(ks->relin_keys);
+        ks->encryptor = std::make_unique<seal::Encryptor>(*ks->context, ks->public_key);
+        ks->evaluator = std::make_unique<seal::Evaluator>(*ks->context);
+        ks->decryptor = std::make_unique<seal::Decryptor>(*ks->context, ks->secret_key);
+        ks->encoder = std::make_unique<seal::CKKSEncoder>(*ks->context);
+        return ks;
+    }
+
+    size_t chain_index(const seal::Ciphertext &ct) const {
+        return keys->context->get_context_data(ct.parms_id())->chain_index();
+    }
+
+    // SEAL only combines operands at one level, and adds them only at one
+    // scale. The operand further up the chain is switched down into a copy;
+    // for additions the copy also takes the other operand's scale, which
+    // after a rescale differs from it by the ratio of the prime to 2^scale.
+    // That error is part of what the precision columns measure.
+    template <typename Fn>
+    void with_matched(const seal::Ciphertext &x, const seal::Ciphertext &y, bool match_scale, Fn &&fn) const {
+        size_t lx = chain_index(x), ly = chain_index(y);
+        if (lx == ly && (!match_scale || x.scale() == y.scale())) {
+            fn(x, y);
+            return;
+        }
+        seal::Ciphertext tmp(pool);
+        if (lx >= ly) {
+            tmp = x;
+            keys->evaluator->mod_switch_to_inplace(tmp, y.parms_id(), pool);
+            if (match_scale) tmp.scale() = y.scale();
+            fn(tmp, y);
+        } else {
+            tmp = y;
+            keys->evaluator->mod_switch_to_inplace(tmp, x.parms_id(), pool);
+            if (match_scale) tmp.scale() = x.scale();
+            fn(x, tmp);
+        }
+    }
+
+    // Plaintexts are encoded at the top level; below it a copy is switched
+    // down to the ciphertext's level.
+    template <typename Fn>
+    void with_plain_at(const seal::Ciphertext &ct, const seal::Plaintext &pt, Fn &&fn) const {
+        if (pt.parms_id() == ct.parms_id()) {
+            fn(pt);
+            return;
+        }
+        seal::Plaintext tmp(pool);
+        tmp = pt;
+        keys->evaluator->mod_switch_to_inplace(tmp, ct.parms_id());
+        fn(tmp);
+    }
+
+public:
+    std::string library() const override { return "SEAL"; }
+
+    bool setup(const ParamSet &params) override {
+        keys.reset();
+        Timer timer;
+        timer.tic();
+        std::string key = params.cache_key() + "_ckks" + std::to_string(params.ckks_scale_bits);
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            keys = it->second;
+        } else {
+            try {
+                keys = generate(params);
+            } catch (const std::exception &) {
+                keys.reset();
+            }
+            if (!keys) {
+                return false;
+            }
+            cache[key] = keys;
+        }
+        scale = std::pow(2.0, params.ckks_scale_bits);
+        setup_ms = timer.toc();
+        return true;
+    }
+
+    void clear_cache() override {
+        keys.reset();
+        cache.clear();
+    }
+
+    size_t slot_count() const override { return keys->encoder->slot_count(); }
+
+    int modulus_bits() const override {
+        return keys->context->first_context_data()->total_coeff_modulus_bit_count();
+    }
+
+    double security_level() const override {
+        return static_cast<int>(keys->context->first_context_data()->qualifiers().sec_level);
+    }
+
+    int scale_bits() const override { return static_cast<int>(std::lround(std::log2(scale))); }
+
+    std::unique_ptr<Plain> make_plain() const override { return std::make_unique<SealPlain>(pool); }
+    std::unique_ptr<Cipher> make_cipher() const override { return std::make_unique<SealCipher>(pool); }
+
+    void encode(const std::vector<double> &values, Plain &out) override {
+        keys->encoder->encode(values, keys->context->first_parms_id(), scale, seal_pt(out), pool);
+    }
+
+    void decode(const Plain &plain, std::vector<double> &out) override {
+        keys->encoder->decode(seal_pt(plain), out, pool);
+    }
+
+    void encrypt(const Plain &plain, Cipher &out) override {
+        keys->encryptor->encrypt(seal_pt(plain), seal_ct(out), pool);
+    }
+
+    void decrypt(const Cipher &cipher, Plain &out) override {
+        keys->decryptor->decrypt(seal_ct(cipher), seal_pt(out));
+    }
+
+    double capacity_bits(const Cipher &cipher) const override {
+        const auto &ct = seal_ct(cipher);
+        return keys->context->get_context_data(ct.parms_id())->total_coeff_modulus_bit_count() -
+               std::log2(ct.scale());
+    }
+
+    void add(const Cipher &a, const Cipher &b, Cipher &out) override {
+        with_matched(seal_ct(a), seal_ct(b), true, [&](const seal::Ciphertext &x, const seal::Ciphertext &y) {
+            keys->evaluator->add(x, y, seal_ct(out));
+        });
+    }
+
+    // The sum takes the plaintext's scale, as with_matched() does for
+    // ciphertexts; a's scale must be close to it (fresh or rescaled).
+    void add_plain(const Cipher &a, const Plain &b, Cipher &out) override {
+        const auto &ct = seal_ct(a);
+        with_plain_at(ct, seal_pt(b), [&](const seal::Plaintext &pt) {
+            seal_ct(out) = ct;
+            seal_ct(out).scale() = scale;
+            keys->evaluator->add_plain_inplace(seal_ct(out), pt, pool);
+        });
+    }
+
+    void multiply_plain(const Cipher &a, const Plain &b, Cipher &out) override {
+        const auto &ct = seal_ct(a);
+        with_plain_at(ct, seal_pt(b), [&](const seal::Plaintext &pt) {
+            keys->evaluator->multiply_plain(ct, pt, seal_ct(out), pool);
+        });
+    }
+
+    void multiply(const Cipher &a, const Cipher &b, Cipher &out) override {
+        with_matched(seal_ct(a), seal_ct(b), false, [&](const seal::Ciphertext &x, const seal::Ciphertext &y) {
+            keys->evaluator->multiply(x, y, seal_ct(out), pool);
+        });
+        keys->evaluator->relinearize_inplace(seal_ct(out), keys->relin_keys, pool);
+    }
+
+    // Throws at the last level, where there is nothing left to drop.
+    bool rescale(Cipher &c) override {
+        keys->evaluator->rescale_to_next_inplace(seal_ct(c), pool);
+        return true;
+    }
+
+    void copy_cipher(const Cipher &from, Cipher &to) override { seal_ct(to) = seal_ct(from); }
+
+    size_t cipher_bytes(const Cipher &cipher) const override {
+        const auto &ct = seal_ct(cipher);
+        return ct.size() * ct.coeff_modulus_size() * ct.poly_modulus_degree() * sizeof(uint64_t);
+    }
+};
+
+// Candidate parameter lists carried over from the original same.cpp /
+// rotation.cpp drivers: small degrees need hand-picked coefficient moduli,
+// and every degree falls back to BFVDefault with a 16-bit batching prime.
+inline std::vector<ParamSet> seal_candidate_params(size_t poly_modulus_degree, bool galois_keys = false) {
+    std::vector<std::vector<int>> coeff_modulus_options;
+    std::vector<uint64_t> plain_modulus_options = {65537, 12289, 40961, 114689};
+
+    if (poly_modulus_degree == 1024) {
+        coeff_modulus_options = {{27, 27}, {30, 30}, {27, 27, 27}, {20, 20}};
+    } else if (poly_modulus_degree == 2048) {
+        coeff_modulus_options = {{36, 36, 37}, {30, 30, 30}, {36, 36}, {27, 27, 27}};
+    } else if (poly_modulus_degree == 4096) {
+        coeff_modulus_options = {{36, 36, 37}, {43, 43, 44}, {36, 36}};
+    } else if (poly_modulus_degree == 8192 || poly_modulus_degree == 16384) {
+        coeff_modulus_options = {{43, 43, 44, 44}, {50, 50, 50, 50}};
+    } else if (poly_modulus_degree == 32768) {
+        coeff_modulus_options = {{50, 50, 50, 50, 50}, {60, 60, 60, 60, 60}};
+    }
+
+    std::vector<ParamSet> candidates;
+    for (const auto &coeff_modulus : coeff_modulus_options) {
+        for (auto plain_mod : plain_modulus_options) {
+            ParamSet p;
+            p.poly_modulus_degree = poly_modulus_degree;
+            p.coeff_modulus_bits = coeff_modulus;
+            p.plain_modulus = plain_mod;
+            p.galois_keys = galois_keys;
+            candidates.push_back(p);
+        }
+    }
+
+    ParamSet fallback;
+    fallback.poly_modulus_degree = poly_modulus_degree;
+    if (poly_modulus_degree == 1024) {
+        fallback.coeff_modulus_bits = {20, 20};
+    } else if (poly_modulus_degree == 2048) {
+        fallback.coeff_modulus_bits = {27, 27, 27};
+    }
+    fallback.plain_modulus_bits = 16;
+    fallback.galois_keys = galois_keys;
+    candidates.push_back(fallback);
+    return candidates;
+}
+
+// Search space of the parameter optimizer (param_search.h): the BFVDefault
+// chain plus, for every prime size, each chain of 2..k equal-size primes
+// that fits the security level's modulus budget. Data primes share one size
+// so the chains differ in one dimension at a time.
+inline std::vector<ParamSet> seal_search_params(size_t poly_modulus_degree, int plain_bits, int security_bits,
+                                                const std::vector<int> &prime_bits = {30, 40, 50, 60}) {
+    ParamSet base;
+    base.poly_modulus_degree = poly_modulus_degree;
+    base.plain_modulus_bits = plain_bits;
+    base.security_bits = security_bits;
+
+    std::vector<ParamSet> candidates = {base};
+    int budget = seal::CoeffModulus::MaxBitCount(poly_modulus_degree, seal_sec_level(security_bits));
+    for (int bits : prime_bits) {
+        for (int count = 2; count * bits <= budget; count++) {
+            ParamSet p = base;
+            p.coeff_modulus_bits.assign(count, bits);
+            candidates.push_back(p);
+        }
+    }
+    return candidates;
+}
+
+// SEAL defaults: BFVDefault coefficient modulus and a 20-bit batching prime,
+// as used by the original different.cpp driver.
+inline std::vector<ParamSet> seal_default_params(size_t poly_modulus_degree, bool galois_keys = false) {
+    ParamSet p;
+    p.poly_modulus_degree = poly_modulus_degree;
+    p.plain_modulus_bits = 20;
+    p.galois_keys = galois_keys;
+    return {p};
+}
+
+// CKKS chains for one degree, largest scale first: an outer prime of
+// scale + 20 bits (at most 60) at both ends, for the integer part of the
+// first level and the special prime, and as many scale-sized primes in
+// between as the 128-bit budget allows. Scales without room for one level
+// are skipped.
+inline std::vector<ParamSet> seal_ckks_params(size_t poly_modulus_degree,
+                                              const std::vector<int> &scale_bits = {40, 30, 20}) {
+    int budget = seal::CoeffModulus::MaxBitCount(poly_modulus_degree);
+    std::vector<ParamSet> candidates;
+    for (int bits : scale_bits) {
+        int outer = std::min(60, bits + 20);
+        int levels = (budget - 2 * outer) / bits;
+        if (levels < 1) continue;
+        ParamSet p;
+        p.poly_modulus_degree = poly_modulus_degree;
+        p.ckks_scale_bits = bits;
+        p.coeff_modulus_bits.push_back(outer);
+        p.coeff_modulus_bits.insert(p.coeff_modulus_bits.end(), static_cast<size_t>(levels), bits);
+        p.coeff_modulus_bits.push_back(outer);
+        candidates.push_back(p);
+    }
+    return candidates;
+}
+
+} // namespace bench
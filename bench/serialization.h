@@ -0,0 +1,203 @@
+#pragma once
+
+#include "backend.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+inline ColumnSet serialization_columns() {
+    return keyed_columns(
+        result_columns(concat_columns({
+            {"ciphertext", "format", "seeded", "wire_bytes", "memory_bytes", "wire_ratio"},
+            stats_columns("serialize"),
+            stats_columns("deserialize"),
+            {"valid"}})),
+        {"ciphertext", "format", "seeded"});
+}
+
+inline ColumnSet serialization_stream_columns() {
+    return keyed_columns(
+        result_columns(concat_columns({
+            {"mode", "format", "num_ciphertexts", "wire_bytes"},
+            stats_columns("stream"),
+            {"ciphertexts_per_s", "valid"}})),
+        {"mode", "format", "num_ciphertexts"});
+}
+
+// Evaluates `a[i] * a[i]` for every input and serializes each product into
+// wire[i]. With double buffering the product i is serialized on a second
+// thread while product i + 1 is computed; two result buffers alternate, so
+// a buffer is only rewritten after its previous serialization finished.
+inline void stream_products(Backend &backend, const std::vector<std::unique_ptr<Cipher>> &a,
+                            std::vector<std::unique_ptr<Cipher>> &buffers, const std::string &format,
+                            bool double_buffered, std::vector<std::string> &wire) {
+    auto serialize = [&](const Cipher &c, size_t i) {
+        std::ostringstream out;
+        backend.save_cipher(c, format, out);
+        wire[i] = out.str();
+    };
+    std::future<void> pending;
+    for (size_t i = 0; i < a.size(); i++) {
+        Cipher &result = *buffers[double_buffered ? i % 2 : 0];
+        backend.multiply(*a[i], *a[i], result);
+        if (!double_buffered) {
+            serialize(result, i);
+            continue;
+        }
+        if (pending.valid()) pending.get();
+        pending = std::async(std::launch::async, serialize, std::cref(result), i);
+    }
+    if (pending.valid()) pending.get();
+}
+
+// Wire size and (de)serialization latency of a fresh and a multiplied
+// ciphertext in every wire format of the backend, plus the seeded
+// symmetric-key encryption where the backend has one ("serialize" then
+// includes the encryption). Loaded ciphertexts are decrypted to check them.
+//
+// Streaming: stream_ciphertexts products computed and serialized one after
+// the other, then with serialization overlapped on a second thread, in the
+// most compact wire format.
+inline void run_serialization_sweep(Backend &backend, const SweepConfig &config, size_t stream_ciphertexts,
+                                    CsvLog &log, CsvLog &stream_log) {
+    OperandSource source(config);
+    const TimingConfig &timing = config.timing;
+
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " serialization PolyModulus=" << degree << " ===" << std::endl;
+        if (!setup_first_working(backend, sweep_candidates(config, degree))) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        size_t slot_count = backend.slot_count();
+        uint64_t t = backend.plain_modulus();
+        std::vector<std::string> formats = backend.wire_formats();
+
+        try {
+            std::vector<uint64_t> data, squared(slot_count), decoded;
+            source.fill_a(data, slot_count, slot_count);
+            for (size_t j = 0; j < slot_count; j++) {
+                squared[j] = expected_value(OpType::CipherMulCipher, data[j], data[j], t);
+            }
+            auto plain = backend.make_plain();
+            auto scratch = backend.make_plain();
+            auto fresh = backend.make_cipher();
+            auto product = backend.make_cipher();
+            auto loaded = backend.make_cipher();
+            backend.encode(data, *plain);
+            backend.encrypt(*plain, *fresh);
+            backend.multiply(*fresh, *fresh, *product);
+
+            auto loads_as = [&](const std::string &wire, const std::vector<uint64_t> &expected) {
+                std::istringstream in(wire);
+                backend.load_cipher(in, *loaded);
+                backend.decrypt(*loaded, *scratch);
+                backend.decode(*scratch, decoded);
+                return decoded == expected;
+            };
+            auto log_format = [&](const char *ciphertext, const std::string &format, bool seeded,
+                                  size_t memory_bytes, const std::string &wire, const Stats &save_stats,
+                                  const std::vector<uint64_t> &expected) {
+                Stats load_stats = measure(timing, [&] {
+                    std::istringstream in(wire);
+                    backend.load_cipher(in, *loaded);
+                });
+                bool valid = loads_as(wire, expected);
+                double ratio = memory_bytes ? static_cast<double>(wire.size()) / memory_bytes : 0;
+                log.row(backend.library(), backend.scheme(), degree, slot_count, ciphertext, format,
+                        seeded ? 1 : 0, wire.size(), memory_bytes, ratio, save_stats, load_stats, valid ? 1 : 0);
+                std::cout << "  " << ciphertext << " " << format << (seeded ? " seeded" : "") << ": "
+                          << wire.size() / 1024 << " KB on the wire (" << static_cast<int>(ratio * 100)
+                          << "% of memory), save " << save_stats.median_ms << " ms, load "
+                          << load_stats.median_ms << " ms" << (valid ? "" : ", INVALID") << std::endl;
+            };
+
+            // The payload of a seeded ciphertext once loaded is that of a
+            // fresh one.
+            size_t fresh_bytes = backend.cipher_bytes(*fresh);
+            for (const auto &format : formats) {
+                std::string wire;
+                auto save = [&](const Cipher &c) {
+                    std::ostringstream out;
+                    backend.save_cipher(c, format, out);
+                    wire = out.str();
+                };
+                Stats stats = measure(timing, [&] { save(*fresh); });
+                log_format("fresh", format, false, fresh_bytes, wire, stats, data);
+                stats = measure(timing, [&] { save(*product); });
+                log_format("product", format, false, backend.cipher_bytes(*product), wire, stats, squared);
+
+                std::ostringstream probe;
+                if (backend.save_seeded(*plain, format, probe) == 0) continue;
+                stats = measure(timing, [&] {
+                    std::ostringstream out;
+                    backend.save_seeded(*plain, format, out);
+                    wire = out.str();
+                });
+                log_format("fresh", format, true, fresh_bytes, wire, stats, data);
+            }
+        } catch (const std::exception &e) {
+            std::cout << "Error with PolyModulus: " << degree << " - " << e.what() << std::endl;
+            continue;
+        }
+
+        if (stream_ciphertexts == 0) continue;
+        try {
+            const std::string &format = formats.back();
+            std::vector<std::vector<uint64_t>> data(stream_ciphertexts);
+            std::vector<std::unique_ptr<Cipher>> inputs, buffers;
+            auto plain = backend.make_plain();
+            for (size_t i = 0; i < stream_ciphertexts; i++) {
+                source.fill_a(data[i], slot_count, slot_count);
+                backend.encode(data[i], *plain);
+                inputs.push_back(backend.make_cipher());
+                backend.encrypt(*plain, *inputs[i]);
+            }
+            buffers.push_back(backend.make_cipher());
+            buffers.push_back(backend.make_cipher());
+            auto loaded = backend.make_cipher();
+            std::vector<std::string> wire(stream_ciphertexts);
+            std::vector<uint64_t> decoded;
+
+            for (bool double_buffered : {false, true}) {
+                const char *mode = double_buffered ? "double_buffered" : "sequential";
+                Stats stats = measure(timing, [&] {
+                    stream_products(backend, inputs, buffers, format, double_buffered, wire);
+                });
+                bool valid = true;
+                size_t wire_bytes = 0;
+                for (size_t i = 0; i < stream_ciphertexts; i++) {
+                    wire_bytes += wire[i].size();
+                    std::istringstream in(wire[i]);
+                    backend.load_cipher(in, *loaded);
+                    backend.decrypt(*loaded, *plain);
+                    backend.decode(*plain, decoded);
+                    for (size_t j = 0; j < slot_count && valid; j++) {
+                        valid = decoded[j] == expected_value(OpType::CipherMulCipher, data[i][j], data[i][j], t);
+                    }
+                }
+                double per_s = stats.median_ms > 0 ? stream_ciphertexts * 1000.0 / stats.median_ms : 0;
+                stream_log.row(backend.library(), backend.scheme(), degree, slot_count, mode, format,
+                               stream_ciphertexts, wire_bytes, stats, per_s, valid ? 1 : 0);
+                std::cout << "  Stream " << mode << " (" << format << "): " << stream_ciphertexts
+                          << " products in " << stats.median_ms << " ms, " << per_s << " ciphertexts/s"
+                          << (valid ? "" : ", INVALID") << std::endl;
+            }
+        } catch (const std::exception &e) {
+            std::cout << "Error with PolyModulus: " << degree << " streaming - " << e.what() << std::endl;
+        }
+    }
+}
+
+} // namespace bench
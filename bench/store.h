@@ -0,0 +1,197 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Flat on-disk container for contexts, key material and ciphertexts. The
+// file is a header and a table of named entries followed by the entries'
+// serialized bytes, each starting on a 64-byte boundary:
+//
+//   header  8-byte magic "HEBSTOR1", uint64 entry count
+//   table   per entry: 48-byte zero-padded name, uint64 offset, uint64 size
+//   data    entry payloads at their offsets
+//
+// Readers map the whole file read-only and hand the libraries pointers into
+// the mapping, so opening a store copies nothing up front and pages are
+// only read as the entries they hold are loaded.
+constexpr char StoreMagic[8] = {'H', 'E', 'B', 'S', 'T', 'O', 'R', '1'};
+constexpr size_t StoreNameBytes = 48;
+constexpr size_t StoreAlignment = 64;
+
+struct StoreEntry {
+    char name[StoreNameBytes];
+    uint64_t offset;
+    uint64_t size;
+};
+
+// Collects entries in memory and writes them as one store file. write()
+// goes through a temporary file and a rename, so readers never see a
+// partial store.
+class StoreWriter {
+private:
+    std::vector<std::string> names;
+    std::vector<std::string> payloads;
+
+public:
+    void add(const std::string &name, const std::function<void(std::ostream &)> &serialize) {
+        if (name.size() >= StoreNameBytes) throw std::invalid_argument("store entry name too long: " + name);
+        std::ostringstream out(std::ios::binary);
+        serialize(out);
+        names.push_back(name);
+        payloads.push_back(out.str());
+    }
+
+    void write(const std::string &path) const {
+        std::vector<StoreEntry> table(names.size());
+        uint64_t offset = sizeof(StoreMagic) + sizeof(uint64_t) + table.size() * sizeof(StoreEntry);
+        for (size_t i = 0; i < table.size(); i++) {
+            std::memset(&table[i], 0, sizeof(StoreEntry));
+            std::memcpy(table[i].name, names[i].data(), names[i].size());
+            offset = (offset + StoreAlignment - 1) / StoreAlignment * StoreAlignment;
+            table[i].offset = offset;
+            table[i].size = payloads[i].size();
+            offset += payloads[i].size();
+        }
+
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            uint64_t count = table.size();
+            out.write(StoreMagic, sizeof(StoreMagic));
+            out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+            out.write(reinterpret_cast<const char *>(table.data()),
+                      static_cast<std::streamsize>(table.size() * sizeof(StoreEntry)));
+            for (size_t i = 0; i < table.size(); i++) {
+                std::string padding(table[i].offset - static_cast<uint64_t>(out.tellp()), '\0');
+                out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+                out.write(payloads[i].data(), static_cast<std::streamsize>(payloads[i].size()));
+            }
+            if (!out) throw std::runtime_error("could not write store " + tmp);
+        }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("could not move store into place at " + path);
+        }
+    }
+};
+
+// Writes the file's dirty pages back and asks the kernel to drop its cached
+// pages, so the next read comes from the device. Returns false if the file
+// cannot be opened or the advice is refused; the kernel may still keep pages
+// that are mapped elsewhere.
+inline bool evict_from_page_cache(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = ::fdatasync(fd) == 0 && ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    ::close(fd);
+    return ok;
+}
+
+// Read-only istream over a byte range, for libraries that only read from
+// streams (HElib, and SEAL objects without a pointer overload).
+class MemoryStreamBuf : public std::streambuf {
+public:
+    MemoryStreamBuf(const std::byte *data, size_t size) {
+        char *begin = const_cast<char *>(reinterpret_cast<const char *>(data));
+        setg(begin, begin, begin + size);
+    }
+};
+
+class MemoryIStream : private MemoryStreamBuf, public std::istream {
+public:
+    MemoryIStream(const std::byte *data, size_t size)
+        : MemoryStreamBuf(data, size), std::istream(static_cast<MemoryStreamBuf *>(this)) {}
+};
+
+// A store file mapped into memory. Throws std::runtime_error if the file
+// cannot be mapped or is not a store.
+class MappedStore {
+private:
+    const std::byte *base = nullptr;
+    size_t length = 0;
+    std::vector<StoreEntry> table;
+
+public:
+    explicit MappedStore(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("could not open store " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(StoreMagic) + sizeof(uint64_t))) {
+            ::close(fd);
+            throw std::runtime_error("not a store: " + path);
+        }
+        length = static_cast<size_t>(st.st_size);
+        void *mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) throw std::runtime_error("could not map store " + path);
+        base = static_cast<const std::byte *>(mapped);
+
+        uint64_t count = 0;
+        std::memcpy(&count, base + sizeof(StoreMagic), sizeof(count));
+        size_t table_end = sizeof(StoreMagic) + sizeof(uint64_t) + count * sizeof(StoreEntry);
+        if (std::memcmp(base, StoreMagic, sizeof(StoreMagic)) != 0 || table_end > length) {
+            unmap();
+            throw std::runtime_error("not a store: " + path);
+        }
+        table.resize(count);
+        std::memcpy(table.data(), base + sizeof(StoreMagic) + sizeof(uint64_t), count * sizeof(StoreEntry));
+        for (const auto &e : table) {
+            if (e.offset + e.size > length) {
+                unmap();
+                throw std::runtime_error("truncated store: " + path);
+            }
+        }
+    }
+
+    ~MappedStore() { unmap(); }
+
+    MappedStore(const MappedStore &) = delete;
+    MappedStore &operator=(const MappedStore &) = delete;
+
+    bool has(const std::string &name) const { return find(name) != nullptr; }
+
+    // Start and size of an entry's bytes; throws if there is no such entry.
+    const std::byte *data(const std::string &name) const { return base + entry(name).offset; }
+    size_t size(const std::string &name) const { return static_cast<size_t>(entry(name).size); }
+
+    MemoryIStream stream(const std::string &name) const { return MemoryIStream(data(name), size(name)); }
+
+    size_t file_bytes() const { return length; }
+
+private:
+    const StoreEntry *find(const std::string &name) const {
+        for (const auto &e : table) {
+            if (name.size() < StoreNameBytes && std::strncmp(e.name, name.c_str(), StoreNameBytes) == 0) return &e;
+        }
+        return nullptr;
+    }
+
+    const StoreEntry &entry(const std::string &name) const {
+        const StoreEntry *e = find(name);
+        if (!e) throw std::runtime_error("store has no entry " + name);
+        return *e;
+    }
+
+    void unmap() {
+        if (base) ::munmap(const_cast<std::byte *>(base), length);
+        base = nullptr;
+    }
+};
+
+} // namespace bench
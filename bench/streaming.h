@@ -0,0 +1,409 @@
+#pragma once
+
+#include "backend.h"
+#include "depth.h"
+#include "memory.h"
+#include "net.h"
+#include "options.h"
+#include "results.h"
+#include "timer.h"
+#include "workloads.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Streaming aggregation: records of `fields` values are packed
+// slot_count / fields to a ciphertext and folded into a running encrypted
+// sum and product per slot, with only `window` fresh ciphertexts in memory
+// at a time.
+struct StreamConfig {
+    // "" for synthetic records, "-" for stdin, "tcp:PORT" for the first
+    // producer to connect to PORT, anything else a file. Synthetic records
+    // hold uniform values in [1, SweepConfig::random_max].
+    std::string input;
+    size_t records = 100000;  // length of the synthetic stream
+    size_t fields = 4;
+    size_t window = 8;
+
+    // Bits of noise budget an accumulator keeps in reserve beyond the
+    // largest drop one fold into it has caused since it was last restarted;
+    // below that it is decrypted into the running result and restarted.
+    double budget_margin = 1;
+
+    // An accumulator is switched to the next modulus when that costs at
+    // most this many bits of budget.
+    double switch_cost_bits = 1;
+};
+
+// Stream options:
+//   --stream-input=SRC   records from a file, "-" (stdin) or tcp:PORT
+//   --records=N          synthetic stream length (default 100000)
+//   --fields=N           values per record (default 4)
+//   --window=N           fresh ciphertexts folded at once (default 8)
+//   --budget-margin=B    reserve in bits before a flush (default 1)
+inline void apply_options(StreamConfig &config, const Options &options) {
+    config.input = options.get("stream-input", config.input);
+    config.records = static_cast<size_t>(std::max(0L, options.get_long("records", static_cast<long>(config.records))));
+    config.fields = static_cast<size_t>(std::max(1L, options.get_long("fields", static_cast<long>(config.fields))));
+    config.window = static_cast<size_t>(std::max(1L, options.get_long("window", static_cast<long>(config.window))));
+    config.budget_margin = options.get_double("budget-margin", config.budget_margin);
+}
+
+class RecordSource {
+public:
+    virtual ~RecordSource() = default;
+
+    // Next record into `record` (resized to the field count); false at the
+    // end of the stream.
+    virtual bool next(std::vector<uint64_t> &record) = 0;
+};
+
+class SyntheticRecords : public RecordSource {
+    size_t remaining;
+    size_t fields;
+    std::mt19937 rng;
+    std::uniform_int_distribution<uint64_t> dist;
+
+public:
+    SyntheticRecords(size_t records, size_t fields, uint64_t max_value, uint32_t seed)
+        : remaining(records), fields(fields), rng(seed), dist(1, max_value) {}
+
+    bool next(std::vector<uint64_t> &record) override {
+        if (remaining == 0) return false;
+        remaining--;
+        record.resize(fields);
+        for (auto &v : record) v = dist(rng);
+        return true;
+    }
+};
+
+// One record per line, unsigned integers separated by commas or
+// whitespace. Missing fields are 0 and extra ones ignored; lines without a
+// number and lines starting with '#' are skipped.
+class TextRecords : public RecordSource {
+    std::istream &in;
+    size_t fields;
+    std::string line;
+
+public:
+    TextRecords(std::istream &in, size_t fields) : in(in), fields(fields) {}
+
+    bool next(std::vector<uint64_t> &record) override {
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            record.assign(fields, 0);
+            const char *p = line.c_str();
+            size_t parsed = 0;
+            while (parsed < fields) {
+                while (*p == ',' || std::isspace(static_cast<unsigned char>(*p))) p++;
+                char *end = nullptr;
+                uint64_t v = std::strtoull(p, &end, 10);
+                if (end == p) break;
+                record[parsed++] = v;
+                p = end;
+            }
+            if (parsed) return true;
+        }
+        return false;
+    }
+};
+
+// Whether the input can be read again for another degree.
+inline bool replayable_input(const std::string &input) {
+    return input != "-" && input.rfind("tcp:", 0) != 0;
+}
+
+// The record stream of one pass over StreamConfig::input.
+class RecordStream {
+    std::unique_ptr<std::ifstream> file;
+    std::unique_ptr<Socket> socket;
+    std::unique_ptr<SocketStreambuf> socket_buf;
+    std::unique_ptr<std::istream> socket_in;
+    std::unique_ptr<RecordSource> source;
+
+public:
+    RecordStream(const StreamConfig &config, uint64_t max_value, uint32_t seed) {
+        if (config.input.empty()) {
+            source = std::make_unique<SyntheticRecords>(config.records, config.fields, max_value, seed);
+        } else if (config.input == "-") {
+            source = std::make_unique<TextRecords>(std::cin, config.fields);
+        } else if (config.input.rfind("tcp:", 0) == 0) {
+            std::string port = config.input.substr(4);
+            Listener listener(port);
+            std::cout << "  Waiting for a record producer on port " << port << std::endl;
+            socket = std::make_unique<Socket>(listener.accept_one());
+            socket_buf = std::make_unique<SocketStreambuf>(*socket);
+            socket_in = std::make_unique<std::istream>(socket_buf.get());
+            source = std::make_unique<TextRecords>(*socket_in, config.fields);
+        } else {
+            file = std::make_unique<std::ifstream>(config.input);
+            if (!*file) throw std::runtime_error("cannot open " + config.input);
+            source = std::make_unique<TextRecords>(*file, config.fields);
+        }
+    }
+
+    RecordSource &records() { return *source; }
+};
+
+// One running encrypted aggregate and the plaintext it has been flushed
+// into. Every fold multiplies (relinearized) or adds a window's combined
+// ciphertext into acc, then checks the noise budget: if one more fold of
+// the same cost would leave less than the margin, acc is decrypted into
+// `partial` and restarted; otherwise it is moved to the next modulus when
+// that is (nearly) free, so later folds work on smaller ciphertexts.
+// Incoming ciphertexts are switched down to acc's level first.
+struct StreamAggregate {
+    const char *name;
+    bool product;
+    std::unique_ptr<Cipher> acc, probe;
+    std::vector<uint64_t> partial;
+
+    bool empty = true;
+    bool at_bottom = false;  // no smaller modulus left
+    int level = 0;
+    double last_budget = 0;
+    double worst_drop = 0;   // largest budget drop of one fold since the last flush
+
+    size_t flushes = 0;
+    size_t mod_switches = 0;
+    size_t budget_checks = 0;
+    double fold_ms = 0;
+    double policy_ms = 0;
+    double flush_ms = 0;
+
+    StreamAggregate(Backend &backend, const char *name, bool product)
+        : name(name), product(product), acc(backend.make_cipher()), probe(backend.make_cipher()),
+          partial(backend.slot_count(), product ? 1 : 0) {}
+
+    // Only folds into a non-empty accumulator count towards worst_drop: the
+    // first window of a restart brings its own tree depth, which later folds
+    // do not repeat.
+    void fold(Backend &backend, Cipher &in, const StreamConfig &config) {
+        Timer timer;
+        timer.tic();
+        for (int l = 0; l < level; l++) backend.mod_switch(in);
+        if (empty) {
+            backend.move_cipher(in, *acc);
+        } else if (product) {
+            backend.multiply_inplace(*acc, in);
+        } else {
+            backend.add_inplace(*acc, in);
+        }
+        fold_ms += timer.toc();
+
+        timer.tic();
+        double budget = backend.noise_budget(*acc);
+        budget_checks++;
+        if (!empty) worst_drop = std::max(worst_drop, last_budget - budget);
+        empty = false;
+        if (budget - worst_drop <= config.budget_margin) {
+            policy_ms += timer.toc();
+            flush(backend);
+            return;
+        }
+        if (!at_bottom) {
+            backend.copy_cipher(*acc, *probe);
+            if (!backend.mod_switch(*probe)) {
+                at_bottom = true;
+            } else {
+                double switched = backend.noise_budget(*probe);
+                budget_checks++;
+                if (switched >= budget - config.switch_cost_bits && switched - worst_drop > config.budget_margin) {
+                    backend.move_cipher(*probe, *acc);
+                    level++;
+                    mod_switches++;
+                    budget = switched;
+                }
+            }
+        }
+        last_budget = budget;
+        policy_ms += timer.toc();
+    }
+
+    void flush(Backend &backend) {
+        if (empty) return;
+        Timer timer;
+        timer.tic();
+        uint64_t t = backend.plain_modulus();
+        auto plain = backend.make_plain();
+        std::vector<uint64_t> values;
+        backend.decrypt(*acc, *plain);
+        backend.decode(*plain, values);
+        for (size_t s = 0; s < partial.size(); s++) {
+            partial[s] = product ? mul_mod(partial[s], values[s], t) : (partial[s] + values[s]) % t;
+        }
+        flushes++;
+        empty = true;
+        at_bottom = false;
+        level = 0;
+        worst_drop = 0;
+        flush_ms += timer.toc();
+    }
+};
+
+inline ColumnSet stream_columns() {
+    return keyed_columns(
+        result_columns({"input", "fields", "window", "aggregate", "records", "batches", "windows",
+                        "flushes", "mod_switches", "budget_checks", "final_budget", "final_level",
+                        "wall_ms", "read_ms", "encrypt_ms", "fold_ms", "policy_ms", "flush_ms",
+                        "records_per_s", "start_rss_kb", "rss_growth_kb", "peak_rss_kb", "valid"}),
+        {"input", "fields", "window", "aggregate", "records"});
+}
+
+// One pass over the stream at the backend's current setup. Record r of a
+// batch fills slots r * fields .. r * fields + fields - 1; unused slots
+// hold 1 so they are neutral for the product, and the sum discounts them.
+// The window is folded once full: summed into one ciphertext for the sum
+// aggregate and multiplied as a balanced tree for the product, so the
+// product accumulator starts at depth ceil(log2(window)) and gains one
+// multiplication per later window rather than one per batch. The clock covers reading, packing, encryption,
+// folding, the budget policy and flushes. RSS is sampled after every fold;
+// it should stay flat however long the stream is. Validation compares
+// every field's aggregate against a running plaintext reference.
+inline void run_stream_pass(Backend &backend, const SweepConfig &sweep, const StreamConfig &config, size_t degree,
+                            CsvLog &log) {
+    size_t slot_count = backend.slot_count();
+    size_t fields = config.fields;
+    if (fields > slot_count) throw std::invalid_argument("more fields than slots");
+    size_t per_batch = slot_count / fields;
+    uint64_t t = backend.plain_modulus();
+
+    std::vector<std::unique_ptr<Cipher>> window(config.window);
+    for (auto &c : window) c = backend.make_cipher();
+    auto window_sum = backend.make_cipher();
+    auto plain = backend.make_plain();
+    StreamAggregate sum(backend, "sum", false);
+    StreamAggregate product(backend, "product", true);
+
+    std::vector<uint64_t> batch(slot_count, 1), record;
+    std::vector<uint64_t> pads(slot_count, 0);
+    std::vector<uint64_t> ref_sum(fields, 0), ref_product(fields, 1);
+
+    RecordStream stream(config, sweep.random_max, sweep.seed);
+    reset_peak_rss();
+    long start_rss = current_rss_kb();
+    long max_rss = start_rss;
+
+    size_t records = 0, batches = 0, windows = 0, filled = 0;
+    double read_ms = 0, encrypt_ms = 0;
+    Timer phase;
+
+    auto fold_window = [&] {
+        phase.tic();
+        backend.copy_cipher(*window[0], *window_sum);
+        for (size_t i = 1; i < filled; i++) backend.add_inplace(*window_sum, *window[i]);
+        sum.fold_ms += phase.toc();
+        phase.tic();
+        for (size_t stride = 1; stride < filled; stride *= 2) {
+            for (size_t i = 0; i + stride < filled; i += 2 * stride) backend.multiply_inplace(*window[i], *window[i + stride]);
+        }
+        product.fold_ms += phase.toc();
+        sum.fold(backend, *window_sum, config);
+        product.fold(backend, *window[0], config);
+        windows++;
+        filled = 0;
+        max_rss = std::max(max_rss, current_rss_kb());
+    };
+
+    Timer wall;
+    wall.tic();
+    while (true) {
+        phase.tic();
+        size_t in_batch = 0;
+        while (in_batch < per_batch && stream.records().next(record)) {
+            for (size_t f = 0; f < fields; f++) {
+                uint64_t v = record[f] % t;
+                batch[in_batch * fields + f] = v;
+                ref_sum[f] = (ref_sum[f] + v) % t;
+                ref_product[f] = mul_mod(ref_product[f], v, t);
+            }
+            in_batch++;
+        }
+        records += in_batch;
+        if (in_batch == 0) break;
+        for (size_t s = in_batch * fields; s < per_batch * fields; s++) {
+            batch[s] = 1;
+            pads[s]++;
+        }
+        read_ms += phase.toc();
+
+        phase.tic();
+        backend.encode(batch, *plain);
+        backend.encrypt(*plain, *window[filled++]);
+        encrypt_ms += phase.toc();
+        batches++;
+        if (filled == config.window) fold_window();
+        if (in_batch < per_batch) break;
+    }
+    if (filled) fold_window();
+
+    double final_budget[2] = {sum.last_budget, product.last_budget};
+    int final_level[2] = {sum.level, product.level};
+    sum.flush(backend);
+    product.flush(backend);
+    double wall_ms = wall.toc();
+    long peak_rss = peak_rss_kb();
+
+    bool sum_valid = true, product_valid = true;
+    for (size_t f = 0; f < fields; f++) {
+        uint64_t total = 0, prod = 1;
+        for (size_t r = 0; r < per_batch; r++) {
+            size_t s = r * fields + f;
+            total = (total + sum.partial[s] + t - pads[s] % t) % t;
+            prod = mul_mod(prod, product.partial[s], t);
+        }
+        sum_valid = sum_valid && total == ref_sum[f];
+        product_valid = product_valid && prod == ref_product[f];
+    }
+
+    std::string input = config.input.empty() ? "synthetic" : config.input;
+    double per_s = records / (wall_ms / 1000.0);
+    StreamAggregate *aggregates[2] = {&sum, &product};
+    bool valid[2] = {sum_valid, product_valid};
+    for (int k = 0; k < 2; k++) {
+        const StreamAggregate &a = *aggregates[k];
+        log.row(backend.library(), backend.scheme(), degree, slot_count, input, fields, config.window, a.name,
+                records, batches, windows, a.flushes, a.mod_switches, a.budget_checks, final_budget[k],
+                final_level[k], wall_ms, read_ms, encrypt_ms, a.fold_ms, a.policy_ms, a.flush_ms, per_s,
+                start_rss, max_rss - start_rss, peak_rss, valid[k] ? 1 : 0);
+        std::cout << "    " << a.name << ": " << a.flushes << " flushes, " << a.mod_switches << " mod switches, "
+                  << "fold " << a.fold_ms << " ms, policy " << a.policy_ms << " ms"
+                  << (valid[k] ? "" : ", INVALID") << std::endl;
+    }
+    std::cout << "  " << backend.library() << " PolyModulus: " << degree << ", Records: " << records
+              << " (" << batches << " batches), Wall: " << wall_ms << " ms, " << per_s << " records/s"
+              << ", RSS growth: " << max_rss - start_rss << " KB, Peak RSS: " << peak_rss << " KB" << std::endl;
+}
+
+// A stream pass at every degree. Stdin and socket streams can only be read
+// once, so they are aggregated at the first degree that sets up.
+inline void run_stream_sweep(Backend &backend, const SweepConfig &sweep, const StreamConfig &config, CsvLog &log) {
+    for (auto degree : sweep.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " streaming aggregation PolyModulus=" << degree
+                  << ", window " << config.window << " ===" << std::endl;
+        if (!setup_first_working(backend, sweep_candidates(sweep, degree))) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        try {
+            run_stream_pass(backend, sweep, config, degree, log);
+        } catch (const std::exception &e) {
+            std::cout << "Error with PolyModulus: " << degree << " - " << e.what() << std::endl;
+        }
+        if (!replayable_input(config.input)) break;
+    }
+}
+
+} // namespace bench
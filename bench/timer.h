@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+namespace bench {
+
+// Wall-clock stopwatch shared by every workload. tic() starts a sample,
+// toc() returns the elapsed time in milliseconds. steady_clock is used
+// because high_resolution_clock may be the (adjustable) system clock.
+struct Timer {
+    std::chrono::steady_clock::time_point start;
+
+    void tic() { start = std::chrono::steady_clock::now(); }
+
+    double toc() const {
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+};
+
+// Raw time-stamp counter, or 0 where there is none.
+inline uint64_t read_tsc() {
+#ifdef BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Summary of repeated samples of one measurement.
+struct Stats {
+    size_t samples = 0;
+    double mean_ms = 0;
+    double min_ms = 0;
+    double median_ms = 0;
+    double p90_ms = 0;
+    double p99_ms = 0;
+    double max_ms = 0;
+    double stddev_ms = 0;
+    double median_cycles = 0;  // 0 unless TSC sampling was enabled
+};
+
+// Nearest-rank percentile of an ascending-sorted, non-empty vector.
+template <typename T>
+T percentile(const std::vector<T> &sorted, double p) {
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+class SampleSet {
+private:
+    std::vector<double> ms;
+    std::vector<uint64_t> cycles;
+
+public:
+    void add(double sample_ms, uint64_t sample_cycles = 0) {
+        ms.push_back(sample_ms);
+        if (sample_cycles) cycles.push_back(sample_cycles);
+    }
+
+    size_t size() const { return ms.size(); }
+
+    void merge(const SampleSet &other) {
+        ms.insert(ms.end(), other.ms.begin(), other.ms.end());
+        cycles.insert(cycles.end(), other.cycles.begin(), other.cycles.end());
+    }
+
+    Stats stats() const {
+        Stats s;
+        if (ms.empty()) return s;
+
+        std::vector<double> sorted = ms;
+        std::sort(sorted.begin(), sorted.end());
+        s.samples = sorted.size();
+        s.min_ms = sorted.front();
+        s.max_ms = sorted.back();
+        s.median_ms = percentile(sorted, 50);
+        s.p90_ms = percentile(sorted, 90);
+        s.p99_ms = percentile(sorted, 99);
+
+        double sum = 0;
+        for (double v : sorted) sum += v;
+        s.mean_ms = sum / sorted.size();
+        double sq = 0;
+        for (double v : sorted) sq += (v - s.mean_ms) * (v - s.mean_ms);
+        s.stddev_ms = sorted.size() > 1 ? std::sqrt(sq / (sorted.size() - 1)) : 0;
+
+        if (!cycles.empty()) {
+            std::vector<uint64_t> sorted_cycles = cycles;
+            std::sort(sorted_cycles.begin(), sorted_cycles.end());
+            s.median_cycles = static_cast<double>(percentile(sorted_cycles, 50));
+        }
+        return s;
+    }
+};
+
+// How many times each measured call runs. Warm-up runs are discarded and
+// absorb first-touch page faults, pool growth and cold caches.
+struct TimingConfig {
+    int warmup = 2;
+    int iterations = 10;
+    bool tsc = false;
+};
+
+// Runs fn `warmup` times untimed.
+template <typename Fn>
+void warm_up(const TimingConfig &timing, Fn &&fn) {
+    for (int i = 0; i < timing.warmup; i++) fn();
+}
+
+// Runs fn `reps` times, adding one sample per call.
+template <typename Fn>
+void measure(const TimingConfig &timing, int reps, SampleSet &out, Fn &&fn) {
+    Timer timer;
+    for (int i = 0; i < reps; i++) {
+        uint64_t c0 = timing.tsc ? read_tsc() : 0;
+        timer.tic();
+        fn();
+        double ms = timer.toc();
+        uint64_t c1 = timing.tsc ? read_tsc() : 0;
+        out.add(ms, c1 - c0);
+    }
+}
+
+// Warm-up followed by `iterations` measured calls.
+template <typename Fn>
+Stats measure(const TimingConfig &timing, Fn &&fn) {
+    SampleSet samples;
+    warm_up(timing, fn);
+    measure(timing, timing.iterations, samples, fn);
+    return samples.stats();
+}
+
+// Like measure(), for calls that consume their input: prepare() runs untimed
+// before every call.
+template <typename Prepare, typename Fn>
+void measure_prepared(const TimingConfig &timing, int reps, SampleSet &out, Prepare &&prepare, Fn &&fn) {
+    for (int i = 0; i < reps; i++) {
+        prepare();
+        measure(timing, 1, out, fn);
+    }
+}
+
+// Warm-up followed by `iterations` measured calls, each after prepare().
+template <typename Prepare, typename Fn>
+Stats measure_prepared(const TimingConfig &timing, Prepare &&prepare, Fn &&fn) {
+    SampleSet samples;
+    for (int i = 0; i < timing.warmup; i++) {
+        prepare();
+        fn();
+    }
+    measure_prepared(timing, timing.iterations, samples, prepare, fn);
+    return samples.stats();
+}
+
+} // namespace bench
@@ -0,0 +1,714 @@
+#pragma once
+
+#include "backend.h"
+#include "dataset.h"
+#include "depth.h"
+#include "memory.h"
+#include "noise.h"
+#include "options.h"
+#include "parallel.h"
+#include "results.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// How op outputs are allocated in the timed loops of the op and parallel
+// sweeps:
+//   Fresh  a new output object per call, allocated and freed inside the
+//          timed region, as the original drivers did
+//   Reuse  one output per cell allocated up front and overwritten
+//   Arena  as Reuse, with every ciphertext of the cell reserved up front in
+//          a dedicated backend pool (see ArenaScope)
+enum class AllocMode { Fresh, Reuse, Arena };
+
+inline const char *alloc_mode_name(AllocMode mode) {
+    switch (mode) {
+    case AllocMode::Fresh: return "fresh";
+    case AllocMode::Reuse: return "reuse";
+    case AllocMode::Arena: return "arena";
+    }
+    return "unknown";
+}
+
+inline AllocMode parse_alloc_mode(const std::string &name) {
+    for (auto mode : {AllocMode::Fresh, AllocMode::Reuse, AllocMode::Arena}) {
+        if (name == alloc_mode_name(mode)) return mode;
+    }
+    throw std::invalid_argument("unknown allocation mode " + name);
+}
+
+// Polynomials an arena ciphertext is reserved for: an unrelinearized
+// product.
+constexpr size_t ArenaCipherPolys = 3;
+
+struct SweepConfig {
+    std::vector<size_t> poly_modulus_degrees;
+    std::vector<size_t> vector_sizes;
+
+    DataPattern pattern = DataPattern::Same;
+    uint64_t same_a = 42;
+    uint64_t same_b = 42;
+    uint64_t random_max = 100;
+    uint32_t seed = 42;
+
+    // Parameter sets to try, in order, for each degree; the first one the
+    // backend accepts is used for the whole degree.
+    std::function<std::vector<ParamSet>(size_t)> candidates;
+
+    // Degrees whose parameters yield fewer slots are skipped.
+    size_t min_slots = 0;
+
+    // Rotation steps the workload needs. When set, every candidate gets
+    // Galois keys for exactly these steps instead of what it asks for.
+    std::vector<int> required_rotations;
+
+    // Rotation suite: amounts timed at every vector size on top of +-1,
+    // vector_size / 2 and vector_size - 1, and the Galois key sets compared.
+    // "default" is the library's own set, "steps" dedicated keys for exactly
+    // the steps the suite uses.
+    std::vector<int> rotation_steps = {3, 7};
+    std::vector<std::string> rotation_key_sets = {"default", "steps"};
+
+    // Products summed by the eager / lazy relinearization chains of the
+    // mul-phases workload.
+    size_t mul_chain_length = 8;
+
+    // User vectors of each vector size packed together by the packing
+    // workload.
+    size_t packed_vectors = 8;
+
+    // Kernel workload: vector lengths / matrix dimensions, and taps of the
+    // 1D convolution.
+    std::vector<size_t> kernel_sizes = {16, 64, 256};
+    size_t conv_taps = 5;
+
+    // Output allocation strategies the op and parallel sweeps compare.
+    std::vector<AllocMode> alloc_modes = {AllocMode::Reuse};
+
+    // Noise budget readings around every op of the op sweep.
+    NoiseTelemetry noise = NoiseTelemetry::Off;
+
+    // Op sweep dataset preparation: threads generating the operands (0 for
+    // one per hardware thread), a directory caching them, and whether each
+    // degree's chunks are encoded once up front instead of in every cell.
+    size_t prep_threads = 0;
+    std::string dataset_cache;
+    bool pre_encode = false;
+
+    TimingConfig timing;
+};
+
+// Timing options shared by every driver:
+//   --warmup=N      untimed calls before measuring (default 2)
+//   --iterations=N  measured calls per cell (default 10)
+//   --tsc           also record time-stamp-counter cycles
+inline void apply_timing_options(TimingConfig &timing, const Options &options) {
+    timing.warmup = static_cast<int>(options.get_long("warmup", timing.warmup));
+    timing.iterations = std::max(1, static_cast<int>(options.get_long("iterations", timing.iterations)));
+    timing.tsc = options.get_flag("tsc");
+}
+
+// Sweep options on top of the timing ones:
+//   --rotation-steps=a,b,...  extra rotation amounts (default 3,7)
+//   --key-sets=a,b            Galois key sets to compare (default,steps)
+//   --rotations=a,b,...       declare the only rotations the workload needs
+//   --chain=N                 products per multiply-add chain (default 8)
+//   --pack-vectors=N          vectors per packed batch (default 8)
+//   --alloc=a,b               output allocation modes: fresh, reuse, arena
+//                             (default reuse)
+//   --kernel-sizes=a,b,...    kernel vector / matrix sizes (default 16,64,256)
+//   --taps=N                  convolution taps (default 5)
+//   --noise[=measured|estimated]  noise budget before / after each op of
+//                             the op sweep; a bare --noise measures
+//   --prep-threads=N          dataset generation threads (default all)
+//   --dataset-cache=DIR       read / write generated datasets under DIR
+//   --pre-encode              encode each degree's operands once up front
+inline void apply_options(SweepConfig &config, const Options &options) {
+    apply_timing_options(config.timing, options);
+    config.prep_threads = static_cast<size_t>(
+        std::max(0L, options.get_long("prep-threads", static_cast<long>(config.prep_threads))));
+    config.dataset_cache = options.get("dataset-cache", config.dataset_cache);
+    config.pre_encode = options.get_flag("pre-encode");
+    if (options.has("noise")) {
+        std::string noise = options.get("noise");
+        config.noise = parse_noise_telemetry(noise == "1" ? "measured" : noise);
+    }
+    auto kernel_sizes = options.get_list("kernel-sizes");
+    if (!kernel_sizes.empty()) config.kernel_sizes.assign(kernel_sizes.begin(), kernel_sizes.end());
+    config.conv_taps = static_cast<size_t>(std::max(1L, options.get_long("taps", static_cast<long>(config.conv_taps))));
+    auto alloc = options.get_strings("alloc");
+    if (!alloc.empty()) {
+        config.alloc_modes.clear();
+        for (const auto &name : alloc) config.alloc_modes.push_back(parse_alloc_mode(name));
+    }
+    config.packed_vectors = static_cast<size_t>(
+        std::max(1L, options.get_long("pack-vectors", static_cast<long>(config.packed_vectors))));
+    config.mul_chain_length = static_cast<size_t>(
+        std::max(1L, options.get_long("chain", static_cast<long>(config.mul_chain_length))));
+    auto rotations = options.get_list("rotations");
+    if (!rotations.empty()) config.required_rotations.assign(rotations.begin(), rotations.end());
+    auto steps = options.get_list("rotation-steps");
+    if (!steps.empty()) config.rotation_steps.assign(steps.begin(), steps.end());
+    auto key_sets = options.get_strings("key-sets");
+    if (!key_sets.empty()) config.rotation_key_sets = key_sets;
+}
+
+// Per-op memory of one call on the last chunk, plus static sizes of the
+// ciphertexts involved and of the key material.
+inline std::vector<std::string> memory_columns() {
+    return {"op_pool_bytes", "op_heap_delta_bytes", "op_peak_rss_delta_kb",
+            "ciphertext_bytes", "result_bytes",
+            "public_key_bytes", "relin_keys_bytes", "galois_keys_bytes"};
+}
+
+inline ColumnSet op_sweep_columns() {
+    return keyed_columns(
+        result_columns(concat_columns({
+            {"vector_size", "num_ciphertexts", "operation_type", "plain_encoding", "alloc_mode"},
+            stats_columns("encoding"),
+            stats_columns("encryption"),
+            stats_columns("operation"),
+            stats_columns("inplace"),
+            stats_columns("move"),
+            stats_columns("copy"),
+            stats_columns("decryption"),
+            {"valid"},
+            memory_columns(),
+            noise_columns()})),
+        {"vector_size", "num_ciphertexts", "operation_type", "plain_encoding", "alloc_mode", "noise_mode"});
+}
+
+inline ColumnSet rotation_sweep_columns() {
+    return keyed_columns(
+        result_columns(concat_columns({
+            {"key_set", "setup_ms", "setup_source", "galois_keygen_ms", "galois_keys_bytes", "galois_key_count",
+             "vector_size", "rotation_type", "steps"},
+            stats_columns("rotation"),
+            {"hoisted", "valid"}})),
+        {"key_set", "vector_size", "rotation_type", "steps", "hoisted"});
+}
+
+// config.candidates(degree) with the workload's declared rotations applied.
+inline std::vector<ParamSet> sweep_candidates(const SweepConfig &config, size_t degree) {
+    std::vector<ParamSet> candidates = config.candidates(degree);
+    if (!config.required_rotations.empty()) {
+        for (auto &params : candidates) {
+            params.galois_keys = true;
+            params.galois_steps = config.required_rotations;
+        }
+    }
+    return candidates;
+}
+
+// Measured calls per ciphertext so that a cell collects at least
+// `iterations` samples without multiplying the cost of many-chunk cells.
+inline int reps_per_chunk(const TimingConfig &timing, size_t num_ciphertexts) {
+    return static_cast<int>((timing.iterations + num_ciphertexts - 1) / num_ciphertexts);
+}
+
+// Tries each candidate in turn and leaves the backend set up with the first
+// one that works.
+inline bool setup_first_working(Backend &backend, const std::vector<ParamSet> &candidates) {
+    for (const auto &params : candidates) {
+        std::cout << "  Trying " << params.describe() << " ... ";
+        if (backend.setup(params)) {
+            std::cout << "SUCCESS! Slot count: " << backend.slot_count()
+                      << ", keys " << backend.last_setup_source()
+                      << " in " << backend.last_setup_ms() << " ms" << std::endl;
+            return true;
+        }
+        std::cout << "FAILED" << std::endl;
+    }
+    return false;
+}
+
+inline DataSpec data_spec(const SweepConfig &config) {
+    DataSpec spec;
+    spec.pattern = config.pattern;
+    spec.same_a = config.same_a;
+    spec.same_b = config.same_b;
+    spec.random_max = config.random_max;
+    spec.seed = config.seed;
+    return spec;
+}
+
+// Operand generator for the workloads that draw their inputs as they go.
+// Each operand is a stream of operand_value()s consumed front to back, so
+// a workload is reproducible run to run and sees the same values under
+// every library.
+class OperandSource {
+private:
+    DataSpec spec;
+    uint64_t next_a = 0;
+    uint64_t next_b = 0;
+
+public:
+    explicit OperandSource(const SweepConfig &config) : spec(data_spec(config)) {}
+
+    // Fill the first `used` slots of the left / right operand and zero-pad
+    // the rest up to slot_count.
+    void fill_a(std::vector<uint64_t> &out, size_t used, size_t slot_count) {
+        fill(out, used, slot_count, 0, next_a);
+    }
+
+    void fill_b(std::vector<uint64_t> &out, size_t used, size_t slot_count) {
+        fill(out, used, slot_count, 1, next_b);
+    }
+
+private:
+    void fill(std::vector<uint64_t> &out, size_t used, size_t slot_count, int which, uint64_t &next) {
+        out.assign(slot_count, 0);
+        for (size_t i = 0; i < used; i++) {
+            out[i] = operand_value(spec, which, next++);
+        }
+    }
+};
+
+inline uint64_t expected_value(OpType op, uint64_t a, uint64_t b, uint64_t t) {
+    return is_add_op(op) ? (a % t + b % t) % t : mul_mod(a, b, t);
+}
+
+// The sweep's DatasetStore, generating on config.prep_threads threads (all
+// by default) and caching under config.dataset_cache.
+inline DatasetStore sweep_datasets(const SweepConfig &config) {
+    DatasetStore datasets(data_spec(config));
+    datasets.threads = config.prep_threads ? config.prep_threads : hardware_threads();
+    datasets.cache_dir = config.dataset_cache;
+    return datasets;
+}
+
+// Every chunk of a dataset at one slot count as its own zero-padded vector,
+// for cells whose threads take chunks in any order: chunk i holds elements
+// i * slot_count onwards, exactly as the op sweep encrypts them.
+struct ChunkedOperands {
+    std::vector<std::vector<uint64_t>> a, b;
+    std::vector<size_t> used;
+
+    ChunkedOperands(const Dataset &dataset, size_t slot_count)
+        : a(dataset.chunks(slot_count)), b(dataset.chunks(slot_count)), used(dataset.chunks(slot_count)) {
+        for (size_t i = 0; i < used.size(); i++) {
+            used[i] = dataset.chunk_size(i, slot_count);
+            dataset.chunk_a(i, slot_count, a[i]);
+            dataset.chunk_b(i, slot_count, b[i]);
+        }
+    }
+
+    size_t size() const { return used.size(); }
+};
+
+// One (degree, vector_size, op) cell: the vector is split into
+// ceil(vector_size / slot_count) ciphertexts, each encrypted, operated on and
+// decrypted. Warm-up runs on the first ciphertext; samples are pooled over
+// all ciphertexts. "encoding" times preparing the right operand in the
+// backend's current plain_encoding(), so plain ops are charged for it once
+// per chunk rather than hiding it in the operation. `alloc` decides how the
+// operation's output is allocated. The cell is instantiated per op and
+// backend class (see OpTraits), so the timed calls are direct. With `noise`
+// on, the budgets of the first chunk's operands and timed output are read
+// after its timing. Operands come from the prepared `dataset`; with
+// `encoded`, the untimed encodings of the encryption inputs are taken from
+// it instead of being redone by every cell.
+//
+// Every op is timed in three forms: "operation" out of place into a
+// separate result, "inplace" on a copy of the left operand made untimed
+// beforehand, and "move" transferring such a copy into the result and then
+// operating in place. "copy" is the cost of the deep copy the out-of-place
+// form may hide (HElib copies the left operand into the result first).
+template <OpType Op, typename B>
+void run_op_cell(B &backend, size_t degree, size_t vector_size, AllocMode alloc, NoiseTelemetry noise,
+                 const TimingConfig &timing, const Dataset &dataset, const EncodedDataset *encoded,
+                 CsvLog &log) {
+    using Traits = OpTraits<Op>;
+    constexpr OpType op = Op;
+    size_t slot_count = backend.slot_count();
+    size_t num_ciphertexts = (vector_size + slot_count - 1) / slot_count;
+    uint64_t t = backend.plain_modulus();
+    int reps = reps_per_chunk(timing, num_ciphertexts);
+
+    std::unique_ptr<ArenaScope> arena;
+    if (alloc == AllocMode::Arena) arena = std::make_unique<ArenaScope>(backend, ArenaCipherPolys);
+
+    auto plain_a = backend.make_plain();
+    auto plain_b = backend.make_plain();
+    auto cipher_a = backend.make_cipher();
+    auto cipher_b = backend.make_cipher();
+    auto result = backend.make_cipher();
+    auto work = backend.make_cipher();
+    auto moved = backend.make_cipher();
+    auto move_result = backend.make_cipher();
+    auto decrypted = backend.make_plain();
+
+    std::vector<uint64_t> data_a, data_b, decoded;
+    SampleSet encode_samples, encrypt_samples, operation_samples, decrypt_samples;
+    SampleSet inplace_samples, move_samples, copy_samples;
+    NoiseSample noise_sample;
+    bool valid = true;
+
+    auto encode = [&] { backend.encode(data_b, *plain_b); };
+    const Plain *input_a = plain_a.get();
+    auto encrypt = [&] { backend.encrypt(*input_a, *cipher_a); };
+    auto operate = [&] {
+        if (alloc == AllocMode::Fresh) result = backend.make_cipher();
+        Traits::apply(backend, *cipher_a, *cipher_b, *plain_b, *result);
+    };
+    auto decrypt = [&] { backend.decrypt(*result, *decrypted); };
+    auto copy_a = [&] { backend.copy_cipher(*cipher_a, *work); };
+    auto operate_inplace = [&] { Traits::apply_inplace(backend, *work, *cipher_b, *plain_b); };
+    auto copy_moved = [&] { backend.copy_cipher(*cipher_a, *moved); };
+    auto operate_move = [&] {
+        backend.move_cipher(*moved, *move_result);
+        Traits::apply_inplace(backend, *move_result, *cipher_b, *plain_b);
+    };
+    auto check = [&](const Cipher &c, size_t used) {
+        backend.decrypt(c, *decrypted);
+        backend.decode(*decrypted, decoded);
+        for (size_t j = 0; j < used && valid; j++) {
+            valid = decoded[j] == expected_value(op, data_a[j], data_b[j], t);
+        }
+    };
+
+    for (size_t i = 0; i < num_ciphertexts; i++) {
+        size_t current_size = dataset.chunk_size(i, slot_count);
+        dataset.chunk_a(i, slot_count, data_a);
+        dataset.chunk_b(i, slot_count, data_b);
+        if (encoded) {
+            input_a = encoded->a[i].get();
+        } else {
+            backend.encode(data_a, *plain_a);
+        }
+        if (i == 0) warm_up(timing, encode);
+        measure(timing, reps, encode_samples, encode);
+        if (!Traits::plain) {
+            backend.encrypt(encoded ? *encoded->b[i] : *plain_b, *cipher_b);
+        }
+
+        if (i == 0) warm_up(timing, encrypt);
+        measure(timing, reps, encrypt_samples, encrypt);
+        if (i == 0) warm_up(timing, operate);
+        measure(timing, reps, operation_samples, operate);
+        if (i == 0) noise_sample = sample_noise(backend, noise, op, *cipher_a, *cipher_b, *result);
+        if (i == 0) warm_up(timing, copy_a);
+        measure(timing, reps, copy_samples, copy_a);
+        if (i == 0) warm_up(timing, [&] { copy_a(); operate_inplace(); });
+        measure_prepared(timing, reps, inplace_samples, copy_a, operate_inplace);
+        if (i == 0) warm_up(timing, [&] { copy_moved(); operate_move(); });
+        measure_prepared(timing, reps, move_samples, copy_moved, operate_move);
+        if (i == 0) warm_up(timing, decrypt);
+        measure(timing, reps, decrypt_samples, decrypt);
+
+        backend.decode(*decrypted, decoded);
+        for (size_t j = 0; j < current_size && valid; j++) {
+            valid = decoded[j] == expected_value(op, data_a[j], data_b[j], t);
+        }
+        check(*work, current_size);
+        check(*move_result, current_size);
+    }
+
+    // One untimed call on a fresh output, so the probe sees its allocation.
+    std::unique_ptr<Cipher> probe_out;
+    MemoryUsage usage = probe_memory(backend, [&] {
+        probe_out = backend.make_cipher();
+        Traits::apply(backend, *cipher_a, *cipher_b, *plain_b, *probe_out);
+    });
+    KeySizes key_sizes = backend.key_sizes();
+
+    Stats encode_stats = encode_samples.stats();
+    Stats encrypt_stats = encrypt_samples.stats();
+    Stats operation_stats = operation_samples.stats();
+    Stats inplace_stats = inplace_samples.stats();
+    Stats move_stats = move_samples.stats();
+    Stats copy_stats = copy_samples.stats();
+    Stats decrypt_stats = decrypt_samples.stats();
+
+    log.row(backend.library(), backend.scheme(), degree, slot_count,
+            vector_size, num_ciphertexts, Traits::name, backend.plain_encoding(), alloc_mode_name(alloc),
+            encode_stats, encrypt_stats, operation_stats, inplace_stats, move_stats, copy_stats,
+            decrypt_stats, valid ? 1 : 0,
+            usage.pool_bytes, usage.heap_delta_bytes, usage.peak_rss_delta_kb,
+            backend.cipher_bytes(*cipher_a), backend.cipher_bytes(*probe_out),
+            key_sizes.public_key, key_sizes.relin_keys, key_sizes.galois_keys, noise_sample);
+
+    std::cout << backend.library() << " PolyModulus: " << degree
+              << ", VectorSize: " << vector_size
+              << ", Operation: " << Traits::name;
+    if (Traits::plain) std::cout << " [" << backend.plain_encoding() << "]";
+    std::cout << ", Alloc: " << alloc_mode_name(alloc)
+              << ", Encode: " << encode_stats.median_ms << " ms"
+              << ", Encrypt: " << encrypt_stats.median_ms << " ms"
+              << ", Operation: " << operation_stats.median_ms << " ms"
+              << " (p99 " << operation_stats.p99_ms << ", sd " << operation_stats.stddev_ms << ")"
+              << ", InPlace: " << inplace_stats.median_ms << " ms"
+              << ", Move: " << move_stats.median_ms << " ms"
+              << ", Copy: " << copy_stats.median_ms << " ms"
+              << ", Decrypt: " << decrypt_stats.median_ms << " ms"
+              << ", Valid: " << (valid ? "YES" : "NO")
+              << ", OpMemory: " << usage.pool_bytes / 1024 << " KB pool, "
+              << usage.heap_delta_bytes / 1024 << " KB heap";
+    if (noise != NoiseTelemetry::Off) {
+        std::cout << ", Budget: " << noise_sample.before << " -> " << noise_sample.after << " bits ("
+                  << noise_telemetry_name(noise) << ")";
+    }
+    std::cout << std::endl;
+}
+
+// Full op matrix: every degree x vector size x element-wise op, with plain
+// ops repeated for each of the backend's plain_encodings(), and every cell
+// for each of config.alloc_modes. One run_op_cell is instantiated per
+// registered op for the backend class B. Every vector size's dataset is
+// generated before the first cell (see DatasetStore), and with
+// config.pre_encode its chunks are encoded once per degree.
+template <typename B>
+void run_op_sweep(B &backend, const SweepConfig &config, CsvLog &log) {
+    DatasetStore datasets = sweep_datasets(config);
+    datasets.prepare(config.vector_sizes);
+    for (auto degree : config.poly_modulus_degrees) {
+        std::cout << "\n=== " << backend.library() << " PolyModulus=" << degree << " ===" << std::endl;
+        if (!setup_first_working(backend, sweep_candidates(config, degree))) {
+            std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+            continue;
+        }
+        if (backend.slot_count() < config.min_slots) {
+            std::cout << "SKIPPING - too few slots" << std::endl;
+            continue;
+        }
+        const std::string default_encoding = backend.plain_encodings().front();
+        for (auto vector_size : config.vector_sizes) {
+            const Dataset &dataset = datasets.get(vector_size);
+            std::unique_ptr<EncodedDataset> encoded;
+            if (config.pre_encode) {
+                backend.set_plain_encoding(default_encoding);
+                encoded = std::make_unique<EncodedDataset>(backend, dataset);
+            }
+            for_each_op([&](auto tag) {
+                constexpr OpType op = decltype(tag)::value;
+                std::vector<std::string> encodings = {default_encoding};
+                if (OpTraits<op>::plain) encodings = backend.plain_encodings();
+                for (const auto &encoding : encodings) {
+                    backend.set_plain_encoding(encoding);
+                    for (auto alloc : config.alloc_modes) {
+                        try {
+                            run_op_cell<op>(backend, degree, vector_size, alloc, config.noise, config.timing,
+                                            dataset, encoded.get(), log);
+                        } catch (const std::exception &e) {
+                            std::cout << "Error with PolyModulus: " << degree
+                                      << ", VectorSize: " << vector_size
+                                      << ", Operation: " << OpTraits<op>::name
+                                      << " [" << encoding << ", " << alloc_mode_name(alloc) << "] - "
+                                      << e.what() << std::endl;
+                        }
+                    }
+                }
+                backend.set_plain_encoding(default_encoding);
+            });
+        }
+    }
+}
+
+// Rotation amounts timed one by one at a vector size: the configured ones
+// plus vector_size / 2 and vector_size - 1, which move real data across the
+// whole vector.
+inline std::vector<int> rotation_steps_for(const SweepConfig &config, size_t vector_size) {
+    std::vector<int> steps = config.rotation_steps;
+    for (int step : {static_cast<int>(vector_size / 2), static_cast<int>(vector_size) - 1}) {
+        if (step > 1 && std::find(steps.begin(), steps.end(), step) == steps.end()) steps.push_back(step);
+    }
+    return steps;
+}
+
+// Every step the suite rotates by, for a dedicated key set: +-1, the column
+// rotation (0), the per-size steps and the powers of two of rotate-and-sum.
+inline std::vector<int> rotation_suite_steps(const SweepConfig &config) {
+    std::vector<int> steps = {1, -1, 0};
+    auto add = [&](int step) {
+        if (std::find(steps.begin(), steps.end(), step) == steps.end()) steps.push_back(step);
+    };
+    for (auto vector_size : config.vector_sizes) {
+        for (int step : rotation_steps_for(config, vector_size)) add(step);
+        for (size_t step = 2; step < vector_size; step *= 2) add(static_cast<int>(step));
+    }
+    return steps;
+}
+
+inline std::string join_steps(const std::vector<int> &steps) {
+    std::ostringstream ss;
+    for (size_t i = 0; i < steps.size(); i++) {
+        ss << steps[i];
+        if (i < steps.size() - 1) ss << ";";
+    }
+    return ss.str();
+}
+
+// The slots of `slots` after Backend::rotate by `steps`: a left rotation of
+// each row_size-long row (right for negative steps).
+inline std::vector<uint64_t> rotate_slots(const std::vector<uint64_t> &slots, int steps, size_t row_size) {
+    std::vector<uint64_t> out(slots.size());
+    long n = static_cast<long>(row_size);
+    long shift = ((steps % n) + n) % n;
+    for (size_t row = 0; row + row_size <= slots.size(); row += row_size) {
+        for (size_t i = 0; i < row_size; i++) out[row + i] = slots[row + (i + shift) % row_size];
+    }
+    return out;
+}
+
+// Sums the first vector_size (>= 2) slots into slot 0 of acc with
+// ceil(log2(vector_size)) rotations. The other slots of the row must be zero
+// up to vector_size rounded up to a power of two, which must fit row_size().
+inline void rotate_and_sum(Backend &backend, const Cipher &input, size_t vector_size, Cipher &acc, Cipher &tmp) {
+    backend.rotate(input, 1, tmp);
+    backend.add(input, tmp, acc);
+    for (size_t step = 2; step < vector_size; step *= 2) {
+        backend.rotate(acc, static_cast<int>(step), tmp);
+        backend.add(acc, tmp, acc);
+    }
+}
+
+// Rotation suite at each degree and Galois key set, on data 1..vector_size
+// followed by zeros:
+//   ROTATE_LEFT_1 / ROTATE_RIGHT_1 / ROTATE_COLUMNS  the original three
+//   ROTATE_LEFT_K     one rotation by each of rotation_steps_for()
+//   ROTATE_MANY       all of those steps on one ciphertext, one at a time
+//                     and (where the backend can) hoisted
+//   ROTATE_AND_SUM    reduction of the vector into slot 0
+// With the "default" key set, steps without their own key are composed
+// from the power-of-two keys; "steps" generates a key for each. Every row
+// carries the key set's setup time and Galois key size, and is checked:
+// rotations slot by slot, ROTATE_COLUMNS against rotate_columns_slots(),
+// each ROTATE_MANY result against rotate() by its step. Vector sizes larger
+// than the slot count are skipped.
+inline void run_rotation_sweep(Backend &backend, const SweepConfig &config, CsvLog &log) {
+    std::vector<int> suite_steps = rotation_suite_steps(config);
+
+    for (auto degree : config.poly_modulus_degrees) {
+        for (const auto &key_set : config.rotation_key_sets) {
+            std::cout << "\n=== " << backend.library() << " Rotation PolyModulus=" << degree
+                      << ", key set " << key_set << " ===" << std::endl;
+            std::vector<ParamSet> candidates = config.candidates(degree);
+            if (key_set == "steps") {
+                for (auto &params : candidates) params.galois_steps = suite_steps;
+            } else if (key_set != "default") {
+                std::cout << "SKIPPING - unknown key set " << key_set << std::endl;
+                continue;
+            }
+            if (!setup_first_working(backend, candidates)) {
+                std::cout << "SKIPPING - no working parameters for degree " << degree << std::endl;
+                continue;
+            }
+            size_t slot_count = backend.slot_count();
+            size_t row_size = backend.row_size();
+            double setup_ms = backend.last_setup_ms();
+            std::string setup_source = backend.last_setup_source();
+            KeySizes key_sizes = backend.key_sizes();
+            double galois_keygen_ms = backend.keygen_times().galois_keys_ms;
+            std::cout << "  Galois keys: " << key_sizes.galois_key_count << " keys, "
+                      << key_sizes.galois_keys / (1024 * 1024) << " MB" << std::endl;
+
+            for (auto vector_size : config.vector_sizes) {
+                if (vector_size > slot_count) {
+                    std::cout << "  VectorSize " << vector_size << " - SKIPPING (exceeds "
+                              << slot_count << " slots)" << std::endl;
+                    continue;
+                }
+
+                std::vector<uint64_t> data(slot_count, 0), decoded;
+                for (size_t i = 0; i < vector_size; i++) {
+                    data[i] = i + 1;
+                }
+                auto plain = backend.make_plain();
+                auto cipher = backend.make_cipher();
+                auto rotated = backend.make_cipher();
+                auto tmp = backend.make_cipher();
+                backend.encode(data, *plain);
+                backend.encrypt(*plain, *cipher);
+
+                auto decode_slots = [&](const Cipher &c) {
+                    backend.decrypt(c, *plain);
+                    backend.decode(*plain, decoded);
+                    return decoded;
+                };
+                // Left rotation by k moves slot k (mod the row) to slot 0,
+                // right rotation by r slot 0 to slot r; every slot is checked.
+                auto rotation_valid = [&](int step) {
+                    decode_slots(*rotated);
+                    decoded.resize(slot_count);
+                    return decoded == rotate_slots(data, step, row_size);
+                };
+
+                auto log_rotation = [&](const char *rotation_type, const std::string &steps, const Stats &stats,
+                                        bool hoisted, bool valid) {
+                    log.row(backend.library(), backend.scheme(), degree, slot_count, key_set, setup_ms, setup_source,
+                            galois_keygen_ms, key_sizes.galois_keys, key_sizes.galois_key_count, vector_size, rotation_type, steps,
+                            stats, hoisted ? 1 : 0, valid ? 1 : 0);
+                    std::cout << "  VectorSize: " << vector_size << ", Rotation: " << rotation_type;
+                    if (!steps.empty()) std::cout << " [" << steps << "]";
+                    std::cout << ", Time: " << stats.median_ms << " ms (p99 " << stats.p99_ms << ")"
+                              << (hoisted ? ", hoisted" : "") << (valid ? "" : ", INVALID") << std::endl;
+                };
+
+                Stats stats = measure(config.timing, [&] { backend.rotate(*cipher, 1, *rotated); });
+                log_rotation("ROTATE_LEFT_1", "1", stats, false, rotation_valid(1));
+                stats = measure(config.timing, [&] { backend.rotate(*cipher, -1, *rotated); });
+                log_rotation("ROTATE_RIGHT_1", "-1", stats, false, rotation_valid(-1));
+                stats = measure(config.timing, [&] { backend.rotate_columns(*cipher, *rotated); });
+                decode_slots(*rotated);
+                decoded.resize(slot_count);
+                log_rotation("ROTATE_COLUMNS", "", stats, false, decoded == backend.rotate_columns_slots(data));
+
+                std::vector<int> steps;
+                for (int step : rotation_steps_for(config, vector_size)) {
+                    if (static_cast<size_t>(std::abs(step)) >= row_size) continue;
+                    steps.push_back(step);
+                    stats = measure(config.timing, [&] { backend.rotate(*cipher, step, *rotated); });
+                    log_rotation("ROTATE_LEFT_K", std::to_string(step), stats, false, rotation_valid(step));
+                }
+
+                if (!steps.empty()) {
+                    std::vector<std::unique_ptr<Cipher>> sequential, hoisted;
+                    for (size_t i = 0; i < steps.size(); i++) {
+                        sequential.push_back(backend.make_cipher());
+                        hoisted.push_back(backend.make_cipher());
+                    }
+                    stats = measure(config.timing, [&] { backend.rotate_many(*cipher, steps, sequential, false); });
+                    bool valid = true;
+                    for (size_t i = 0; i < steps.size() && valid; i++) {
+                        backend.rotate(*cipher, steps[i], *rotated);
+                        valid = decode_slots(*sequential[i]) == decode_slots(*rotated);
+                    }
+                    log_rotation("ROTATE_MANY", join_steps(steps), stats, false, valid);
+
+                    if (backend.rotate_many(*cipher, steps, hoisted, true)) {
+                        valid = true;
+                        for (size_t i = 0; i < steps.size() && valid; i++) {
+                            valid = decode_slots(*hoisted[i]) == decode_slots(*sequential[i]);
+                        }
+                        stats = measure(config.timing, [&] { backend.rotate_many(*cipher, steps, hoisted, true); });
+                        log_rotation("ROTATE_MANY", join_steps(steps), stats, true, valid);
+                    }
+                }
+
+                size_t span = 2;
+                while (span < vector_size) span *= 2;
+                if (vector_size >= 2 && span <= row_size) {
+                    uint64_t t = backend.plain_modulus();
+                    uint64_t expected = (vector_size * (vector_size + 1) / 2) % t;
+                    stats = measure(config.timing, [&] { rotate_and_sum(backend, *cipher, vector_size, *rotated, *tmp); });
+                    bool valid = decode_slots(*rotated)[0] == expected;
+                    int rotations = 0;
+                    for (size_t step = 1; step < vector_size; step *= 2) rotations++;
+                    log_rotation("ROTATE_AND_SUM", std::to_string(rotations), stats, false, valid);
+                }
+            }
+        }
+    }
+}
+
+} // namespace bench
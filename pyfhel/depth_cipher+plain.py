@@ -4,6 +4,7 @@ import time
 import csv
 from datetime import datetime
 import os
+from result_log import log_results
 
 class CipherPlusPlainExperiment:
     def __init__(self):
@@ -127,6 +128,7 @@ class CipherPlusPlainExperiment:
                 writer.writerow(row)
         
         print(f"\nResults saved to: {filepath}")
+        log_results(self.experiment_name, fieldnames, self.results)
 
 def main_cipher_plus_plain():
     experiment = CipherPlusPlainExperiment()
@@ -4,6 +4,7 @@ import time
 import csv
 from datetime import datetime
 import os
+from result_log import log_results
 
 class CipherTimesCipherExperiment:
     def __init__(self):
@@ -186,6 +187,7 @@ class CipherTimesCipherExperiment:
                 writer.writerow(row)
         
         print(f"\nResults saved to: {filepath}")
+        log_results(self.experiment_name, fieldnames, self.results)
         
     def generate_summary(self):
         """Generate a summary of the experiment results"""
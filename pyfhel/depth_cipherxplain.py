@@ -4,6 +4,7 @@ import time
 import csv
 from datetime import datetime
 import os
+from result_log import log_results
 
 class CipherTimesPlainExperiment:
     def __init__(self):
@@ -113,6 +114,7 @@ class CipherTimesPlainExperiment:
                 writer.writerow(row)
         
         print(f"\nResults saved to: {filepath}")
+        log_results(self.experiment_name, fieldnames, self.results)
 
 def main_cipher_times_plain():
     experiment = CipherTimesPlainExperiment()
@@ -4,6 +4,7 @@ import time
 import csv
 from datetime import datetime
 import os
+from result_log import log_results
 
 class NoiseBudgetCTPlusCT:
     def __init__(self):
@@ -158,6 +159,7 @@ class NoiseBudgetCTPlusCT:
                 writer.writerow(result)
         
         print(f"\nResults saved to: {filepath}")
+        log_results(self.experiment_name, fieldnames, self.results)
 
 def main_noise_budget_ct_plus_ct():
     experiment = NoiseBudgetCTPlusCT()
@@ -0,0 +1,87 @@
+"""Append Pyfhel results to the shared result log (see bench/result_log.h).
+
+When BENCH_RESULTS_LOG names a file, every experiment's rows are also
+written there in the same record format and column names as the C++
+drivers, so tools/compare_results can compare Pyfhel runs with SEAL and
+HElib ones. Times are converted from seconds to milliseconds.
+"""
+
+import os
+import socket
+import struct
+import sys
+from datetime import datetime, timezone
+
+MAGIC = b"HEBRLOG1"
+RUN, ROW = 1, 2
+
+# Pyfhel column -> shared column.
+RENAMES = {
+    'poly_degree': 'poly_modulus_degree',
+    'operation': 'operation_type',
+    'correct': 'valid',
+}
+
+_run_id = None
+
+
+def _encode(kind, fields):
+    out = [struct.pack('<II', kind, len(fields))]
+    for name, value in fields:
+        for s in (name, value):
+            b = str(s).encode()
+            out.append(struct.pack('<I', len(b)))
+            out.append(b)
+    return b''.join(out)
+
+
+def _append(path, record):
+    fd = os.open(path, os.O_WRONLY | os.O_CREAT | os.O_APPEND, 0o644)
+    try:
+        if os.lseek(fd, 0, os.SEEK_END) == 0:
+            os.write(fd, MAGIC)
+        os.write(fd, record)
+    finally:
+        os.close(fd)
+
+
+def _version():
+    try:
+        import Pyfhel
+        return getattr(Pyfhel, '__version__', 'unknown')
+    except ImportError:
+        return 'unknown'
+
+
+def _normalize(name, value):
+    if name.endswith('_time'):
+        return name + '_ms', '' if value is None else value * 1000
+    if isinstance(value, bool):
+        value = int(value)
+    return RENAMES.get(name, name), '' if value is None else value
+
+
+def log_results(experiment_name, fieldnames, results, scheme='BFV'):
+    """Append one row record per result; a no-op without BENCH_RESULTS_LOG."""
+    global _run_id
+    path = os.environ.get('BENCH_RESULTS_LOG')
+    if not path:
+        return
+    version = _version()
+    if _run_id is None:
+        _run_id = os.environ.get('BENCH_RUN_ID') or '%s-%s-%d' % (
+            socket.gethostname(), datetime.now(timezone.utc).strftime('%Y%m%dT%H%M%SZ'), os.getpid())
+        _append(path, _encode(RUN, [
+            ('run_id', _run_id),
+            ('started_utc', datetime.now(timezone.utc).strftime('%Y-%m-%dT%H:%M:%SZ')),
+            ('host', socket.gethostname()),
+            ('command', ' '.join(sys.argv)),
+            ('library', 'Pyfhel'),
+            ('library_version', version),
+        ]))
+    for result in results:
+        fields = [('run_id', _run_id), ('workload', experiment_name),
+                  ('library', 'Pyfhel'), ('scheme', scheme)]
+        fields += [_normalize(name, result.get(name)) for name in fieldnames]
+        fields.append(('library_version', version))
+        _append(path, _encode(ROW, fields))
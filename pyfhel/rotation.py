@@ -4,6 +4,7 @@ import time
 import csv
 from datetime import datetime
 import os
+from result_log import log_results
 
 class RotationExperiment:
     def __init__(self):
@@ -263,6 +264,7 @@ class RotationExperiment:
                 writer.writerow(result)
         
         print(f"\nResults saved to: {filepath}")
+        log_results(self.experiment_name, fieldnames, self.results)
         
     def generate_summary(self):
         """Generate a summary of the experiment results"""
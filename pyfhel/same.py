@@ -5,6 +5,7 @@ import csv
 from datetime import datetime
 import os
 import math
+from result_log import log_results
 
 class SameNumberExperiment:
     def __init__(self):
@@ -380,6 +381,7 @@ class SameNumberExperiment:
                 writer.writerow(result)
         
         print(f"\nResults saved to: {filepath}")
+        log_results(self.experiment_name, fieldnames, self.results)
         
     def generate_summary(self):
         """Generate a summary of the experiment results"""
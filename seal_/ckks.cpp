@@ -0,0 +1,39 @@
+#include "../bench/ckks_sweep.h"
+#include "../bench/options.h"
+#include "../bench/seal_backend.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace bench;
+
+int main(int argc, char **argv) {
+    Options options(argc, argv);
+    if (options.has("ab-hexl")) return run_hexl_ab(argc, argv, options, seal_build_info());
+    tag_results(seal_build_info());
+
+    cout << "Starting Experiment: CKKS operations and depth" << endl;
+    cout << string(80, '=') << endl;
+
+    CkksSweepConfig config;
+    config.poly_modulus_degrees = {4096, 8192, 16384, 32768};
+    // Up to the N/2 slots of the largest degree
+    for (int i = 10; i <= 14; i++) {
+        config.vector_sizes.push_back(1 << i);
+    }
+    config.candidates = [](size_t degree) { return seal_ckks_params(degree); };
+    apply_options(config, options);
+
+    SealCkksBackend backend;
+    {
+        CsvLog log("seal_ckks_results.csv", ckks_sweep_columns());
+        run_ckks_sweep(backend, config, log);
+    }
+    {
+        CsvLog log("seal_ckks_depth_results.csv", ckks_depth_columns());
+        run_ckks_depth_sweep(backend, config, log);
+    }
+
+    cout << "\nResults saved to: seal_ckks_results.csv, seal_ckks_depth_results.csv" << endl;
+    return 0;
+}
@@ -0,0 +1,38 @@
+#include "../bench/param_search.h"
+#include "../bench/seal_backend.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace bench;
+
+// Finds the fastest BFV parameters for a required depth, plaintext size and
+// security level, e.g. --depth=3 --plain-bits=20 --security=128. Extra
+// options: --prime-bits=30,40,50,60 (sizes of the chains tried).
+int main(int argc, char **argv) {
+    Options options(argc, argv);
+    if (options.has("ab-hexl")) return run_hexl_ab(argc, argv, options, seal_build_info());
+    tag_results(seal_build_info());
+
+    SearchConfig config;
+    config.poly_modulus_degrees = {4096, 8192, 16384, 32768};
+    apply_options(config, options);
+
+    vector<int> prime_bits = {30, 40, 50, 60};
+    auto prime_bits_option = options.get_list("prime-bits");
+    if (!prime_bits_option.empty()) {
+        prime_bits.assign(prime_bits_option.begin(), prime_bits_option.end());
+    }
+    config.candidates = [&](size_t degree, const SearchTarget &target) {
+        return seal_search_params(degree, target.plain_bits, target.security_bits, prime_bits);
+    };
+
+    SealBfvBackend backend;
+    backend.set_key_cache_dir(options.get("key-cache"));
+
+    cout << "Starting SEAL parameter search..." << endl;
+    CsvLog log("seal_param_search_results.csv", param_search_columns());
+    run_param_search(backend, config, log);
+    cout << "Results saved to: seal_param_search_results.csv" << endl;
+    return 0;
+}
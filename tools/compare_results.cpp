@@ -0,0 +1,105 @@
+// Compares two runs recorded in result logs (BENCH_RESULTS_LOG, see
+// bench/result_log.h) and flags latency and throughput regressions beyond
+// the noise. Changes are signed so that positive is worse, for latencies
+// and throughputs alike. Needs no FHE library:
+//
+//   g++ -std=c++17 -O2 -o compare_results tools/compare_results.cpp
+//
+//   --logs=a.log,b.log  result logs to read (default results.log)
+//   --list              print the runs found and exit
+//   --base=RUN_ID       baseline run (default the second-to-last)
+//   --run=RUN_ID        candidate run (default the last)
+//   --threshold=PCT     smallest relative change that counts (default 5)
+//   --sigmas=N          and it must exceed N combined stddevs (default 2)
+//   --out=FILE          every comparison as CSV (default comparison.csv)
+//
+// Cells only one of the runs has are listed, since they go unchecked.
+// Exits with 1 if the candidate regresses anywhere, so upgrades can be
+// gated on it; 2 on bad input, including two runs without a metric in
+// common.
+
+#include "../bench/options.h"
+#include "../bench/regression.h"
+#include "../bench/result_log.h"
+#include "../bench/results.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace bench;
+
+int main(int argc, char **argv) {
+    Options options(argc, argv);
+    vector<string> logs = options.get_strings("logs");
+    if (logs.empty()) logs.push_back("results.log");
+
+    vector<RunResults> runs;
+    try {
+        runs = load_runs(logs);
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 2;
+    }
+
+    if (options.get_flag("list")) {
+        for (const auto &run : runs) {
+            cout << run.run_id << ": " << run.cells.size() << " cells";
+            for (const auto &f : run.metadata) {
+                if (f.first == "started_utc" || f.first == "library" || f.first == "library_version" ||
+                    f.first == "hexl") {
+                    cout << ", " << f.first << "=" << f.second;
+                }
+            }
+            cout << endl;
+        }
+        return 0;
+    }
+
+    auto find_run = [&](const string &id, size_t from_end) -> const RunResults * {
+        if (id.empty()) return runs.size() > from_end ? &runs[runs.size() - 1 - from_end] : nullptr;
+        for (const auto &run : runs) {
+            if (run.run_id == id) return &run;
+        }
+        return nullptr;
+    };
+    const RunResults *base = find_run(options.get("base"), 1);
+    const RunResults *candidate = find_run(options.get("run"), 0);
+    if (!base || !candidate) {
+        cerr << "Need two runs to compare; " << runs.size() << " found (see --list)" << endl;
+        return 2;
+    }
+
+    RegressionConfig config;
+    config.threshold_pct = options.get_double("threshold", config.threshold_pct);
+    config.sigmas = options.get_double("sigmas", config.sigmas);
+    vector<Comparison> comparisons = compare_runs(*base, *candidate, config);
+
+    CsvLog log(options.get("out", "comparison.csv"), comparison_columns());
+    log_comparisons(*base, *candidate, comparisons, log);
+
+    vector<string> base_only = unmatched_cells(*base, *candidate);
+    vector<string> candidate_only = unmatched_cells(*candidate, *base);
+    for (const auto &cell : base_only) cout << "only in " << base->run_id << ": " << cell << endl;
+    for (const auto &cell : candidate_only) cout << "only in " << candidate->run_id << ": " << cell << endl;
+    if (comparisons.empty()) {
+        cerr << base->run_id << " and " << candidate->run_id << " have no metric in common ("
+             << base->cells.size() << " and " << candidate->cells.size() << " cells)" << endl;
+        return 2;
+    }
+
+    size_t regressions = 0, improvements = 0;
+    for (const auto &c : comparisons) {
+        if (c.verdict == "same") continue;
+        (c.verdict == "regression" ? regressions : improvements)++;
+        cout << (c.verdict == "regression" ? "REGRESSION  " : "improvement ") << c.metric << " " << c.base
+             << " -> " << c.candidate << " (" << (c.change_pct > 0 ? "+" : "") << c.change_pct
+             << "%, noise " << c.noise << ")  " << c.cell << endl;
+    }
+    cout << "\n" << base->run_id << " -> " << candidate->run_id << ": " << comparisons.size()
+         << " metrics compared, " << regressions << " regressions, " << improvements << " improvements, "
+         << base_only.size() + candidate_only.size() << " unmatched cells"
+         << " (threshold " << config.threshold_pct << "%, " << config.sigmas << " sigma)" << endl;
+    return regressions ? 1 : 0;
+}